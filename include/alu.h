@@ -0,0 +1,67 @@
+#ifndef ALU_H
+#define ALU_H
+
+#include <stdint.h>
+
+#include "cpu.h"
+
+/* flags in P that the tables produce */
+
+#define ALU_N ((uint8_t)1 << 7)
+#define ALU_V ((uint8_t)1 << 6)
+#define ALU_Z ((uint8_t)1 << 1)
+#define ALU_C ((uint8_t)1 << 0)
+
+#define ALU_NZ (ALU_N | ALU_Z)
+#define ALU_NZC (ALU_N | ALU_Z | ALU_C)
+#define ALU_NVZC (ALU_N | ALU_V | ALU_Z | ALU_C)
+
+/* ADC/SBC table entry:
+ *  -------------------
+ * |  15:8  |   7:0    |
+ *  -------------------
+ * 15:8	- N, V, Z and C, in their P positions
+ * 7:0	- result
+ *
+ * tables are indexed by variant (bit 0 - carry in, bit 1 - decimal
+ * mode), then by A << 8 | operand */
+
+#define ALU_VARIANTS 4
+#define ALU_OPERANDS (256 * 256)
+
+extern uint8_t alu_nz[256];
+extern uint16_t alu_adc_table[ALU_VARIANTS][ALU_OPERANDS];
+extern uint16_t alu_sbc_table[ALU_VARIANTS][ALU_OPERANDS];
+
+#define alu_variant(cpu) \
+	(((cpu)->P & ALU_C) | (((cpu)->P >> 2) & 0x2))
+
+#define alu_operands(x, y) \
+	(((uint16_t)(x) << 8) | (uint8_t)(y))
+
+#define alu_set_NZ(cpu, val) \
+	(cpu)->P = ((cpu)->P & ~ALU_NZ) | alu_nz[(uint8_t)(val)]
+
+#define alu_apply(cpu, reg, entry) do { \
+	uint16_t __entry = (entry); \
+	(reg) = (uint8_t)__entry; \
+	(cpu)->P = ((cpu)->P & ~ALU_NVZC) | (uint8_t)(__entry >> 8); \
+} while (0)
+
+#define alu_adc(cpu, val) \
+	alu_apply(cpu, (cpu)->A, alu_adc_table[alu_variant(cpu)] \
+					      [alu_operands((cpu)->A, val)])
+
+#define alu_sbc(cpu, val) \
+	alu_apply(cpu, (cpu)->A, alu_sbc_table[alu_variant(cpu)] \
+					      [alu_operands((cpu)->A, val)])
+
+/* compare is a binary subtraction with carry set that keeps V */
+#define alu_cmp(cpu, reg, val) \
+	(cpu)->P = ((cpu)->P & ~ALU_NZC) \
+		 | ((uint8_t)(alu_sbc_table[ALU_C] \
+				[alu_operands(reg, val)] >> 8) & ALU_NZC)
+
+void init_alu(void);
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef AOT_H
+#define AOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "instr.h"
+#include "device.h"
+#include "alu.h"
+
+/* ahead-of-time translation: sikso2 --aot turns a binary into a C unit
+ * that defines aot_image; build it in with make AOT=<file> and runs of
+ * the same image go through the compiled blocks, falling back to the
+ * interpreter wherever the translation does not reach
+ *
+ * the image is checked against RAM when attached, and a write to its
+ * pages detaches it, so self-modifying code stays correct (but slow) */
+
+struct aot_image_t {
+	uint16_t load_addr;
+	uint32_t size;
+	uint32_t hash;
+	cpu_model_t model;
+	int(*run)(struct device_t* device, bool end_on_last_instr);
+};
+
+uint32_t aot_hash(const uint8_t* data, unsigned int size);
+int aot_translate(const char* infile, const char* outfile,
+		  uint16_t load_addr, cpu_model_t model);
+
+/* ======= used by generated code ======= */
+
+/* return-address prediction: each JSR notes the block its RTS should
+ * land on, so the RTS goes straight there instead of through the
+ * dispatch; the address pulled off the stack is what counts, so a
+ * program that changes it, or calls deeper than this remembers, only
+ * misses */
+#define AOT_RAS_SIZE 16	/* a power of two */
+#define AOT_RAS_MISS UINT32_MAX
+
+struct aot_ras_t {
+	uint16_t pc;
+	uint32_t site;
+};
+
+/* the generated unit keeps registers in locals and writes them back
+ * whenever it returns to the interpreter */
+#define AOT_LOCALS \
+	const uint64_t aot_start = device->instr_count; \
+	uint8_t A = device->cpu->A; \
+	uint8_t X = device->cpu->X; \
+	uint8_t Y = device->cpu->Y; \
+	uint8_t S = device->cpu->S; \
+	uint8_t P = device->cpu->P; \
+	uint16_t pc = device->cpu->PC; \
+	uint16_t ea; \
+	uint16_t e; \
+	uint8_t v; \
+	struct aot_ras_t aot_ras[AOT_RAS_SIZE]; \
+	uint32_t aot_ras_top = 0; \
+	(void)ea; \
+	(void)e; \
+	(void)v; \
+	(void)aot_ras; \
+	(void)aot_ras_top
+
+#define AOT_SYNC(next) do { \
+	device->cpu->A = A; \
+	device->cpu->X = X; \
+	device->cpu->Y = Y; \
+	device->cpu->S = S; \
+	device->cpu->P = P; \
+	device->cpu->PC = (next); \
+} while (0)
+
+#define AOT_EXIT(next, ret) do { \
+	AOT_SYNC(next); \
+	return (ret); \
+} while (0)
+
+/* hands the instruction at next to the interpreter: it runs it right
+ * away if nothing ran here yet, otherwise it checks for stops first */
+#define AOT_YIELD(next) \
+	AOT_EXIT(next, device->instr_count == aot_start ? DEVICE_AOT_MISS : 0)
+
+#define AOT_COUNT(c, n) do { \
+	device->cycles += (c); \
+	device->instr_count += (n); \
+} while (0)
+
+/* cycles and instructions of the block so far are only counted when it
+ * ends, so the checks below take them as arguments */
+
+/* a pending stop holds the deadline at 0, so one compare covers both */
+#define AOT_DUE(c) \
+	(device->cycles + (c) >= device->deadline)
+
+/* blocks end where the binary does, and code past it is not compiled,
+ * so only a block entry can be at or past the last instruction */
+#define AOT_END(addr) \
+	(end_on_last_instr && (addr) >= device->ram.end_instr)
+
+#define AOT_PAGE_STOP(addr) \
+	(device->ram.page_flags[get_page_num(addr)] \
+	 & (PAGE_SLOW_EXEC | PAGE_STOP))
+
+/* on entry to a block: breakpoints and profiling need the interpreter */
+#define AOT_ENTER(addr) do { \
+	if (AOT_PAGE_STOP(addr) || AOT_DUE(0) || AOT_END(addr)) \
+		AOT_YIELD(addr); \
+} while (0)
+
+/* after each instruction: a stop or a due event */
+#define AOT_CHECK(next, c, n) do { \
+	if (AOT_DUE(c)) { \
+		AOT_COUNT(c, n); \
+		AOT_EXIT(next, 0); \
+	} \
+} while (0)
+
+/* after a store, which may have detached the image */
+#define AOT_CHECK_STORE(next, c, n) do { \
+	if (AOT_DUE(c) || !device->aot) { \
+		AOT_COUNT(c, n); \
+		AOT_EXIT(next, 0); \
+	} \
+} while (0)
+
+/* when a block runs into the next page */
+#define AOT_CHECK_PAGE(addr, c, n) do { \
+	if (AOT_PAGE_STOP(addr)) { \
+		AOT_COUNT(c, n); \
+		AOT_EXIT(addr, 0); \
+	} \
+} while (0)
+
+#define AOT_EXTRA_CYCLE(base, addr) \
+	device->cycles += (((base) ^ (addr)) & 0xFF00) != 0
+
+#define AOT_NZ(val) \
+	P = (P & ~ALU_NZ) | alu_nz[(uint8_t)(val)]
+
+#define AOT_VARIANT \
+	((P & ALU_C) | ((P >> 2) & 0x2))
+
+#define AOT_ALU(table, val) do { \
+	e = table[AOT_VARIANT][alu_operands(A, val)]; \
+	A = (uint8_t)e; \
+	P = (P & ~ALU_NVZC) | (uint8_t)(e >> 8); \
+} while (0)
+
+#define AOT_CMP(reg, val) \
+	P = (P & ~ALU_NZC) \
+	  | ((uint8_t)(alu_sbc_table[ALU_C][alu_operands(reg, val)] >> 8) \
+	     & ALU_NZC)
+
+#define AOT_PUSH(val) device_push(device, S, (val))
+#define AOT_PULL() device_pull(device, S)
+
+#define AOT_RAS_PUSH(ret, site_) \
+	aot_ras[aot_ras_top++ & (AOT_RAS_SIZE - 1)] = \
+		(struct aot_ras_t) { .pc = (ret), .site = (site_) }
+
+/* the entry is used up either way */
+#define AOT_RAS_POP(ret) \
+	(aot_ras_top \
+	 && aot_ras[--aot_ras_top & (AOT_RAS_SIZE - 1)].pc == (ret) \
+	 ? aot_ras[aot_ras_top & (AOT_RAS_SIZE - 1)].site : AOT_RAS_MISS)
+
+#define AOT_READ16_ZP(addr) \
+	((uint16_t)device_read_zp(device, (addr)) \
+	 | (uint16_t)device_read_zp(device, (addr) + 1) << 8)
+
+/* JMP (ind) does not carry into the high byte of the pointer */
+#define AOT_READ16_JMP(addr) \
+	((uint16_t)device_read(device, (uint16_t)(addr)) \
+	 | (uint16_t)device_read(device, \
+		(uint16_t)(((addr) & 0xFF00) | (((addr) + 1) & 0xFF))) << 8)
+
+#endif
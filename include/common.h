@@ -7,6 +7,11 @@
 #include "cpu.h"
 #include "mem.h"
 #include "translator.h"
+#include "result.h"
+#include "replay.h"
+#include "mapper.h"
+#include "rom.h"
+#include "system.h"
 
 #define log_err(SIG, FMT, ...) \
 	printf("[" SIG "] (!) " FMT "\n", ## __VA_ARGS__)
@@ -25,6 +30,10 @@
 	settings->ram_size < 0 ? DEFAULT_RAM_SIZE \
 			       : (uint16_t)settings->ram_size
 
+#define get_checkpoint_interval(settings) \
+	settings->checkpoint_interval < 0 ? REPLAY_DEFAULT_INTERVAL \
+					  : (uint64_t)settings->checkpoint_interval
+
 #define get_stack_addr(settings) \
 	settings->stack_addr < 0 ? DEFAULT_STACK_ADDR \
 				 : (uint16_t)settings->stack_addr
@@ -34,10 +43,41 @@ typedef struct {
 	int32_t stack_addr;
 	int32_t ram_size;
 	bool end_on_final_instr;
+	int32_t safeguard;
 	cpu_dump_mode_t cpu_dump_mode;
 	struct mem_region_t* mrhead;
+	struct mem_region_t* break_head;
+	struct mem_region_t* watch_head;
+	struct mem_region_t* rwatch_head;
+	struct mem_region_t* rom_head;
+	struct mem_region_t* mmio_head;
+	struct mem_region_t* unmapped_head;
+	bool trap_rom_writes;
 	mem_image_t* mimage;
 	struct mem_byte_t* mbhead;
+	struct mapper_t* mapper;
+	struct rom_t* rom;
+	uint16_t rom_addr;
+	uint16_t cpu_addrs[SYSTEM_MAX_CPUS - 1];
+	int num_cpu_addrs;
+	int32_t slice;
+	int32_t slice_instrs;
+	bool cpu_threads;
+	cpu_model_t cpu_model;
+	int32_t console_addr;
+	const char* console_in;
+	int32_t timer_addr;
+	int32_t dma_addr;
+	const char* mem_raw_file;
+	result_format_t result_format;
+	const char* result_file;
+	int32_t gdb_port;
+	const char* gdb_socket;
+	const char* record_file;
+	const char* replay_file;
+	int32_t checkpoint_interval;
+	int32_t seek_cycle;
+	const char* profile_file;
 	disasm_mode_t dmode;
 } settings_t;
 
@@ -51,6 +91,10 @@ typedef struct {
 void init_settings(settings_t* settings);
 void free_settings(settings_t* settings);
 bool is_hex(const char* str);
+unsigned int hex_dump_size(unsigned int len, unsigned int offset);
+unsigned int format_hex(char* out, const uint8_t* mem, unsigned int len,
+			unsigned int offset);
+unsigned int format_hex_str(char* out, const uint8_t* mem, unsigned int len);
 void print_hex(const uint8_t* mem, unsigned int len, unsigned int offset);
 int parse_str(const char* str, int base, void(*on_err)(int));
 uint8_t* load_file(const char* infile, unsigned int* len);
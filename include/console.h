@@ -0,0 +1,49 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "device.h"
+
+/* a terminal for the guest, at two registers:
+ *
+ *  base + 0  data    write: a byte of output, read: the next byte of
+ *                    input (0 if there is none)
+ *  base + 1  status  read: CONSOLE_INPUT if there is input,
+ *                    CONSOLE_EOF once input has ended
+ *
+ * output is buffered on the console's thread and written when the
+ * buffer fills, at a newline if it goes to a terminal, and at the end;
+ * input is read ahead on the same thread, from stdin without ever
+ * holding up the CPU, or from a file, which the guest sees the same
+ * way however fast the host reads it */
+
+#define CONSOLE_DATA 0
+#define CONSOLE_STATUS 1
+#define CONSOLE_REGS 2
+
+#define CONSOLE_INPUT 0x1
+#define CONSOLE_EOF 0x2
+
+#define CONSOLE_BUFFER_SIZE (64 * 1024)
+
+struct console_t {
+	struct peripheral_t peripheral;
+	/* console thread */
+	int out_fd;
+	bool line_buffered;
+	uint8_t* buf;
+	unsigned int len;
+	int in_fd;
+	/* CPU side */
+	bool wait_for_input;
+	bool has_next;
+	uint8_t next;
+	bool eof;
+};
+
+struct console_t* new_console(uint16_t addr, const char* infile);
+void free_console(struct console_t* console);
+
+#endif
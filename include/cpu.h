@@ -5,7 +5,7 @@
 
 /* PAGES (size is 256 bytes each)
  * zero page	0x0000 - 0x00FF
- * stack	0x0100 - 0x01FF */
+ * stack	0x0100 - 0x01FF, growing down from 0x01FF */
 
 /* reset vector:
  * 0xFFFC - low bits of PC
@@ -18,9 +18,41 @@ typedef struct cpu_6502_t {
 	uint8_t S;	/* stack pointer */
 	uint8_t P;	/* status flags (7:0) */
 	uint16_t PC;	/* program counter */
-	instr_map_t* instr_map;
+	const opdesc_t* opdesc;	/* decode table, by opcode */
+	action_t* actions;	/* by descriptor handler */
+	fuse_map_t* fuse_map;
+	cpu_model_t model;
 } cpu_6502_t;
 
+/* the registers as the run loop holds them between stops, in its own
+ * frame; actions get them directly instead of through the device */
+typedef struct cpu_regs_t {
+	uint8_t A;
+	uint8_t X;
+	uint8_t Y;
+	uint8_t S;
+	uint8_t P;
+	uint16_t PC;
+} cpu_regs_t;
+
+#define cpu_load_regs(regs, cpu) do { \
+	(regs).A = (cpu)->A; \
+	(regs).X = (cpu)->X; \
+	(regs).Y = (cpu)->Y; \
+	(regs).S = (cpu)->S; \
+	(regs).P = (cpu)->P; \
+	(regs).PC = (cpu)->PC; \
+} while (0)
+
+#define cpu_store_regs(cpu, regs) do { \
+	(cpu)->A = (regs).A; \
+	(cpu)->X = (regs).X; \
+	(cpu)->Y = (regs).Y; \
+	(cpu)->S = (regs).S; \
+	(cpu)->P = (regs).P; \
+	(cpu)->PC = (regs).PC; \
+} while (0)
+
 typedef enum {
 	CPU_DUMP_SIMPLE,
 	CPU_DUMP_ONELINE,
@@ -60,6 +92,17 @@ typedef struct {
 #define clr_B(cpu) clr_bit(cpu, 4)
 #define get_B(cpu) get_bit(cpu, 4)
 
+/* what P looks like on the stack: PHP (and BRK) push it with B set and
+ * an IRQ with B clear, bit 5 is always set, and PLP and RTI take
+ * neither back */
+#define P_BREAK ((uint8_t)1 << 4)
+#define P_UNUSED ((uint8_t)1 << 5)
+
+#define p_pushed(p, brk) \
+	(((p) & ~P_BREAK) | P_UNUSED | ((brk) ? P_BREAK : 0))
+#define p_pulled(p) \
+	(((p) & ~P_BREAK) | P_UNUSED)
+
 #define set_V(cpu) set_bit(cpu, 6)
 #define clr_V(cpu) clr_bit(cpu, 6)
 #define get_V(cpu) get_bit(cpu, 6)
@@ -68,6 +111,11 @@ typedef struct {
 #define clr_N(cpu) clr_bit(cpu, 7)
 #define get_N(cpu) get_bit(cpu, 7)
 
+void init_cpu_6502_actions(void);
+void init_cpu_6502_actions_nmos(void);
+void init_cpu_6502_actions_undoc(void);
+void init_cpu_6502_actions_65c02(void);
+cpu_model_t parse_cpu_model(const char* arg);
 void init_cpu(struct cpu_6502_t* cpu, instr_t* instr_list);
 void start_cpu(struct cpu_6502_t* cpu, uint16_t load_addr,
 	       uint16_t stack_addr);
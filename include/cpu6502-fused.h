@@ -0,0 +1,75 @@
+#ifndef CPU6502_FUSED_H
+#define CPU6502_FUSED_H
+
+/* generated by scripts/genops.py from scripts/fused.txt */
+
+DEFINE_FUSED(DEX_BNE) {
+
+	DEX_action(ops[0], args[0], regs, data);
+
+	return BNE_action(ops[1], args[1], regs, data);
+}
+
+DEFINE_FUSED(DEY_BNE) {
+
+	DEY_action(ops[0], args[0], regs, data);
+
+	return BNE_action(ops[1], args[1], regs, data);
+}
+
+DEFINE_FUSED(INY_CPY_BNE) {
+
+	INY_action(ops[0], args[0], regs, data);
+	CPY_action(ops[1], args[1], regs, data);
+
+	return BNE_action(ops[2], args[2], regs, data);
+}
+
+DEFINE_FUSED(INX_CPX_BNE) {
+
+	INX_action(ops[0], args[0], regs, data);
+	CPX_action(ops[1], args[1], regs, data);
+
+	return BNE_action(ops[2], args[2], regs, data);
+}
+
+DEFINE_FUSED(CMP_BEQ) {
+
+	CMP_action(ops[0], args[0], regs, data);
+
+	return BEQ_action(ops[1], args[1], regs, data);
+}
+
+DEFINE_FUSED(LDA_STA) {
+
+	LDA_action(ops[0], args[0], regs, data);
+
+	return STA_action(ops[1], args[1], regs, data);
+}
+
+DEFINE_FUSED(CLC_ADC) {
+
+	CLC_action(ops[0], args[0], regs, data);
+
+	return ADC_action(ops[1], args[1], regs, data);
+}
+
+DEFINE_FUSED(SEC_SBC) {
+
+	SEC_action(ops[0], args[0], regs, data);
+
+	return SBC_action(ops[1], args[1], regs, data);
+}
+
+static const fused_action_t fused_actions[] = {
+	DEX_BNE_fused,
+	DEY_BNE_fused,
+	INY_CPY_BNE_fused,
+	INX_CPX_BNE_fused,
+	CMP_BEQ_fused,
+	LDA_STA_fused,
+	CLC_ADC_fused,
+	SEC_SBC_fused
+};
+
+#endif
@@ -3,10 +3,14 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 
 #include "common.h"
 #include "cpu.h"
+#include "result.h"
 
+#define DEVICE_AOT_MISS 7
+#define DEVICE_JUMP_BACK 6
 #define DEVICE_TAKE_BRANCH 5
 #define DEVICE_GENERATE_NMI 4
 #define DEVICE_GENERATE_IRQ 3
@@ -19,35 +23,235 @@
 #define DEVICE_NO_CPU_ERROR -5
 #define DEVICE_INTERNAL_BUG -6
 #define DEVICE_NO_ACTION -7
+#define DEVICE_REPLAY_DIVERGED -8
+#define DEVICE_OUT_OF_MEMORY -9
+#define DEVICE_ROM_WRITE -10
+
+typedef enum {
+	DEVICE_EXIT_NONE,
+	DEVICE_EXIT_LAST_INSTR,
+	DEVICE_EXIT_SAFEGUARD,
+	DEVICE_EXIT_ERROR,
+	DEVICE_EXIT_BREAKPOINT,
+	DEVICE_EXIT_WATCHPOINT,
+	DEVICE_EXIT_STEP,
+	DEVICE_EXIT_INTERRUPT,
+	DEVICE_EXIT_SEEK,
+	DEVICE_EXIT_REPLAY_END,
+	DEVICE_EXIT_IDLE,
+	DEVICE_EXIT_SLICE,
+	DEVICE_EXIT_INSTR_LIMIT
+} device_exit_t;
+
+#define PAGE_SIZE 256
+#define PAGE_COUNT 256
+
+#define get_page_num(addr) ((uint16_t)(addr) >> 8)
+
+/* page flags: pages with none of these set are plain RAM and are
+ * accessed directly; everything else goes through the slow path */
+#define PAGE_SLOW_READ		0x1
+#define PAGE_SLOW_WRITE		0x2
+#define PAGE_SLOW_EXEC		0x4
+#define PAGE_STOP		0x8
+
+/* not a slow path: the page shows a mapper bank instead of RAM */
+#define PAGE_MAPPED		0x10
+/* ... or a shared ROM image, which nothing may write (see rom.h) */
+#define PAGE_READ_ONLY		0x20
+
+/* execution may have reached the end of the binary: set on its last
+ * page and the ones after it while a run ends there, so the run loop
+ * only compares PC against the end on these */
+#define PAGE_END		0x40
+
+/* what the address space holds, page by page: RAM and ROM are memory
+ * (ROM only takes writes from the debugger and the loader), MMIO goes
+ * to the device's read and write handlers and anything else is an
+ * error; only RAM pages can be written without the slow path, so
+ * write protection costs nothing on the RAM write path */
+typedef enum {
+	PAGE_RAM,
+	PAGE_ROM,
+	PAGE_MMIO,
+	PAGE_UNMAPPED
+} page_attr_t;
+
+/* what a program writing to ROM gets */
+typedef enum {
+	ROM_WRITES_DROP,
+	ROM_WRITES_TRAP
+} rom_policy_t;
+
+/* per-address watch flags (kept only for flagged pages) */
+#define WATCH_READ		0x1
+#define WATCH_WRITE		0x2
+#define WATCH_EXEC		0x4
+
+/* RAM is allocated a page at a time, on the first write to it; pages
+ * that were never written (and pages past the end of RAM) all share
+ * the read-only ram_zero_page, which is kept write-protected by
+ * PAGE_SLOW_WRITE, so a device only costs the memory it touches */
+extern const uint8_t ram_zero_page[PAGE_SIZE];
 
 typedef struct {
 	uint16_t ram_size;
-	uint8_t ram[65536];
+	uint8_t* pages[PAGE_COUNT];
 	uint16_t end_instr;
+	unsigned int end_page;	/* first page with PAGE_END set */
+	uint8_t page_flags[PAGE_COUNT];
+	uint8_t page_attr[PAGE_COUNT];
+	uint8_t* watch[PAGE_COUNT];
 } ram_t;
 
+/* memory-mapped hardware: accesses to addr_start..addr_end, on pages
+ * the peripheral makes MMIO when attached, go to read and write, on the
+ * CPU's thread; slow ones hand the work to a thread of their own (see
+ * peripheral.h)
+ *
+ * a peripheral whose state outlives an access, e.g. a timer with an
+ * event scheduled, keeps state_size bytes of it in journal checkpoints
+ * (see replay.h): save writes them, and restore puts them back, with
+ * its events and IRQ line */
+struct periph_thread_t;
+
 struct peripheral_t {
 	uint16_t addr_start;
 	uint16_t addr_end;
 	uint8_t(*read)(struct peripheral_t*, uint16_t);
 	void(*write)(struct peripheral_t*, uint16_t, uint8_t);
+	unsigned int state_size;
+	void(*save)(struct peripheral_t*, uint8_t*);
+	void(*restore)(struct peripheral_t*, const uint8_t*);
+	struct device_t* device;
+	struct periph_thread_t* thread;
+	void* data;
 };
 
+#define DEVICE_MAX_PERIPHERALS 8
+
+/* where the CPU finds its IRQ handler */
+#define IRQ_VECTOR 0xfffe
+#define IRQ_CYCLES 7
+
+#define page_allocated(device, page) \
+	((device)->ram.pages[page] != ram_zero_page)
+
+/* raw RAM, no checks; addr is evaluated twice */
+#define ram_byte(device, addr) \
+	((device)->ram.pages[get_page_num(addr)][(uint8_t)(addr)])
+
 #define device_read(device, addr) \
-	((addr) < device->ram.ram_size) ? device->ram.ram[(addr)] \
-					: device->read(device, (addr))
+	(!((device)->ram.page_flags[get_page_num(addr)] & PAGE_SLOW_READ) \
+		? ram_byte((device), (addr)) \
+		: device_read_slow((device), (addr)))
+
+#define device_write(device, addr, val) do { \
+	if (!((device)->ram.page_flags[get_page_num(addr)] & PAGE_SLOW_WRITE)) \
+		ram_byte((device), (addr)) = (val); \
+	else device_write_slow((device), (addr), (val)); \
+} while (0)
 
-#define device_write(device, addr, val) \
-	if (addr < device->ram.ram_size) device->ram.ram[addr] = val; \
-	else device->write(device, addr, val)
+/* pages 0 and 1 are always RAM (see init_device), so zero page and
+ * stack accesses wrap within their page and index it directly unless
+ * a watchpoint, a compiled image or the first write to the page sends
+ * them down the slow path */
+#define STACK_PAGE_ADDR 0x0100
+#define DEVICE_MIN_RAM_SIZE 0x0200
+
+#define device_read_zp(device, addr) \
+	(!((device)->ram.page_flags[0] & PAGE_SLOW_READ) \
+		? (device)->ram.pages[0][(uint8_t)(addr)] \
+		: device_read_slow((device), (uint8_t)(addr)))
+
+#define device_write_zp(device, addr, val) do { \
+	if (!((device)->ram.page_flags[0] & PAGE_SLOW_WRITE)) \
+		(device)->ram.pages[0][(uint8_t)(addr)] = (val); \
+	else device_write_slow((device), (uint8_t)(addr), (val)); \
+} while (0)
+
+#define stack_addr(s) (STACK_PAGE_ADDR | (uint8_t)(s))
+
+/* s is the stack pointer, which wraps as a uint8_t */
+#define device_push(device, s, val) do { \
+	if (!((device)->ram.page_flags[1] & PAGE_SLOW_WRITE)) \
+		(device)->ram.pages[1][(uint8_t)(s)] = (val); \
+	else device_write_slow((device), stack_addr(s), (val)); \
+	(s)--; \
+} while (0)
+
+#define device_pull(device, s) \
+	((s)++, !((device)->ram.page_flags[1] & PAGE_SLOW_READ) \
+		? (device)->ram.pages[1][(uint8_t)(s)] \
+		: device_read_slow((device), stack_addr(s)))
+
+#define DEVICE_MAX_EVENTS 8
+#define DEVICE_NO_DEADLINE UINT64_MAX
+
+struct device_t;
+
+typedef void(*device_event_fn)(struct device_t* device, void* data);
+
+/* events fire after the first instruction that ends on or past their
+ * cycle; the run loop only compares against the earliest one; passive
+ * events (e.g. checkpoints) do not change the machine, so they cannot
+ * wake an idle loop */
+struct device_event_t {
+	uint64_t cycle;
+	device_event_fn fire;
+	void* data;
+	bool passive;
+};
+
+/* what a loop body can do, as far as idle detection is concerned */
+#define DEVICE_IDLE_NONE 0	/* no pass seen yet */
+#define DEVICE_IDLE_UNKNOWN 1	/* not scanned yet */
+#define DEVICE_IDLE_BUSY 2	/* writes, or leaves the loop */
+#define DEVICE_IDLE_RAM 3	/* only reads RAM */
+#define DEVICE_IDLE_EXTERNAL 4	/* may read peripherals */
+
+#define device_reset_idle(device) \
+	((device)->idle.body = DEVICE_IDLE_NONE)
+
+/* last backward jump target and the state the CPU was in, used to spot
+ * a loop that runs without changing anything */
+struct device_idle_t {
+	uint16_t head;
+	uint8_t regs[5];
+	uint64_t cycles;
+	uint64_t instr_count;
+	int body;
+};
+
+struct replay_t;
+struct profile_t;
+struct aot_image_t;
+struct mapper_t;
+struct rom_t;
 
 struct device_t {
 	int error;
 	cpu_6502_t* cpu;
+	uint64_t cycles;
+	uint64_t instr_count;
+	device_exit_t exit_reason;
+	device_exit_t stop_reason;
+	uint16_t stop_addr;
+	atomic_bool interrupt;	/* set by device_interrupt */
+	uint64_t deadline;
+	uint64_t safeguard;	/* instructions a run may take, 0 for any */
+	struct device_event_t events[DEVICE_MAX_EVENTS];
+	struct device_idle_t idle;
+	struct replay_t* replay;
+	struct profile_t* profile;
+	const struct aot_image_t* aot;
+	struct mapper_t* mapper;
+	rom_policy_t rom_policy;
 	uint16_t load_addr;
 	uint16_t stack_addr;
-	struct peripheral_t* peripherals;
+	struct peripheral_t* peripherals[DEVICE_MAX_PERIPHERALS];
 	unsigned int num_of_peripherals;
+	uint8_t irq;	/* IRQ lines raised, one per peripheral */
 	bool(*run_device)(struct device_t* device);
 	void* data;
 	uint8_t(*read)(struct device_t*, uint16_t);
@@ -59,13 +263,57 @@ void init_device(struct device_t* device, struct cpu_6502_t* cpu,
 		 uint16_t load_addr, uint16_t stack_addr,
 		 uint16_t ram_size);
 
+uint8_t device_read_slow(struct device_t* device, uint16_t addr);
+void device_write_slow(struct device_t* device, uint16_t addr, uint8_t val);
+uint8_t device_peek(struct device_t* device, uint16_t addr);
+void device_poke(struct device_t* device, uint16_t addr, uint8_t val);
+void device_copy_ram(struct device_t* device, uint8_t* dst, uint16_t addr,
+		     unsigned int len);
+int device_load_ram(struct device_t* device, uint16_t addr,
+		    const uint8_t* src, unsigned int len);
+int device_set_watch(struct device_t* device, uint16_t addr, uint8_t kind);
+void device_clear_watch(struct device_t* device, uint16_t addr, uint8_t kind);
+void device_request_stop(struct device_t* device, device_exit_t reason,
+			 uint16_t addr);
+void device_interrupt(struct device_t* device);
+int device_enable_profile(struct device_t* device);
+int device_attach_aot(struct device_t* device,
+		      const struct aot_image_t* image);
+void device_detach_aot(struct device_t* device);
+int device_attach_mapper(struct device_t* device, struct mapper_t* mapper);
+void device_map_pages(struct device_t* device, uint8_t page, uint8_t* mem,
+		      unsigned int count);
+int device_attach_peripheral(struct device_t* device,
+			     struct peripheral_t* peripheral);
+void device_set_irq(struct device_t* device, struct peripheral_t* peripheral,
+		    bool raised);
+int device_share_bus(struct device_t* device, struct device_t* bus);
+int device_map_rom(struct device_t* device, uint16_t addr,
+		   const struct rom_t* rom);
+int device_set_page_attr(struct device_t* device, uint16_t start_addr,
+			 uint16_t end_addr, page_attr_t attr);
+int device_schedule(struct device_t* device, uint64_t cycle,
+		    device_event_fn fire, void* data);
+int device_schedule_passive(struct device_t* device, uint64_t cycle,
+			    device_event_fn fire, void* data);
+void device_unschedule(struct device_t* device, device_event_fn fire,
+		       void* data);
+
 int load_to_ram(struct device_t* device, uint16_t load_addr,
 		const uint8_t* data, unsigned int data_size,
 		bool binary);
+void start_device(struct device_t* device);
+int exec_device(struct device_t* device, bool end_on_last_instr,
+		bool resume);
+void report_device(struct device_t* device, int ret,
+		   const result_opts_t* ropts);
 int run_device(struct device_t* device,
 	       bool end_on_last_instr,
-	       cpu_dump_mode_t cpu_dump_mode,
-	       struct mem_region_t* mrhead);
+	       const result_opts_t* ropts);
+device_exit_t device_run_slice(struct device_t* device, uint64_t max_cycles,
+			       uint64_t max_instrs, bool end_on_last_instr,
+			       int* ret);
+const char* get_exit_reason_name(device_exit_t exit_reason);
 void free_device(struct device_t* device);
 
 #endif
@@ -0,0 +1,47 @@
+#ifndef DMA_H
+#define DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "device.h"
+
+/* a DMA engine copying blocks within guest memory, at eight registers:
+ *
+ *  base + 0  source       address, low byte then high byte
+ *  base + 2  destination  address, low byte then high byte
+ *  base + 4  length       in bytes, low byte then high byte
+ *  base + 6  control      write: DMA_START copies the block, DMA_IRQ
+ *                         raises an IRQ when it is done
+ *  base + 7  status       read: DMA_DONE once a copy is done, write:
+ *                         clears it and lowers the IRQ
+ *
+ * the engine takes the bus for the copy, so the CPU is held for
+ * DMA_BYTE_CYCLES a byte, a read and a write, and sees the copy done
+ * when it gets the bus back; RAM is copied a page at a time with
+ * memmove, and anything else (ROM, peripherals, watched pages) a byte
+ * at a time, as the CPU would access it */
+
+#define DMA_SOURCE 0
+#define DMA_DEST 2
+#define DMA_LENGTH 4
+#define DMA_CONTROL 6
+#define DMA_STATUS 7
+#define DMA_REGS 8
+
+#define DMA_START 0x1
+#define DMA_IRQ 0x2
+
+#define DMA_DONE 0x1
+
+#define DMA_BYTE_CYCLES 2
+
+struct dma_t {
+	struct peripheral_t peripheral;
+	uint8_t regs[DMA_REGS];
+};
+
+struct dma_t* new_dma(uint16_t addr);
+void free_dma(struct dma_t* dma);
+
+#endif
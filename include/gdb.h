@@ -0,0 +1,23 @@
+#ifndef GDB_H
+#define GDB_H
+
+#include <stdbool.h>
+
+/* register layout for g/G packets (p/P use the same numbering):
+ *
+ *  0 A, 1 X, 2 Y, 3 S, 4 P	- one byte each
+ *  5 PC			- two bytes, little-endian */
+
+#define GDB_REG_A	0
+#define GDB_REG_X	1
+#define GDB_REG_Y	2
+#define GDB_REG_S	3
+#define GDB_REG_P	4
+#define GDB_REG_PC	5
+
+struct device_t;
+
+int gdb_serve(struct device_t* device, int port, const char* socket_path,
+	      bool end_on_last_instr);
+
+#endif
@@ -6,36 +6,32 @@
 #include <stdbool.h>
 #include <stdio.h> /* log_err */
 
-typedef uint8_t status_t;
-
-#define STATUS_SUCCESS			0x0
-#define STATUS_HASH_INCONSISTENCY	0x1
-
 #define OPCODE_BYTES 1
 
 #define for_each_instr(i) for (i = get_instr_list(); \
 	i < get_instr_list() + get_instr_list_size(); i++)
 
-#define for_each_subinstr(s, i) for_each_instr(i) \
-	for (s = i->list; s < i->list + i->size; s++)
-
 #define INSTR_MAP_SIZE (1 << (OPCODE_BYTES * 8))
-#define DEFINE_INSTR_MAP(m) \
-	instr_map_t m[INSTR_MAP_SIZE] = { \
-		(instr_map_t) { \
-			.instr = NULL, \
-			.subinstr = NULL \
+
+#define DEFINE_FUSE_MAP(m) \
+	fuse_map_t m[INSTR_MAP_SIZE] = { \
+		(fuse_map_t) { \
+			.action = NULL \
 		} \
 	}
 
-#define IS_NULL_ENTRY(m) (!m->instr || !m->subinstr)
+#define IS_FUSED(m) ((m)->action != NULL)
+
+/* instructions in the longest fused sequence (see scripts/fused.txt) */
+#define FUSED_MAX 3
 
 /* mode map:
- *  -------------------
- * |  7:5  | 4 |  3:0  |
- *  -------------------
- * 7:5	- reserved
- * 4	- extra cycle
+ *  ---------------------------
+ * |  7:6  | 5 |  4  |  3:0  |
+ *  ---------------------------
+ * 7:6	- reserved
+ * 5	- extra cycle
+ * 4	- reserved
  * 3:0	- instruction mode */
 
 /* instruction mode */
@@ -59,42 +55,111 @@ typedef uint8_t status_t;
 
 /* add cycle if boundary crossed 0x20000 */
 
-#define MODE_EXTRA_CYCLE	1 << 5
+#define MODE_EXTRA_CYCLE	(1 << 5)
 
-/* CPU model */
+/* CPU models, as bits of supported; each has an opcode table of its own
+ * (see scripts/6502ops.txt) and its own build of the actions (see
+ * source/cpu6502-actions.c) */
 
-#define CPU_6502_CORE		1
+#define CPU_6502_NMOS		0x1	/* documented opcodes only */
+#define CPU_6502_UNDOC		0x2	/* NMOS with undocumented opcodes */
+#define CPU_6502_65C02		0x4
+
+#define CPU_6502_CORE \
+	(CPU_6502_NMOS | CPU_6502_UNDOC | CPU_6502_65C02)
 
 typedef uint8_t instr_mode_t;
 typedef uint8_t cpu_model_t;
 typedef uint8_t opcode_t;
 
+/* opcode descriptor, four bytes, so the whole decode table
+ * (get_opdesc_table, generated by scripts/genops.py) is sixteen cache
+ * lines:
+ *  -----------------------------------------------
+ * | handler | mode | length : cycles | supported |
+ *  -----------------------------------------------
+ * handler	- index into the instruction list, OPDESC_NONE for opcodes
+ *		  that are not instructions
+ * mode		- see mode map above
+ * length	- bits 7:4, in bytes
+ * cycles	- bits 3:0, base cycles
+ * supported	- CPU models whose table has the descriptor */
 typedef struct {
-	uint8_t opcode;
-	uint8_t cycles;
-	uint8_t length;
+	uint8_t handler;
 	instr_mode_t mode;
+	uint8_t timing;
 	cpu_model_t supported;
-} subinstr_t;
+} opdesc_t;
+
+#define OPDESC_NONE 0xFF
 
-typedef int(*action_t)(subinstr_t*, uint16_t, void*);
+#define OPDESC(handler_, mode_, length_, cycles_, supported_) \
+	(opdesc_t) { \
+		.handler = (handler_), \
+		.mode = (mode_), \
+		.timing = (length_) << 4 | (cycles_), \
+		.supported = (supported_) \
+	}
+
+/* undefined opcodes decode as one byte that takes no cycles */
+#define OPDESC_INVALID OPDESC(OPDESC_NONE, MODE_IMPLIED, 1, 0, 0)
+
+#define opdesc_valid(d) ((d)->handler != OPDESC_NONE)
+#define opdesc_length(d) ((d)->timing >> 4)
+#define opdesc_cycles(d) ((d)->timing & 0xF)
+#define opdesc_mode(d) ((d)->mode & 0xF)
+#define opdesc_extra(d) ((d)->mode & MODE_EXTRA_CYCLE)
+
+#define opdesc_instr(d) (&(get_instr_list()[(d)->handler]))
+#define opdesc_name(d) (opdesc_valid(d) ? opdesc_instr(d)->name : "???")
+
+struct cpu_regs_t;
+
+typedef int(*action_t)(const opdesc_t*, uint16_t, struct cpu_regs_t*,
+		       void*);
 
 typedef struct {
 	char name[3];
 	action_t action;
-	subinstr_t* list;
-	uint8_t size;
 } instr_t;
 
-typedef struct instr_map_t {
-	instr_t* instr;
-	subinstr_t* subinstr;
-} instr_map_t;
+/* runs a fused sequence, given the descriptors and operands of its
+ * instructions */
+typedef int(*fused_action_t)(const opdesc_t* const*, const uint16_t*,
+			     struct cpu_regs_t*, void*);
 
-status_t populate_imap(instr_map_t*);
-void print_imap(instr_map_t*);
+/* superinstructions: when the opcodes follow one another in memory,
+ * the whole sequence runs in a single dispatch (see scripts/fused.txt);
+ * the action is set by the model's actions */
+typedef struct {
+	opcode_t opcodes[FUSED_MAX];
+	unsigned int count;
+	fused_action_t action;
+} fused_t;
+
+/* offsets are from the first opcode, lead_cycles are those of all but
+ * the last instruction */
+typedef struct fuse_map_t {
+	fused_action_t action;
+	const opdesc_t* ops[FUSED_MAX];
+	opcode_t opcodes[FUSED_MAX];
+	uint8_t offsets[FUSED_MAX];
+	uint8_t count;
+	uint8_t length;
+	uint8_t cycles;
+	uint8_t lead_cycles;
+} fuse_map_t;
+
+const opdesc_t* get_model_opdesc_table(cpu_model_t model);
+const opdesc_t* get_opdesc_table(void);
+void set_cpu_model(cpu_model_t model);
+cpu_model_t get_cpu_model(void);
+void populate_fmap(fuse_map_t*, const opdesc_t*);
+fused_t* get_fused_list(void);
+size_t get_fused_list_size(void);
+void print_opdesc_table(const opdesc_t*);
 instr_t* get_instr_list(void);
 size_t get_instr_list_size(void);
-bool get_subinstr(const char[], instr_mode_t, subinstr_t**);
+bool find_opcode(const char[], instr_mode_t, opcode_t*);
 
 #endif
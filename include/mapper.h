@@ -0,0 +1,86 @@
+#ifndef MAPPER_H
+#define MAPPER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* bank switching: a mapper owns a set of equally sized banks and up to
+ * MAPPER_MAX_WINDOWS windows in the address space, each showing one of
+ * them; writes to the mapper's registers select banks, and a switch
+ * only repoints the window's pages (see device_map_pages), so it costs
+ * one pointer per page and never copies
+ *
+ * CPUs on a shared bus (see device_share_bus) all attach to the same
+ * mapper, so a switch by any of them repoints the window on each
+ *
+ * types are a name, the number of registers and what a write to one of
+ * them does; besides the built-in ones, more can be added with
+ * mapper_register_type */
+
+#define MAPPER_MAX_WINDOWS 8
+#define MAPPER_MAX_TYPES 16
+#define MAPPER_MAX_DEVICES 8
+
+struct device_t;
+struct mapper_t;
+
+struct mapper_ops_t {
+	const char* name;
+	/* registers, from reg_addr up */
+	unsigned int(*regs)(const struct mapper_t* mapper);
+	/* reg is relative to reg_addr */
+	void(*write)(struct mapper_t* mapper, uint16_t reg, uint8_t val);
+};
+
+struct mapper_window_t {
+	uint8_t page;	/* first page */
+	unsigned int bank;
+};
+
+struct mapper_t {
+	const struct mapper_ops_t* ops;
+	struct device_t* devices[MAPPER_MAX_DEVICES];
+	unsigned int num_devices;
+	uint8_t* banks;
+	unsigned int bank_count;
+	unsigned int bank_size;	/* also the size of each window */
+	uint16_t reg_addr;
+	unsigned int reg_count;
+	struct mapper_window_t windows[MAPPER_MAX_WINDOWS];
+	unsigned int num_windows;
+	void* data;	/* for the type */
+};
+
+#define mapper_window_pages(mapper) ((mapper)->bank_size / PAGE_SIZE)
+
+/* for checkpoints: the bank each window shows (4 bytes each), then the
+ * contents of every bank */
+#define mapper_state_size(mapper) \
+	((mapper)->num_windows * 4 \
+	 + (mapper)->bank_count * (mapper)->bank_size)
+
+#define mapper_bank(mapper, bank) \
+	((mapper)->banks + (bank) * (mapper)->bank_size)
+
+#define mapper_has_reg(mapper, addr) \
+	((uint16_t)((addr) - (mapper)->reg_addr) < (mapper)->reg_count)
+
+#define mapper_reg_on_page(mapper, page) \
+	((page) >= get_page_num((mapper)->reg_addr) \
+	 && (page) <= get_page_num((mapper)->reg_addr \
+				   + (mapper)->reg_count - 1))
+
+int mapper_register_type(const struct mapper_ops_t* ops);
+struct mapper_t* new_mapper(const struct mapper_ops_t* ops,
+			    const uint8_t* data, unsigned int len,
+			    unsigned int bank_size, const uint16_t* windows,
+			    unsigned int num_windows, uint16_t reg_addr);
+struct mapper_t* parse_mapper(const char* arg);
+void mapper_select(struct mapper_t* mapper, unsigned int window,
+		   unsigned int bank);
+void mapper_write(struct mapper_t* mapper, uint16_t addr, uint8_t val);
+void mapper_save(const struct mapper_t* mapper, uint8_t* state);
+void mapper_restore(struct mapper_t* mapper, const uint8_t* state);
+void free_mapper(struct mapper_t* mapper);
+
+#endif
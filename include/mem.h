@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define MEM_MAX_ADDR 0xFFFF
+
 struct mem_region_t {
 	unsigned int start_addr;
 	unsigned int end_addr;
@@ -0,0 +1,87 @@
+#ifndef PERIPHERAL_H
+#define PERIPHERAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/* slow peripherals (files, output sinks, the host terminal) run on a
+ * thread of their own, so host I/O never stalls the CPU: the CPU side
+ * (the peripheral's read and write, on the CPU's thread) and the
+ * peripheral's thread only talk through two single-producer,
+ * single-consumer rings, which take no locks
+ *
+ * every message carries a guest cycle: the CPU stamps what it sends
+ * with the cycle of the access, and the thread stamps what it sends
+ * back with the cycle from which the guest may see it, e.g. that of the
+ * request plus the latency of the modelled hardware, so what the guest
+ * sees does not depend on how fast the host is; the CPU only ever waits
+ * for a reply it asked for that is due by now, which is rare when the
+ * latency modelled is realistic */
+
+#define PERIPH_QUEUE_SIZE 1024	/* a power of two */
+
+struct peripheral_t;
+
+struct periph_msg_t {
+	uint64_t cycle;
+	uint16_t addr;
+	uint8_t val;
+};
+
+/* head is only written by the consumer and tail by the producer; they
+ * are kept on cache lines of their own */
+struct periph_queue_t {
+	_Alignas(64) atomic_uint head;
+	_Alignas(64) atomic_uint tail;
+	_Alignas(64) struct periph_msg_t msgs[PERIPH_QUEUE_SIZE];
+};
+
+/* handle runs on the thread for every message from the CPU; poll, if
+ * any, runs whenever there is none, and returns whether it did
+ * anything, e.g. took input from the host; neither may block for long,
+ * as the thread only sees a stop between calls; stop, if any, runs last,
+ * e.g. to flush what the peripheral holds */
+struct periph_thread_ops_t {
+	void(*handle)(struct peripheral_t* peripheral,
+		      const struct periph_msg_t* msg);
+	bool(*poll)(struct peripheral_t* peripheral);
+	void(*stop)(struct peripheral_t* peripheral);
+};
+
+struct periph_thread_t {
+	struct periph_queue_t to_thread;
+	struct periph_queue_t from_thread;
+	const struct periph_thread_ops_t* ops;
+	/* CPU side: replies asked for and not taken yet; a peripheral
+	 * that asks for them answers each request with one message */
+	unsigned int replies;
+	atomic_bool stopping;
+	pthread_t thread;
+};
+
+bool periph_queue_push(struct periph_queue_t* queue,
+		       const struct periph_msg_t* msg);
+bool periph_queue_pop(struct periph_queue_t* queue,
+		      struct periph_msg_t* msg);
+bool periph_queue_front(struct periph_queue_t* queue,
+			struct periph_msg_t* msg);
+unsigned int periph_queue_count(struct periph_queue_t* queue);
+void periph_wait(unsigned int* waits);
+
+int periph_start(struct peripheral_t* peripheral,
+		 const struct periph_thread_ops_t* ops);
+void periph_stop(struct peripheral_t* peripheral);
+
+/* CPU side */
+void periph_send(struct peripheral_t* peripheral, uint16_t addr,
+		 uint8_t val, bool reply);
+bool periph_receive(struct peripheral_t* peripheral,
+		    struct periph_msg_t* msg);
+
+/* thread side */
+void periph_post(struct peripheral_t* peripheral,
+		 const struct periph_msg_t* msg);
+
+#endif
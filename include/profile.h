@@ -0,0 +1,24 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+#include "instr.h"
+
+/* counts of opcode pairs executed back to back, indexed by the first
+ * opcode << 8 | the second; pairs split by a jump are not counted, as
+ * they cannot be fused */
+struct profile_t {
+	uint64_t pairs[INSTR_MAP_SIZE * INSTR_MAP_SIZE];
+	int last;
+	uint16_t next_pc;
+};
+
+struct profile_t* new_profile(void);
+void profile_count(struct profile_t* profile, uint16_t pc,
+		   opcode_t opcode, uint8_t length);
+int dump_profile(struct profile_t* profile, const opdesc_t* opdesc,
+		 const char* outfile);
+void free_profile(struct profile_t* profile);
+
+#endif
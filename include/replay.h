@@ -0,0 +1,49 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* input journal (all fields little-endian):
+ *
+ *  header:	magic ("S2RJ"), version (3), checkpoint interval (8),
+ *		RAM size (4), peripheral state size (4), mapper state
+ *		size (4)
+ *  records:	type (1) followed by
+ *   'R'	cycle delta from the previous read (LEB128), address (2),
+ *		value (1) - a read that was not served from RAM
+ *   'C'	cycles (8), instructions (8), A, X, Y, S, P, PC (2),
+ *		IRQ lines (1), the state of each peripheral that has one,
+ *		in the order they were attached (peripheral state size),
+ *		the mapper's, if any (mapper state size, see
+ *		mapper_state_size), RAM contents (RAM size)
+ *   'E'	cycles (8), instructions (8) - end of recording
+ *
+ * reads are logged with the cycle count at the start of the instruction
+ * that made them; checkpoints are taken between instructions, so every
+ * read after a checkpoint has a cycle count not below it */
+
+#define REPLAY_MAGIC "S2RJ"
+#define REPLAY_VERSION 3
+#define REPLAY_HEADER_SIZE 25
+#define REPLAY_DEFAULT_INTERVAL 1000000
+
+#define REPLAY_READ 'R'
+#define REPLAY_CHECKPOINT 'C'
+#define REPLAY_END 'E'
+
+struct device_t;
+struct replay_t;
+
+int replay_record(struct device_t* device, const char* path,
+		  uint64_t interval);
+int replay_play(struct device_t* device, const char* path, int64_t seek);
+void replay_start(struct device_t* device);
+bool replay_playing(struct device_t* device);
+uint8_t replay_read(struct device_t* device, uint16_t addr);
+void replay_log_read(struct device_t* device, uint16_t addr, uint8_t val);
+int replay_seek(struct device_t* device, uint64_t instr,
+		bool end_on_last_instr);
+void replay_close(struct device_t* device);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef RESULT_H
+#define RESULT_H
+
+#include <stdint.h>
+
+#include "cpu.h"
+#include "mem.h"
+
+/* binary result record (all fields little-endian):
+ *
+ *  offset  size  field
+ *  0       4     magic ("S2RR")
+ *  4       1     version
+ *  5       5     A, X, Y, S, P
+ *  10      2     PC
+ *  12      1     exit reason
+ *  13      4     return value (signed)
+ *  17      8     cycles
+ *  25      8     instructions
+ *  33      2     number of memory regions
+ *  35      ...   regions: start address (2), length (4), bytes */
+
+#define RESULT_MAGIC "S2RR"
+#define RESULT_VERSION 1
+#define RESULT_HEADER_SIZE 35
+#define RESULT_REGION_HEADER_SIZE 6
+
+typedef enum {
+	RESULT_FORMAT_TEXT,
+	RESULT_FORMAT_JSON,
+	RESULT_FORMAT_BINARY,
+	RESULT_FORMAT_INVALID
+} result_format_t;
+
+typedef struct {
+	cpu_dump_mode_t cpu_dump_mode;
+	struct mem_region_t* mrhead;
+	const char* mem_raw_file;
+	result_format_t format;
+	const char* outfile;
+} result_opts_t;
+
+struct device_t;
+
+result_format_t parse_result_format(const char* arg);
+int dump_result(struct device_t* device, int ret,
+		const result_opts_t* ropts);
+
+#endif
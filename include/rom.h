@@ -0,0 +1,27 @@
+#ifndef ROM_H
+#define ROM_H
+
+#include <stdint.h>
+
+/* read-only images shared between devices: rom_open maps a file once,
+ * keyed by the hash of its contents, and every device showing it points
+ * its ROM pages at that mapping (see device_map_rom) instead of loading
+ * a copy; the mapping is read-only, so it is shared with other
+ * processes running the same image as well
+ *
+ * images are reference counted, and must outlive the devices using
+ * them */
+
+struct rom_t {
+	uint32_t hash;
+	const uint8_t* mem;
+	unsigned int size;
+	unsigned int refs;
+	struct rom_t* next;
+};
+
+struct rom_t* rom_open(const char* infile);
+struct rom_t* parse_rom(const char* arg, uint16_t* addr);
+void rom_close(struct rom_t* rom);
+
+#endif
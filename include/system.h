@@ -0,0 +1,69 @@
+#ifndef SYSTEM_H
+#define SYSTEM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "result.h"
+
+/* several CPUs on one memory bus: the first is the device the system is
+ * built around, and every other one gets a device of its own that sees
+ * the first one's memory from page 2 up (see device_share_bus), so each
+ * CPU keeps its own zero page, stack, cycle count and events
+ *
+ * CPUs take turns in slices, in order, each running its budget of
+ * cycles, of instructions, or both per slice (cycles by default), so a
+ * run is deterministic; threaded, they run a slice at the same time and
+ * wait for each other at its end, which scales across host cores, but
+ * makes the order of accesses to shared memory within a slice up to the
+ * host
+ *
+ * peripherals are not shared between threads: a console's ring has a
+ * single producer, and a timer or DMA engine schedules events and
+ * raises IRQs on the first CPU's device only, so run_system refuses to
+ * thread a system with peripherals, a mapper, or read and write
+ * handlers attached rather than queue their accesses for the end of a
+ * slice
+ *
+ * the system stops when the first CPU does */
+
+#define SYSTEM_MAX_CPUS 8
+#define SYSTEM_DEFAULT_SLICE 1000
+
+struct device_t;
+
+struct system_cpu_t {
+	struct device_t* device;
+	uint64_t budget;	/* cycles per slice */
+	uint64_t instr_budget;	/* instructions per slice */
+	int ret;
+	bool stopped;
+	pthread_t thread;
+	bool has_thread;
+	struct system_t* system;
+};
+
+struct system_t {
+	struct system_cpu_t cpus[SYSTEM_MAX_CPUS];
+	unsigned int num_cpus;
+	bool end_on_last_instr;
+	/* threaded: each slice is a new generation, and ends when no CPU
+	 * is pending */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	unsigned int generation;
+	unsigned int pending;
+	bool stopping;
+};
+
+void init_system(struct system_t* system, struct device_t* device,
+		 uint64_t budget, uint64_t instr_budget);
+int system_add_cpu(struct system_t* system, uint16_t start_addr,
+		   uint64_t budget, uint64_t instr_budget);
+int parse_cpu_addrs(const char* arg, uint16_t* addrs, unsigned int max);
+int run_system(struct system_t* system, bool end_on_last_instr,
+	       bool threaded, const result_opts_t* ropts);
+void free_system(struct system_t* system);
+
+#endif
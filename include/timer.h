@@ -0,0 +1,48 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "device.h"
+
+/* a programmable interval timer, at four registers:
+ *
+ *  base + 0  control  TIMER_ENABLE starts it counting from the write,
+ *                     TIMER_IRQ raises an IRQ when it expires and
+ *                     TIMER_ONE_SHOT stops it after the first expiry
+ *  base + 1  status   read: TIMER_EXPIRED once it has expired, write:
+ *                     clears it and lowers the IRQ
+ *  base + 2  count    write: the period in cycles (0 is 65536), low byte
+ *  base + 3           then high byte; read: the cycles left until it
+ *                     expires, the low byte first, which latches the
+ *                     high one
+ *
+ * the timer is never ticked: it schedules an event on the device for
+ * the cycle it expires on, so it costs nothing while it counts */
+
+#define TIMER_CONTROL 0
+#define TIMER_STATUS 1
+#define TIMER_COUNT_LO 2
+#define TIMER_COUNT_HI 3
+#define TIMER_REGS 4
+
+#define TIMER_ENABLE 0x1
+#define TIMER_IRQ 0x2
+#define TIMER_ONE_SHOT 0x4
+
+#define TIMER_EXPIRED 0x1
+
+struct interval_timer_t {
+	struct peripheral_t peripheral;
+	uint8_t control;
+	uint8_t status;
+	uint16_t period;
+	uint8_t latch;
+	uint64_t due;
+};
+
+struct interval_timer_t* new_timer(uint16_t addr);
+void free_timer(struct interval_timer_t* timer);
+
+#endif
@@ -13,7 +13,7 @@ int translate(const char* infile, unsigned int load_addr,
 	      int(*op)(unsigned int, const uint8_t*, void*),
 	      void *data);
 
-int disassemble(const char* infile, instr_map_t* map,
-		disasm_mode_t disasm_mode);
+int disassemble(const char* infile, const opdesc_t* opdesc,
+		disasm_mode_t disasm_mode, uint16_t load_addr);
 
 #endif
@@ -1,8 +1,17 @@
 #!/usr/bin/env python3
 
 import re
+import sys
+import argparse
 from collections import OrderedDict
 
+# CPU models, each with an opcode table of its own
+MODELS = OrderedDict([
+    ('CPU_6502_NMOS', 'nmos'),
+    ('CPU_6502_UNDOC', 'undoc'),
+    ('CPU_6502_65C02', '65c02')
+])
+
 class OpcodeList():
 
     def __init__(self, filename):
@@ -10,7 +19,7 @@ class OpcodeList():
         self.instr_list = OrderedDict()
 
         with open(filename, mode='r', errors='ignore') as file:
-            for line in file.readlines():
+            for index, line in enumerate(file.readlines()):
                 sregex_match = Subinstr.regex.match(line)
                 if sregex_match:
                     name = sregex_match.group(2)
@@ -22,33 +31,104 @@ class OpcodeList():
                     if cycles[-1] == '+':
                         cycles = cycles[:-1]
                         mode = mode + ' | MODE_EXTRA_CYCLE'
+                    supported = 'CPU_6502_{}'.format(sregex_match.group(6)) \
+                        if sregex_match.group(6) else 'CPU_6502_CORE'
+                    if supported not in MODELS \
+                       and supported != 'CPU_6502_CORE':
+                        raise Exception('Unknown CPU model in "{}"'.format(
+                            line.strip()))
                     self.instr_list[name].list.append(Subinstr(
                         int(sregex_match.group(3), 16),
                         cycles,
                         sregex_match.group(4),
-                        mode
+                        mode,
+                        supported=supported,
+                        index=index
                     ))
 
-    def print_c(self):
-        res = '''#include <stdlib.h>
+    # fused sequences and profiles go by the opcodes every model has
+    def find_opcode(self, name, mode):
+        if name not in self.instr_list:
+            return None
 
-#include "cpu.h"
-#include "instr.h"
+        for subinstr in self.instr_list[name].list:
+            if subinstr.mode.split(' ')[0] == 'MODE_{}'.format(mode) \
+               and subinstr.supported == 'CPU_6502_CORE':
+                return subinstr.opcode
 
-'''
-        count = 0
+        return None
+
+    def find_subinstr(self, opcode):
         for name, instr in self.instr_list.items():
-            res = res + 'subinstr_t ' + instr.get_list_name()
-            res = res + '[] = {\n'
-            count = 0
             for subinstr in instr.list:
-                res = res + str(subinstr) \
-                    + (',\n' if count <= len(instr.list) - 2 else '')
-                count = count + 1
+                if subinstr.opcode == opcode \
+                   and subinstr.supported == 'CPU_6502_CORE':
+                    return name, subinstr.mode.split(' ')[0][5:]
+
+        return None, None
+
+    # what each model decodes, by opcode; a later line for an opcode
+    # takes its place on the models it names
+    def model_tables(self):
+        lines = []
+        for handler, (name, instr) in enumerate(self.instr_list.items()):
+            for subinstr in instr.list:
+                lines.append((subinstr.index, handler, name, subinstr))
+
+        tables = OrderedDict([(model, [None] * 256) for model in MODELS])
+        for _, handler, name, subinstr in sorted(lines,
+                                                 key=lambda l: l[0]):
+            for model in subinstr.models():
+                tables[model][subinstr.opcode] = (handler, name, subinstr)
+
+        return tables
+
+    # one descriptor per opcode and model, indexed by opcode; handlers
+    # index instr_list, and supported has the models whose table holds
+    # the descriptor
+    def opdesc_table(self):
+        tables = self.model_tables()
+        res = ''
+
+        for model, table in tables.items():
+            descs = []
+            for opcode, entry in enumerate(table):
+                if entry is None:
+                    descs.append('\t/* {:02x} ??? */\n\tOPDESC_INVALID'.format(
+                        opcode))
+                    continue
+
+                handler, name, subinstr = entry
+                models = [m for m in tables if tables[m][opcode]
+                          and tables[m][opcode][2] is subinstr]
+                supported = 'CPU_6502_CORE' if len(models) == len(tables) \
+                    else ' | '.join(models)
+                descs.append('\t/* {:02x} {} */\n{}'.format(
+                    opcode, name, subinstr.opdesc(handler, supported)))
+
+            res = res + 'static const opdesc_t opdesc_{}[INSTR_MAP_SIZE] = {{\n'.format(
+                MODELS[model])
+            res = res + ',\n'.join(descs)
             res = res + '\n};\n\n'
-        print(res[:-1]) # cheap way to account for the extra newline
 
-        res = 'instr_t instr_list[] = {\n'
+        res = res + 'const opdesc_t* get_model_opdesc_table(cpu_model_t model) {\n'
+        res = res + '\tswitch (model) {\n'
+        for model in list(MODELS)[1:]:
+            res = res + '\tcase {}:\n\t\treturn opdesc_{};\n'.format(
+                model, MODELS[model])
+        res = res + '\tdefault:\n\t\treturn opdesc_{};\n\t}}\n}}'.format(
+            MODELS[list(MODELS)[0]])
+
+        return res
+
+    def print_c(self, fused):
+        res = '''#include <stdlib.h>
+
+#include "cpu.h"
+#include "instr.h"
+
+'''
+        res = res + 'instr_t instr_list[] = {\n'
         count = 0
         for name, instr in self.instr_list.items():
             res = res + str(instr)
@@ -65,32 +145,31 @@ size_t get_instr_list_size(void) {
 	return sizeof(instr_list) / sizeof(*instr_list);
 }'''
         print(res)
+        print('')
+        print(self.opdesc_table())
+        print('')
+        print(fused.c_str())
 
 class Subinstr():
 
-    regex = re.compile('^([A-Z_]+)\s+([A-Z]..)\s+\$([0-9A-F].)\s+([0-9])\s+([0-9]\+?)$')
+    regex = re.compile('^([A-Z_]+)\s+([A-Z]..)\s+\$([0-9A-F].)\s+([0-9])\s+([0-9]\+?)(?:\s+([A-Z0-9]+))?\s*$')
 
-    def __init__(self, opcode, cycles, length, mode, extra=False, supported='CPU_6502_CORE'):
+    def __init__(self, opcode, cycles, length, mode, extra=False, supported='CPU_6502_CORE', index=0):
         self.opcode = opcode
         self.cycles = cycles
         self.extra = extra
         self.length = length
         self.mode = mode
         self.supported = supported
+        self.index = index
 
-    def __str__(self):
-        return self.__repr__()
-
-    def __repr__(self):
-        res = '\t(subinstr_t) {'
-        res = res + '\n\t\t.opcode = {},'.format(hex(self.opcode))
-        res = res + '\n\t\t.cycles = {},'.format(self.cycles)
-        res = res + '\n\t\t.length = {},'.format(self.length)
-        res = res + '\n\t\t.mode = {}{},'.format(self.mode, 'MODE_EXTRA_CYCLE' if self.extra else '')
-        res = res + '\n\t\t.supported = {}'.format(self.supported)
-        res = res + '\n\t}'
+    def models(self):
+        return list(MODELS) if self.supported == 'CPU_6502_CORE' \
+            else [self.supported]
 
-        return res
+    def opdesc(self, handler, supported):
+        return '\tOPDESC({}, {}, {}, {}, {})'.format(
+            handler, self.mode, self.length, self.cycles, supported)
 
 class Instr():
 
@@ -100,9 +179,6 @@ class Instr():
 
         return
 
-    def get_list_name(self):
-        return '{}_{}'.format(self.name.lower(), 'list' if len(self.list) > 1 else 'single')
-
     def get_action_name(self):
         return '{}_action'.format(self.name.lower())
 
@@ -112,14 +188,187 @@ class Instr():
     def __repr__(self):
         res = '\t(instr_t) {'
         res = res + '\n\t\t.name = "{}",'.format(self.name)
-        res = res + '\n\t\t.list = {},'.format(self.get_list_name())
-        res = res + '\n\t\t.size = {},'.format(len(self.list))
         res = res + '\n\t\t.action = NULL'
         res = res + '\n\t}'
 
         return res
 
+class FusedList():
+
+    # instructions that may leave the next opcode unexecuted
+    flow = ['BPL', 'BMI', 'BVC', 'BVS', 'BCC', 'BCS', 'BNE', 'BEQ',
+            'BRA', 'BRK', 'JMP', 'JSR', 'RTI', 'RTS']
+
+    # all but the last instruction of a sequence touch no memory, so
+    # none of them can stop the run half way or change what follows
+    leading_modes = ['REGISTER', 'IMMEDIATE', 'STATUS', 'ACCUMULATOR',
+                     'IMPLIED']
+
+    # FUSED_MAX in instr.h
+    max_count = 3
+
+    actions_regex = re.compile('add_action\((\w+)\)')
+
+    def __init__(self, opcodes, actions):
+        self.opcodes = opcodes
+        self.seqs = []
+
+        # the handlers call the actions by name, so each instruction
+        # needs one in every model
+        with open(actions, mode='r') as file:
+            self.actions = set(FusedList.actions_regex.findall(file.read()))
+
+    def can_fuse(self, names, modes):
+        return all(name in self.actions for name in names) \
+            and all(name not in FusedList.flow
+                    and mode in FusedList.leading_modes
+                    for name, mode in zip(names[:-1], modes[:-1]))
+
+    def load(self, filename):
+        with open(filename, mode='r') as file:
+            for line in file.readlines():
+                line = line.split('#')[0].strip()
+                if not line:
+                    continue
+
+                fields = line.split()
+                if len(fields) % 2 \
+                   or not 2 <= len(fields) // 2 <= FusedList.max_count:
+                    raise Exception('Invalid fused sequence: "{}"'.format(line))
+
+                names = fields[0::2]
+                modes = fields[1::2]
+                opcodes = [self.opcodes.find_opcode(name, mode)
+                           for name, mode in zip(names, modes)]
+                if None in opcodes:
+                    raise Exception('Unknown instruction in "{}"'.format(line))
+
+                if not self.can_fuse(names, modes):
+                    raise Exception('Cannot fuse "{}"'.format(line))
+
+                self.seqs.append((names, opcodes))
+
+    # picks the most frequent pairs from a profile (see --profile in
+    # sikso2), at most one per first opcode
+    def from_profile(self, filename, top):
+        firsts = set()
+
+        with open(filename, mode='r') as file:
+            for line in file.readlines():
+                fields = line.split('#')[0].split()
+                if len(fields) < 3:
+                    continue
+
+                opcodes = [int(fields[1], 16), int(fields[2], 16)]
+                found = [self.opcodes.find_subinstr(opcode)
+                         for opcode in opcodes]
+                names = [name for name, _ in found]
+                modes = [mode for _, mode in found]
+
+                if None in names or not self.can_fuse(names, modes) \
+                   or opcodes[0] in firsts:
+                    continue
+
+                firsts.add(opcodes[0])
+                self.seqs.append((names, opcodes))
+
+                if len(self.seqs) == top:
+                    break
+
+    def __str__(self):
+        res = '# generated from profile by scripts/genops.py\n'
+        for _, opcodes in self.seqs:
+            res = res + ' '.join(['{} {}'.format(
+                *self.opcodes.find_subinstr(opcode))
+                                  for opcode in opcodes]) + '\n'
+
+        return res[:-1]
+
+    def c_str(self):
+        if not self.seqs:
+            return '''fused_t* get_fused_list(void) {
+	return NULL;
+}
+
+size_t get_fused_list_size(void) {
+	return 0;
+}'''
+
+        res = 'fused_t fused_list[] = {\n'
+        res = res + ',\n'.join(['\t(fused_t) {{'
+                                 '\n\t\t.opcodes = {{ {} }},'
+                                 '\n\t\t.count = {},'
+                                 '\n\t\t.action = NULL'
+                                 '\n\t}}'.format(
+                                     ', '.join([hex(opcode)
+                                                for opcode in opcodes]),
+                                     len(opcodes))
+                                 for _, opcodes in self.seqs])
+        res = res + '''
+};
+
+fused_t* get_fused_list(void) {
+	return fused_list;
+}
+
+size_t get_fused_list_size(void) {
+	return sizeof(fused_list) / sizeof(*fused_list);
+}'''
+
+        return res
+
+    # one handler per sequence, in the order of fused_list, for
+    # source/cpu6502-actions.c to include
+    def actions_str(self):
+        res = '''#ifndef CPU6502_FUSED_H
+#define CPU6502_FUSED_H
+
+/* generated by scripts/genops.py from scripts/fused.txt */
+'''
+        for names, _ in self.seqs:
+            res = res + '\nDEFINE_FUSED({}) {{\n\n'.format('_'.join(names))
+            for i, name in enumerate(names[:-1]):
+                res = res + '\t{}_action(ops[{}], args[{}], regs, data);\n'.format(
+                    name, i, i)
+            res = res + '\n\treturn {}_action(ops[{}], args[{}], regs, data);\n}}\n'.format(
+                names[-1], len(names) - 1, len(names) - 1)
+
+        if self.seqs:
+            res = res + '\nstatic const fused_action_t fused_actions[] = {\n'
+            res = res + ',\n'.join(['\t{}_fused'.format('_'.join(names))
+                                     for names, _ in self.seqs])
+            res = res + '\n};\n'
+        else:
+            res = res + '\nstatic const fused_action_t* const fused_actions = NULL;\n'
+
+        res = res + '\n#endif'
+
+        return res
+
 if __name__ == "__main__":
 
-    OpcodeList("scripts/6502ops.txt").print_c()
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--profile', help='print fused pairs for a '
+                        'profile written by sikso2 --profile')
+    parser.add_argument('--top', type=int, default=8,
+                        help='number of pairs to take from the profile')
+    parser.add_argument('--fused-actions', action='store_true',
+                        help='print the handlers of the fused sequences')
+    args = parser.parse_args()
+
+    opcodes = OpcodeList("scripts/6502ops.txt")
+    fused = FusedList(opcodes, "source/cpu6502-actions.c")
+
+    if args.profile:
+        fused.from_profile(args.profile, args.top)
+        print(fused)
+        sys.exit(0)
+
+    fused.load("scripts/fused.txt")
+
+    if args.fused_actions:
+        print(fused.actions_str())
+        sys.exit(0)
+
+    opcodes.print_c(fused)
 
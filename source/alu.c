@@ -0,0 +1,123 @@
+#include "alu.h"
+
+#include <stdbool.h>
+
+uint8_t alu_nz[256];
+uint16_t alu_adc_table[ALU_VARIANTS][ALU_OPERANDS];
+uint16_t alu_sbc_table[ALU_VARIANTS][ALU_OPERANDS];
+
+#define alu_entry(res, flags) \
+	((uint16_t)(flags) << 8 | (uint8_t)(res))
+
+static uint16_t adc_binary(uint8_t a, uint8_t b, uint8_t c) {
+	unsigned int sum;
+	uint8_t flags;
+
+	sum = a + b + c;
+
+	flags = alu_nz[(uint8_t)sum];
+	if (sum > 0xFF)
+		flags |= ALU_C;
+	if (~(a ^ b) & (a ^ sum) & 0x80)
+		flags |= ALU_V;
+
+	return alu_entry(sum, flags);
+}
+
+/* NMOS behaviour: Z comes from the binary sum, N and V from the sum
+ * before the high nibble is adjusted */
+static uint16_t adc_decimal(uint8_t a, uint8_t b, uint8_t c) {
+	uint8_t lo;
+	uint8_t hi;
+	uint8_t flags;
+
+	flags = 0;
+
+	lo = (a & 0xF) + (b & 0xF) + c;
+	if (lo > 9)
+		lo += 6;
+
+	hi = (a >> 4) + (b >> 4) + (lo > 0xF);
+
+	if (!(uint8_t)(a + b + c))
+		flags |= ALU_Z;
+	else if (hi & 0x8)
+		flags |= ALU_N;
+
+	if (~(a ^ b) & (a ^ (uint8_t)(hi << 4)) & 0x80)
+		flags |= ALU_V;
+
+	if (hi > 9)
+		hi += 6;
+	if (hi > 0xF)
+		flags |= ALU_C;
+
+	return alu_entry((hi << 4) | (lo & 0xF), flags);
+}
+
+/* flags follow the binary difference, only the result is adjusted */
+static uint16_t sbc_decimal(uint8_t a, uint8_t b, uint8_t c) {
+	unsigned int diff;
+	int8_t lo;
+	int8_t hi;
+	uint8_t flags;
+
+	flags = 0;
+	diff = a - b - !c;
+
+	lo = (a & 0xF) - (b & 0xF) - !c;
+	if (lo < 0)
+		lo -= 6;
+
+	hi = (a >> 4) - (b >> 4) - (lo < 0);
+	if (hi < 0)
+		hi -= 6;
+
+	if (!(uint8_t)diff)
+		flags |= ALU_Z;
+	else if (diff & 0x80)
+		flags |= ALU_N;
+
+	if ((a ^ b) & (a ^ diff) & 0x80)
+		flags |= ALU_V;
+
+	if (!(diff & 0xFF00))
+		flags |= ALU_C;
+
+	return alu_entry(((uint8_t)hi << 4) | (lo & 0xF), flags);
+}
+
+void init_alu(void) {
+	static bool initialized = false;
+	unsigned int i;
+	unsigned int a;
+	unsigned int b;
+	uint8_t c;
+
+	if (initialized)
+		return;
+
+	for (i = 0; i < 256; i++)
+		alu_nz[i] = (i ? 0 : ALU_Z) | (i & ALU_N);
+
+	for (i = 0; i < ALU_VARIANTS; i++) {
+		c = i & ALU_C;
+
+		for (a = 0; a < 256; a++) {
+			for (b = 0; b < 256; b++) {
+				alu_adc_table[i][alu_operands(a, b)] = i & 0x2
+					? adc_decimal(a, b, c)
+					: adc_binary(a, b, c);
+
+				/* binary subtraction adds the complement */
+				alu_sbc_table[i][alu_operands(a, b)] = i & 0x2
+					? sbc_decimal(a, b, c)
+					: adc_binary(a, ~b, c);
+			}
+		}
+	}
+
+	initialized = true;
+
+	return;
+}
@@ -0,0 +1,849 @@
+#include "aot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+#define ASIG "AOT"
+
+#define loga_err(FMT, ...) log_err(ASIG, FMT, ## __VA_ARGS__)
+
+#ifdef AOT_TRACE
+#define atrace(FMT, ...) trace(FMT, ## __VA_ARGS__)
+#define atracei(FMT, ...) tracei(ASIG, FMT, ## __VA_ARGS__)
+#else
+#define atrace(FMT, ...) ;
+#define atracei(FMT, ...) ;
+#endif
+
+/* FNV-1a */
+uint32_t aot_hash(const uint8_t* data, unsigned int size) {
+	uint32_t hash;
+	unsigned int i;
+
+	hash = 2166136261u;
+
+	for (i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/* per-byte marks of the image */
+#define AOT_DECODED	0x1	/* an instruction starts here */
+#define AOT_LEADER	0x2	/* a block starts here */
+#define AOT_RETURN	0x4	/* a JSR returns here */
+
+struct aot_t {
+	const uint8_t* data;
+	unsigned int size;
+	uint16_t load_addr;
+	const opdesc_t* opdesc;
+	cpu_model_t model;
+	uint8_t* marks;
+	bool computed;	/* has a JMP (ind), RTS or RTI, which need the
+			 * dispatch */
+	bool has_rts;
+	uint16_t* returns;	/* return addresses, by JSR site */
+	unsigned int num_returns;
+	FILE* f;
+	/* block being emitted */
+	unsigned int cycles;
+	unsigned int instrs;
+};
+
+struct aot_instr_t {
+	uint16_t addr;
+	uint16_t next;
+	uint16_t arg;
+	instr_mode_t mode;
+	bool extra;
+	const opdesc_t* op;
+	const struct aot_emitter_t* emitter;
+};
+
+typedef void(*aot_emit_fn)(struct aot_t* aot, struct aot_instr_t* in);
+
+struct aot_emitter_t {
+	char name[3];
+	aot_emit_fn gen;
+	bool writes;	/* stores to memory (outside the accumulator mode) */
+	bool ends;	/* ends the block */
+};
+
+#define in_image(aot, addr) \
+	((uint16_t)((addr) - (aot)->load_addr) < (aot)->size)
+
+#define mark(aot, addr) ((aot)->marks[(uint16_t)((addr) - (aot)->load_addr)])
+
+#define branch_target(in) ((uint16_t)((in)->next + (int8_t)(in)->arg))
+
+#define emit(aot, FMT, ...) fprintf((aot)->f, FMT, ## __VA_ARGS__)
+
+/* ======= operands ======= */
+
+#define is_zero_page_mode(mode) \
+	((mode) == MODE_ZERO_PAGE || (mode) == MODE_ZERO_PAGE_X \
+	 || (mode) == MODE_ZERO_PAGE_Y)
+
+#define access_suffix(in) (is_zero_page_mode((in)->mode) ? "_zp" : "")
+
+static void emit_ea(struct aot_t* aot, struct aot_instr_t* in, bool read) {
+
+	switch (in->mode) {
+	case MODE_ZERO_PAGE:
+	case MODE_ABSOLUTE:
+		emit(aot, "\tea = 0x%.4x;\n", in->arg);
+		break;
+	case MODE_ZERO_PAGE_X:
+		emit(aot, "\tea = (uint8_t)(0x%.2x + X);\n", in->arg);
+		break;
+	case MODE_ZERO_PAGE_Y:
+		emit(aot, "\tea = (uint8_t)(0x%.2x + Y);\n", in->arg);
+		break;
+	case MODE_ABSOLUTE_X:
+		emit(aot, "\tea = (uint16_t)(0x%.4x + X);\n", in->arg);
+		if (read && in->extra)
+			emit(aot, "\tAOT_EXTRA_CYCLE(0x%.4x, ea);\n", in->arg);
+		break;
+	case MODE_ABSOLUTE_Y:
+		emit(aot, "\tea = (uint16_t)(0x%.4x + Y);\n", in->arg);
+		if (read && in->extra)
+			emit(aot, "\tAOT_EXTRA_CYCLE(0x%.4x, ea);\n", in->arg);
+		break;
+	case MODE_INDIRECT_X:
+		emit(aot, "\tea = AOT_READ16_ZP(0x%.2x + X);\n", in->arg);
+		break;
+	case MODE_INDIRECT_Y:
+		emit(aot, "\te = AOT_READ16_ZP(0x%.2x);\n", in->arg);
+		emit(aot, "\tea = (uint16_t)(e + Y);\n");
+		if (read && in->extra)
+			emit(aot, "\tAOT_EXTRA_CYCLE(e, ea);\n");
+		break;
+	default:
+		break;
+	}
+
+	return;
+}
+
+static void emit_load(struct aot_t* aot, struct aot_instr_t* in) {
+
+	if (in->mode == MODE_IMMEDIATE) {
+		emit(aot, "\tv = 0x%.2x;\n", in->arg);
+		return;
+	}
+
+	emit_ea(aot, in, true);
+	emit(aot, "\tv = device_read%s(device, ea);\n", access_suffix(in));
+
+	return;
+}
+
+static void emit_store(struct aot_t* aot, struct aot_instr_t* in,
+		       const char* val) {
+
+	emit_ea(aot, in, false);
+	emit(aot, "\tdevice_write%s(device, ea, %s);\n", access_suffix(in), val);
+
+	return;
+}
+
+/* ======= instructions ======= */
+
+/* the 65C02 takes N and Z from a decimal result, a cycle later */
+static void emit_decimal_fixup(struct aot_t* aot) {
+
+	if (aot->model == CPU_6502_65C02)
+		emit(aot, "\tif (P & 0x08) {\n\t\tAOT_NZ(A);\n"
+			  "\t\tdevice->cycles++;\n\t}\n");
+
+	return;
+}
+
+static void emit_adc(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_load(aot, in);
+	emit(aot, "\tAOT_ALU(alu_adc_table, v);\n");
+	emit_decimal_fixup(aot);
+
+	return;
+}
+
+static void emit_sbc(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_load(aot, in);
+	emit(aot, "\tAOT_ALU(alu_sbc_table, v);\n");
+	emit_decimal_fixup(aot);
+
+	return;
+}
+
+static void emit_and(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_load(aot, in);
+	emit(aot, "\tA &= v;\n\tAOT_NZ(A);\n");
+
+	return;
+}
+
+static void emit_eor(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_load(aot, in);
+	emit(aot, "\tA ^= v;\n\tAOT_NZ(A);\n");
+
+	return;
+}
+
+static void emit_asl(struct aot_t* aot, struct aot_instr_t* in) {
+
+	if (in->mode == MODE_ACCUMULATOR) {
+		emit(aot, "\tP = (P & ~ALU_C) | (A >> 7);\n"
+			  "\tA <<= 1;\n\tAOT_NZ(A);\n");
+		return;
+	}
+
+	emit_load(aot, in);
+	emit(aot, "\tP = (P & ~ALU_C) | (v >> 7);\n"
+		  "\tv <<= 1;\n\tAOT_NZ(v);\n");
+	emit(aot, "\tdevice_write%s(device, ea, v);\n", access_suffix(in));
+
+	return;
+}
+
+static void emit_bit(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_load(aot, in);
+	emit(aot, "\tP = (P & ~(ALU_N | ALU_V | ALU_Z)) | (v & (ALU_N | ALU_V))"
+		  " | ((A & v) ? 0 : ALU_Z);\n");
+
+	return;
+}
+
+static void emit_cmp(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_load(aot, in);
+	emit(aot, "\tAOT_CMP(A, v);\n");
+
+	return;
+}
+
+static void emit_cpx(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_load(aot, in);
+	emit(aot, "\tAOT_CMP(X, v);\n");
+
+	return;
+}
+
+static void emit_cpy(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_load(aot, in);
+	emit(aot, "\tAOT_CMP(Y, v);\n");
+
+	return;
+}
+
+static void emit_dec(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_load(aot, in);
+	emit(aot, "\tv--;\n\tAOT_NZ(v);\n");
+	emit(aot, "\tdevice_write%s(device, ea, v);\n", access_suffix(in));
+
+	return;
+}
+
+static void emit_lda(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_load(aot, in);
+	emit(aot, "\tA = v;\n\tAOT_NZ(A);\n");
+
+	return;
+}
+
+static void emit_sta(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit_store(aot, in, "A");
+
+	return;
+}
+
+static void emit_nop(struct aot_t* aot, struct aot_instr_t* in) {
+
+	return;
+}
+
+static void emit_flag(struct aot_t* aot, struct aot_instr_t* in) {
+	static const struct {
+		char name[3];
+		const char* code;
+	} flags[] = {
+		{ "CLC", "P &= ~0x01;" },
+		{ "SEC", "P |= 0x01;" },
+		{ "CLI", "P &= ~0x04;" },
+		{ "SEI", "P |= 0x04;" },
+		{ "CLD", "P &= ~0x08;" },
+		{ "SED", "P |= 0x08;" },
+		{ "CLV", "P &= ~0x40;" }
+	};
+	unsigned int i;
+
+	for (i = 0; i < sizeof(flags) / sizeof(*flags); i++)
+		if (!strncmp(in->emitter->name, flags[i].name, 3))
+			emit(aot, "\t%s\n", flags[i].code);
+
+	return;
+}
+
+/* sums what the block ran so far; the instruction before it is already
+ * in them */
+#define emit_count(aot) \
+	emit(aot, "\tAOT_COUNT(%u, %u);\n", (aot)->cycles, (aot)->instrs)
+
+/* a backward jump over a body that cannot write may be an idle loop, so
+ * it goes back to the interpreter, which knows how to skip those */
+static bool may_idle(struct aot_t* aot, uint16_t head, uint16_t jump);
+
+static void emit_jmp(struct aot_t* aot, struct aot_instr_t* in) {
+
+	if (in->mode == MODE_INDIRECT) {
+		emit(aot, "\tpc = AOT_READ16_JMP(0x%.4x);\n", in->arg);
+		emit(aot, "\tAOT_CHECK(pc, %u, %u);\n",
+		     aot->cycles, aot->instrs);
+		emit_count(aot);
+		emit(aot, "\tgoto aot_dispatch;\n");
+		return;
+	}
+
+	emit(aot, "\tAOT_CHECK(0x%.4x, %u, %u);\n", in->arg,
+	     aot->cycles, aot->instrs);
+	emit_count(aot);
+
+	if (in_image(aot, in->arg) && (mark(aot, in->arg) & AOT_LEADER)
+	 && !(in->arg <= in->addr && may_idle(aot, in->arg, in->addr)))
+		emit(aot, "\tgoto L%.4x;\n", in->arg);
+	else if (in->arg <= in->addr)
+		emit(aot, "\tAOT_EXIT(0x%.4x, DEVICE_JUMP_BACK);\n", in->arg);
+	else
+		emit(aot, "\tAOT_EXIT(0x%.4x, 0);\n", in->arg);
+
+	return;
+}
+
+/* a branch taken chains straight to the block it lands on, with its
+ * cycle and the one for crossing a page known here; not taken, the
+ * block goes on */
+static void emit_branch(struct aot_t* aot, struct aot_instr_t* in) {
+	static const struct {
+		char name[3];
+		const char* cond;
+	} conds[] = {
+		{ "BPL", "!(P & 0x80)" },
+		{ "BMI", "P & 0x80" },
+		{ "BVC", "!(P & 0x40)" },
+		{ "BVS", "P & 0x40" },
+		{ "BCC", "!(P & 0x01)" },
+		{ "BCS", "P & 0x01" },
+		{ "BNE", "!(P & 0x02)" },
+		{ "BEQ", "P & 0x02" }
+	};
+	unsigned int cycles;
+	unsigned int i;
+	uint16_t target;
+
+	target = branch_target(in);
+	cycles = aot->cycles + 1 + (((in->next ^ target) & 0xFF00) != 0);
+
+	for (i = 0; i < sizeof(conds) / sizeof(*conds); i++)
+		if (!strncmp(in->emitter->name, conds[i].name, 3))
+			emit(aot, "\tif (%s) {\n", conds[i].cond);
+
+	emit(aot, "\t\tAOT_CHECK(0x%.4x, %u, %u);\n", target, cycles,
+	     aot->instrs);
+	emit(aot, "\t\tAOT_COUNT(%u, %u);\n", cycles, aot->instrs);
+
+	if (in_image(aot, target) && (mark(aot, target) & AOT_LEADER)
+	 && !(target <= in->addr && may_idle(aot, target, in->addr)))
+		emit(aot, "\t\tgoto L%.4x;\n", target);
+	else if (target <= in->addr)
+		emit(aot, "\t\tAOT_EXIT(0x%.4x, DEVICE_JUMP_BACK);\n",
+		     target);
+	else
+		emit(aot, "\t\tAOT_EXIT(0x%.4x, 0);\n", target);
+
+	emit(aot, "\t}\n");
+
+	return;
+}
+
+/* ======= subroutines and the stack ======= */
+
+/* the return address is a leader whenever it is in the image, so the
+ * RTS can be predicted to land on it */
+static void emit_jsr(struct aot_t* aot, struct aot_instr_t* in) {
+	uint16_t ret;
+
+	ret = in->next - 1;
+
+	emit(aot, "\tAOT_PUSH(0x%.2x);\n\tAOT_PUSH(0x%.2x);\n", ret >> 8,
+	     ret & 0xFF);
+
+	if (in_image(aot, in->next) && (mark(aot, in->next) & AOT_RETURN)) {
+		emit(aot, "\tAOT_RAS_PUSH(0x%.4x, %u);\n", in->next,
+		     aot->num_returns);
+		aot->returns[aot->num_returns++] = in->next;
+	}
+
+	emit(aot, "\tAOT_CHECK_STORE(0x%.4x, %u, %u);\n", in->arg,
+	     aot->cycles, aot->instrs);
+	emit_count(aot);
+
+	if (in_image(aot, in->arg) && (mark(aot, in->arg) & AOT_LEADER))
+		emit(aot, "\tgoto L%.4x;\n", in->arg);
+	else
+		emit(aot, "\tAOT_EXIT(0x%.4x, 0);\n", in->arg);
+
+	return;
+}
+
+static void emit_rts(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit(aot, "\te = AOT_PULL();\n\te |= (uint16_t)AOT_PULL() << 8;\n"
+		  "\tpc = (uint16_t)(e + 1);\n");
+	emit(aot, "\tAOT_CHECK(pc, %u, %u);\n", aot->cycles, aot->instrs);
+	emit_count(aot);
+	emit(aot, "\tgoto aot_return;\n");
+
+	return;
+}
+
+static void emit_rti(struct aot_t* aot, struct aot_instr_t* in) {
+
+	emit(aot, "\tP = p_pulled(AOT_PULL());\n"
+		  "\te = AOT_PULL();\n\te |= (uint16_t)AOT_PULL() << 8;\n"
+		  "\tpc = e;\n");
+	emit(aot, "\tAOT_CHECK(pc, %u, %u);\n", aot->cycles, aot->instrs);
+	emit_count(aot);
+	emit(aot, "\tgoto aot_dispatch;\n");
+
+	return;
+}
+
+static void emit_stack(struct aot_t* aot, struct aot_instr_t* in) {
+	static const struct {
+		char name[3];
+		const char* code;
+	} ops[] = {
+		{ "PHA", "AOT_PUSH(A);" },
+		{ "PHP", "AOT_PUSH(p_pushed(P, true));" },
+		{ "PLA", "A = AOT_PULL();\n\tAOT_NZ(A);" },
+		{ "PLP", "P = p_pulled(AOT_PULL());" },
+		{ "TSX", "X = S;\n\tAOT_NZ(X);" },
+		{ "TXS", "S = X;" }
+	};
+	unsigned int i;
+
+	for (i = 0; i < sizeof(ops) / sizeof(*ops); i++)
+		if (!strncmp(in->emitter->name, ops[i].name, 3))
+			emit(aot, "\t%s\n", ops[i].code);
+
+	return;
+}
+
+static void emit_register(struct aot_t* aot, struct aot_instr_t* in) {
+	static const struct {
+		char name[3];
+		const char* code;
+	} ops[] = {
+		{ "TAX", "X = A;\n\tAOT_NZ(X);" },
+		{ "TXA", "A = X;\n\tAOT_NZ(A);" },
+		{ "TAY", "Y = A;\n\tAOT_NZ(Y);" },
+		{ "TYA", "A = Y;\n\tAOT_NZ(A);" },
+		{ "DEX", "X--;\n\tAOT_NZ(X);" },
+		{ "INX", "X++;\n\tAOT_NZ(X);" },
+		{ "DEY", "Y--;\n\tAOT_NZ(Y);" },
+		{ "INY", "Y++;\n\tAOT_NZ(Y);" }
+	};
+	unsigned int i;
+
+	for (i = 0; i < sizeof(ops) / sizeof(*ops); i++)
+		if (!strncmp(in->emitter->name, ops[i].name, 3))
+			emit(aot, "\t%s\n", ops[i].code);
+
+	return;
+}
+
+/* only what the interpreter has actions for, as every NMOS model decodes
+ * it; the rest (and BRK) is left to it */
+static const struct aot_emitter_t emitters[] = {
+	{ "ADC", emit_adc,	false,	false },
+	{ "AND", emit_and,	false,	false },
+	{ "ASL", emit_asl,	true,	false },
+	{ "BIT", emit_bit,	false,	false },
+	{ "BPL", emit_branch,	false,	false },
+	{ "BMI", emit_branch,	false,	false },
+	{ "BVC", emit_branch,	false,	false },
+	{ "BVS", emit_branch,	false,	false },
+	{ "BCC", emit_branch,	false,	false },
+	{ "BCS", emit_branch,	false,	false },
+	{ "BNE", emit_branch,	false,	false },
+	{ "BEQ", emit_branch,	false,	false },
+	{ "CMP", emit_cmp,	false,	false },
+	{ "CPX", emit_cpx,	false,	false },
+	{ "CPY", emit_cpy,	false,	false },
+	{ "DEC", emit_dec,	true,	false },
+	{ "EOR", emit_eor,	false,	false },
+	{ "CLC", emit_flag,	false,	false },
+	{ "SEC", emit_flag,	false,	false },
+	{ "CLI", emit_flag,	false,	false },
+	{ "SEI", emit_flag,	false,	false },
+	{ "CLV", emit_flag,	false,	false },
+	{ "CLD", emit_flag,	false,	false },
+	{ "SED", emit_flag,	false,	false },
+	{ "JMP", emit_jmp,	false,	true },
+	{ "JSR", emit_jsr,	true,	true },
+	{ "RTS", emit_rts,	false,	true },
+	{ "RTI", emit_rti,	false,	true },
+	{ "PHA", emit_stack,	true,	false },
+	{ "PHP", emit_stack,	true,	false },
+	{ "PLA", emit_stack,	false,	false },
+	{ "PLP", emit_stack,	false,	false },
+	{ "TSX", emit_stack,	false,	false },
+	{ "TXS", emit_stack,	false,	false },
+	{ "TAX", emit_register,	false,	false },
+	{ "TXA", emit_register,	false,	false },
+	{ "TAY", emit_register,	false,	false },
+	{ "TYA", emit_register,	false,	false },
+	{ "DEX", emit_register,	false,	false },
+	{ "INX", emit_register,	false,	false },
+	{ "DEY", emit_register,	false,	false },
+	{ "INY", emit_register,	false,	false },
+	{ "LDA", emit_lda,	false,	false },
+	{ "NOP", emit_nop,	false,	false },
+	{ "SBC", emit_sbc,	false,	false },
+	{ "STA", emit_sta,	true,	false }
+};
+
+/* ======= decoding ======= */
+
+static bool decode(struct aot_t* aot, uint16_t addr, struct aot_instr_t* in) {
+	const opdesc_t* op;
+	unsigned int offset;
+	unsigned int i;
+
+	if (!in_image(aot, addr))
+		return false;
+
+	offset = (uint16_t)(addr - aot->load_addr);
+	op = &(aot->opdesc[aot->data[offset]]);
+
+	if (!opdesc_valid(op) || !opdesc_instr(op)->action
+	 || !(op->supported & CPU_6502_NMOS)
+	 || offset + opdesc_length(op) > aot->size)
+		return false;
+
+	in->emitter = NULL;
+
+	for (i = 0; i < sizeof(emitters) / sizeof(*emitters); i++)
+		if (!strncmp(opdesc_name(op), emitters[i].name, 3))
+			in->emitter = &emitters[i];
+
+	if (!in->emitter)
+		return false;
+
+	in->addr = addr;
+	in->next = addr + opdesc_length(op);
+	in->op = op;
+	in->mode = opdesc_mode(op);
+	in->extra = opdesc_extra(op);
+
+	switch (opdesc_length(op)) {
+	case 3:
+		in->arg = aot->data[offset + 1]
+			| (uint16_t)aot->data[offset + 2] << 8;
+		break;
+	case 2:
+		in->arg = aot->data[offset + 1];
+		break;
+	default:
+		in->arg = 0;
+		break;
+	}
+
+	return true;
+}
+
+#define is_jmp_abs(in) \
+	(!strncmp((in)->emitter->name, "JMP", 3) \
+	 && (in)->mode == MODE_ABSOLUTE)
+
+#define is_branch(in) ((in)->mode == MODE_BRANCH)
+
+#define is_jsr(in) (!strncmp((in)->emitter->name, "JSR", 3))
+
+#define is_return(in) \
+	(!strncmp((in)->emitter->name, "RTS", 3) \
+	 || !strncmp((in)->emitter->name, "RTI", 3))
+
+static bool may_idle(struct aot_t* aot, uint16_t head, uint16_t jump) {
+	struct aot_instr_t in;
+	uint16_t addr;
+
+	for (addr = head; addr != jump; addr = in.next) {
+		if (!decode(aot, addr, &in) || in.emitter->ends
+		 || (in.emitter->writes && in.mode != MODE_ACCUMULATOR)
+		 || in.next > jump)
+			return false;
+	}
+
+	return true;
+}
+
+/* follows fall-through, branches, direct jumps and calls from the load
+ * address; blocks start where branches, jumps and calls land, where
+ * calls return to and where a path runs into decoded code */
+static int find_blocks(struct aot_t* aot) {
+	struct aot_instr_t in;
+	struct aot_instr_t target;
+	uint16_t* stack;
+	unsigned int top;
+	uint16_t addr;
+
+	stack = malloc(sizeof(*stack) * (aot->size + 1));
+	if (!stack) {
+		loga_err("Could not allocate block stack.");
+		return -1;
+	}
+
+	top = 0;
+	stack[top++] = aot->load_addr;
+	mark(aot, aot->load_addr) |= AOT_LEADER;
+
+	while (top) {
+		addr = stack[--top];
+
+		while (decode(aot, addr, &in)) {
+			if (mark(aot, addr) & AOT_DECODED) {
+				mark(aot, addr) |= AOT_LEADER;
+				break;
+			}
+
+			mark(aot, addr) |= AOT_DECODED;
+
+			if ((is_jmp_abs(&in) || is_jsr(&in))
+			 && decode(aot, in.arg, &target)
+			 && !(mark(aot, target.addr) & AOT_LEADER)) {
+				mark(aot, target.addr) |= AOT_LEADER;
+				stack[top++] = target.addr;
+			}
+
+			if (is_branch(&in)
+			 && decode(aot, branch_target(&in), &target)
+			 && !(mark(aot, target.addr) & AOT_LEADER)) {
+				mark(aot, target.addr) |= AOT_LEADER;
+				stack[top++] = target.addr;
+			}
+
+			if (is_jsr(&in) && decode(aot, in.next, &target)) {
+				if (!(mark(aot, target.addr) & AOT_LEADER)) {
+					mark(aot, target.addr) |= AOT_LEADER;
+					stack[top++] = target.addr;
+				}
+
+				mark(aot, target.addr) |= AOT_RETURN;
+			}
+
+			if (!strncmp(in.emitter->name, "JMP", 3)
+			 && in.mode == MODE_INDIRECT)
+				aot->computed = true;
+
+			if (is_return(&in)) {
+				aot->computed = true;
+				aot->has_rts |= in.emitter->gen == emit_rts;
+			}
+
+			if (in.emitter->ends)
+				break;
+
+			addr = in.next;
+		}
+	}
+
+	free(stack);
+
+	return 0;
+}
+
+/* ======= emission ======= */
+
+static void emit_block(struct aot_t* aot, uint16_t leader) {
+	struct aot_instr_t in;
+	uint16_t addr;
+	uint8_t page;
+
+	aot->cycles = 0;
+	aot->instrs = 0;
+	addr = leader;
+	page = get_page_num(leader);
+
+	emit(aot, "L%.4x:\n\tAOT_ENTER(0x%.4x);\n", leader, leader);
+
+	while (true) {
+		if (!decode(aot, addr, &in)) {
+			emit_count(aot);
+			emit(aot, "\tAOT_YIELD(0x%.4x);\n", addr);
+			break;
+		}
+
+		if (addr != leader && (mark(aot, addr) & AOT_LEADER)) {
+			emit_count(aot);
+			emit(aot, "\tgoto L%.4x;\n", addr);
+			break;
+		}
+
+		if (get_page_num(addr) != page) {
+			emit(aot, "\tAOT_CHECK_PAGE(0x%.4x, %u, %u);\n", addr,
+			     aot->cycles, aot->instrs);
+			page = get_page_num(addr);
+		}
+
+		emit(aot, "\t/* %.4x: %.3s */\n", addr, in.emitter->name);
+
+		aot->cycles += opdesc_cycles(in.op);
+		aot->instrs++;
+
+		in.emitter->gen(aot, &in);
+
+		if (in.emitter->ends)
+			break;
+
+		emit(aot, "\t%s(0x%.4x, %u, %u);\n",
+		     in.emitter->writes && in.mode != MODE_ACCUMULATOR
+		     ? "AOT_CHECK_STORE" : "AOT_CHECK",
+		     in.next, aot->cycles, aot->instrs);
+
+		addr = in.next;
+	}
+
+	emit(aot, "\n");
+
+	return;
+}
+
+static void emit_unit(struct aot_t* aot, const char* infile) {
+	unsigned int i;
+	uint16_t addr;
+
+	emit(aot, "/* generated by sikso2 --aot from %s, do not edit */\n\n"
+		  "#include \"aot.h\"\n\n"
+		  "static int aot_run(struct device_t* device, "
+		  "bool end_on_last_instr) {\n"
+		  "\tAOT_LOCALS;\n\n", infile);
+
+	if (aot->computed)
+		emit(aot, "aot_dispatch:\n");
+
+	emit(aot, "\tswitch (pc) {\n");
+
+	for (i = 0; i < aot->size; i++) {
+		addr = aot->load_addr + i;
+		if (aot->marks[i] & AOT_LEADER)
+			emit(aot, "\tcase 0x%.4x: goto L%.4x;\n", addr, addr);
+	}
+
+	emit(aot, "\tdefault: AOT_YIELD(pc);\n\t}\n\n");
+
+	for (i = 0; i < aot->size; i++)
+		if (aot->marks[i] & AOT_LEADER)
+			emit_block(aot, aot->load_addr + i);
+
+	/* where RTS lands: straight on the block its JSR predicted, or
+	 * through the dispatch */
+	if (aot->has_rts) {
+		emit(aot, "aot_return:\n\tswitch (AOT_RAS_POP(pc)) {\n");
+
+		for (i = 0; i < aot->num_returns; i++)
+			emit(aot, "\tcase %u: goto L%.4x;\n", i, aot->returns[i]);
+
+		emit(aot, "\tdefault: goto aot_dispatch;\n\t}\n\n");
+	}
+
+	emit(aot, "}\n\n"
+		  "const struct aot_image_t aot_image = {\n"
+		  "\t.load_addr = 0x%.4x,\n"
+		  "\t.size = %u,\n"
+		  "\t.hash = 0x%.8x,\n"
+		  "\t.model = 0x%x,\n"
+		  "\t.run = aot_run\n"
+		  "};\n", aot->load_addr, aot->size,
+		  aot_hash(aot->data, aot->size), aot->model);
+
+	return;
+}
+
+int aot_translate(const char* infile, const char* outfile,
+		  uint16_t load_addr, cpu_model_t model) {
+	struct aot_t aot;
+	uint8_t* data;
+	unsigned int size;
+	int ret;
+
+	ret = -1;
+	aot.marks = NULL;
+	aot.returns = NULL;
+	aot.f = NULL;
+
+	data = load_file(infile, &size);
+	if (!data)
+		return -1;
+
+	if (!size || load_addr + size > 0x10000) {
+		loga_err("%s does not fit at %.4x.", infile, load_addr);
+		goto exit_aot_translate;
+	}
+
+	aot.data = data;
+	aot.size = size;
+	aot.load_addr = load_addr;
+	aot.opdesc = get_model_opdesc_table(model);
+	aot.model = model;
+	aot.computed = false;
+	aot.has_rts = false;
+	aot.num_returns = 0;
+
+	aot.marks = calloc(size, sizeof(*aot.marks));
+	aot.returns = malloc(size * sizeof(*aot.returns));
+	if (!aot.marks || !aot.returns) {
+		loga_err("Could not allocate block marks.");
+		goto exit_aot_translate;
+	}
+
+	ret = find_blocks(&aot);
+	if (ret)
+		goto exit_aot_translate;
+
+	aot.f = fopen(outfile, "w");
+	if (!aot.f) {
+		loga_err("Could not open %s for output.", outfile);
+		ret = -1;
+		goto exit_aot_translate;
+	}
+
+	emit_unit(&aot, infile);
+
+	atracei("Translated %s to %s.", infile, outfile);
+
+exit_aot_translate:
+
+	if (aot.f)
+		fclose(aot.f);
+	free(aot.marks);
+	free(aot.returns);
+	free(data);
+
+	return ret;
+}
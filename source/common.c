@@ -6,23 +6,114 @@
 
 #include "device.h"
 
-void print_hex(const uint8_t* bin, unsigned int len, unsigned int offset) {
+#define HEX_ROW(h) \
+	h "0" h "1" h "2" h "3" h "4" h "5" h "6" h "7" \
+	h "8" h "9" h "a" h "b" h "c" h "d" h "e" h "f"
+
+/* two characters per byte, i.e. byte b is at hex_lut[2 * b] */
+static const char hex_lut[] =
+	HEX_ROW("0") HEX_ROW("1") HEX_ROW("2") HEX_ROW("3")
+	HEX_ROW("4") HEX_ROW("5") HEX_ROW("6") HEX_ROW("7")
+	HEX_ROW("8") HEX_ROW("9") HEX_ROW("a") HEX_ROW("b")
+	HEX_ROW("c") HEX_ROW("d") HEX_ROW("e") HEX_ROW("f");
+
+#define put_hex_byte(ptr, byte) do { \
+	memcpy((ptr), &(hex_lut[(unsigned int)(byte) << 1]), 2); \
+	(ptr) += 2; \
+} while (0)
+
+/* matches printf("%.4x", addr) */
+static unsigned int addr_digits(unsigned int addr) {
+	unsigned int digits;
+
+	digits = 4;
+
+	while (digits < 8 && (addr >> (digits * 4)))
+		digits++;
+
+	return digits;
+}
+
+static char* put_addr(char* ptr, unsigned int addr) {
+	unsigned int digits;
+
+	digits = addr_digits(addr);
+
+	while (digits--)
+		*(ptr++) = hex_lut[(((addr >> (digits * 4)) & 0xF) << 1) + 1];
+
+	return ptr;
+}
+
+unsigned int hex_dump_size(unsigned int len, unsigned int offset) {
+	unsigned int i, cols, rows, size;
+
+	cols = DEFAULT_DUMP_MEM_COLS;
+	rows = len / cols + (len % cols ? 1 : 0);
+
+	/* "xx" and a space or newline per byte */
+	size = len * 3;
+
+	/* "addr: " per row */
+	for (i = 0; i < rows; i++)
+		size += addr_digits(i * cols + offset) + 2;
+
+	return size;
+}
+
+unsigned int format_hex(char* out, const uint8_t* bin, unsigned int len,
+			unsigned int offset) {
 	unsigned int i, j, cols, rows, end;
+	char* ptr;
 
 	cols = DEFAULT_DUMP_MEM_COLS;
-	rows = len / cols;
+	rows = len / cols + (len % cols ? 1 : 0);
+	ptr = out;
 
-	for (i = 0; i < rows + (len % cols ? 1 : 0); i++) {
+	for (i = 0; i < rows; i++) {
 		end = (i + 1) * cols < len ? (i + 1) * cols : len;
 
-		printf("%.4x: ", i * cols + offset);
+		ptr = put_addr(ptr, i * cols + offset);
+		*(ptr++) = ':';
+		*(ptr++) = ' ';
 
-		for (j = i * cols; j < end; j++)
-			printf("%.2x%s", bin[j], j == end - 1 ? "" : " ");
+		for (j = i * cols; j < end; j++) {
+			put_hex_byte(ptr, bin[j]);
+			*(ptr++) = j == end - 1 ? '\n' : ' ';
+		}
+	}
+
+	return ptr - out;
+}
+
+unsigned int format_hex_str(char* out, const uint8_t* bin, unsigned int len) {
+	unsigned int i;
+	char* ptr;
+
+	ptr = out;
+
+	for (i = 0; i < len; i++)
+		put_hex_byte(ptr, bin[i]);
 
-		printf("\n");
+	return ptr - out;
+}
+
+void print_hex(const uint8_t* bin, unsigned int len, unsigned int offset) {
+	char* out;
+	unsigned int size;
+
+	out = malloc(hex_dump_size(len, offset));
+	if (!out) {
+		log_err("COM", "Could not allocate memory for hex dump.");
+		return;
 	}
 
+	size = format_hex(out, bin, len, offset);
+
+	fwrite(out, 1, size, stdout);
+
+	free(out);
+
 	return;
 }
 
@@ -30,11 +121,42 @@ void init_settings(settings_t* settings) {
 
 	settings->load_addr = -1;
 	settings->stack_addr = -1;
+	settings->ram_size = -1;
 	settings->end_on_final_instr = false;
+	settings->safeguard = -1;
 	settings->cpu_dump_mode = CPU_DUMP_NONE;
 	settings->mrhead = NULL;
+	settings->break_head = NULL;
+	settings->watch_head = NULL;
+	settings->rwatch_head = NULL;
+	settings->rom_head = NULL;
+	settings->mmio_head = NULL;
+	settings->unmapped_head = NULL;
+	settings->trap_rom_writes = false;
 	settings->mimage = NULL;
 	settings->mbhead = NULL;
+	settings->mapper = NULL;
+	settings->rom = NULL;
+	settings->rom_addr = 0;
+	settings->num_cpu_addrs = 0;
+	settings->slice = -1;
+	settings->slice_instrs = -1;
+	settings->cpu_threads = false;
+	settings->cpu_model = CPU_6502_NMOS;
+	settings->console_addr = -1;
+	settings->console_in = NULL;
+	settings->timer_addr = -1;
+	settings->dma_addr = -1;
+	settings->mem_raw_file = NULL;
+	settings->result_format = RESULT_FORMAT_TEXT;
+	settings->result_file = NULL;
+	settings->gdb_port = -1;
+	settings->gdb_socket = NULL;
+	settings->record_file = NULL;
+	settings->replay_file = NULL;
+	settings->checkpoint_interval = -1;
+	settings->seek_cycle = -1;
+	settings->profile_file = NULL;
 	settings->dmode = DISASM_SIMPLE;
 
 	return;
@@ -45,12 +167,36 @@ void free_settings(settings_t* settings) {
 	if (settings->mrhead)
 		free_mem_region_list(settings->mrhead);
 
+	if (settings->break_head)
+		free_mem_region_list(settings->break_head);
+
+	if (settings->watch_head)
+		free_mem_region_list(settings->watch_head);
+
+	if (settings->rwatch_head)
+		free_mem_region_list(settings->rwatch_head);
+
+	if (settings->rom_head)
+		free_mem_region_list(settings->rom_head);
+
+	if (settings->mmio_head)
+		free_mem_region_list(settings->mmio_head);
+
+	if (settings->unmapped_head)
+		free_mem_region_list(settings->unmapped_head);
+
 	if (settings->mimage)
 		free_mem_image(settings->mimage);
 
 	if (settings->mbhead)
 		free_mem_bytes(settings->mbhead);
 
+	if (settings->mapper)
+		free_mapper(settings->mapper);
+
+	if (settings->rom)
+		rom_close(settings->rom);
+
 	return;
 }
 
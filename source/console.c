@@ -0,0 +1,272 @@
+#include "console.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "peripheral.h"
+
+#define KSIG "CON"
+
+#define logk_err(FMT, ...) log_err(KSIG, FMT, ## __VA_ARGS__)
+
+#ifdef CONSOLE_TRACE
+#define ktracei(FMT, ...) tracei(KSIG, FMT, ## __VA_ARGS__)
+#else
+#define ktracei(FMT, ...) ;
+#endif
+
+/* what the thread sends back: a byte of input, or its end */
+#define CONSOLE_MSG_DATA 0
+#define CONSOLE_MSG_EOF 1
+
+#define CONSOLE_READ_SIZE 256
+
+/* ======= console thread ======= */
+
+static void console_flush(struct console_t* console) {
+	unsigned int done;
+	ssize_t ret;
+
+	for (done = 0; done < console->len; done += ret) {
+		ret = write(console->out_fd, console->buf + done,
+			    console->len - done);
+		if (ret < 0 && errno == EINTR)
+			ret = 0;
+		else if (ret < 0) {
+			logk_err("Could not write output (%s).",
+				 strerror(errno));
+			break;
+		}
+	}
+
+	console->len = 0;
+
+	return;
+}
+
+static void console_handle(struct peripheral_t* peripheral,
+			   const struct periph_msg_t* msg) {
+	struct console_t* console;
+
+	console = peripheral->data;
+
+	console->buf[console->len++] = msg->val;
+
+	if (console->len == CONSOLE_BUFFER_SIZE
+	 || (msg->val == '\n' && console->line_buffered))
+		console_flush(console);
+
+	return;
+}
+
+/* reads no more than the ring has room for, so the thread never waits
+ * on the CPU and output keeps flowing */
+static bool console_poll(struct peripheral_t* peripheral) {
+	struct console_t* console;
+	struct pollfd pfd;
+	uint8_t chunk[CONSOLE_READ_SIZE];
+	unsigned int room;
+	ssize_t len;
+	ssize_t i;
+
+	console = peripheral->data;
+
+	if (console->in_fd < 0)
+		return false;
+
+	room = PERIPH_QUEUE_SIZE
+	     - periph_queue_count(&peripheral->thread->from_thread);
+	if (room < 2)
+		return false;
+
+	pfd = (struct pollfd) { .fd = console->in_fd, .events = POLLIN };
+
+	if (poll(&pfd, 1, 0) <= 0)
+		return false;
+
+	len = read(console->in_fd, chunk,
+		   room - 1 < sizeof(chunk) ? room - 1 : sizeof(chunk));
+	if (len < 0 && (errno == EINTR || errno == EAGAIN))
+		return false;
+
+	if (len <= 0) {
+		periph_post(peripheral, &((struct periph_msg_t) {
+			.addr = CONSOLE_MSG_EOF
+		}));
+
+		if (console->in_fd != STDIN_FILENO)
+			close(console->in_fd);
+		console->in_fd = -1;
+
+		ktracei("End of input.");
+
+		return true;
+	}
+
+	/* input is there for the guest as soon as it is read */
+	for (i = 0; i < len; i++)
+		periph_post(peripheral, &((struct periph_msg_t) {
+			.addr = CONSOLE_MSG_DATA,
+			.val = chunk[i]
+		}));
+
+	return true;
+}
+
+static void console_stop(struct peripheral_t* peripheral) {
+
+	console_flush(peripheral->data);
+
+	return;
+}
+
+static const struct periph_thread_ops_t console_ops = {
+	.handle = console_handle,
+	.poll = console_poll,
+	.stop = console_stop
+};
+
+/* ======= CPU side ======= */
+
+/* input from a file is always there until it ends, so the CPU waits
+ * for the thread to read it rather than see none */
+static void console_fill(struct console_t* console) {
+	struct periph_msg_t msg;
+	unsigned int waits;
+
+	waits = 0;
+
+	while (!console->has_next && !console->eof) {
+		if (periph_receive(&console->peripheral, &msg)) {
+			if (msg.addr == CONSOLE_MSG_EOF)
+				console->eof = true;
+			else {
+				console->next = msg.val;
+				console->has_next = true;
+			}
+		}
+		else if (console->wait_for_input)
+			periph_wait(&waits);
+		else
+			break;
+	}
+
+	return;
+}
+
+static uint8_t console_read(struct peripheral_t* peripheral, uint16_t addr) {
+	struct console_t* console;
+
+	console = peripheral->data;
+
+	console_fill(console);
+
+	if (addr - peripheral->addr_start == CONSOLE_STATUS)
+		return (console->has_next ? CONSOLE_INPUT : 0)
+		     | (console->eof ? CONSOLE_EOF : 0);
+
+	if (!console->has_next)
+		return 0;
+
+	console->has_next = false;
+
+	return console->next;
+}
+
+static void console_write(struct peripheral_t* peripheral, uint16_t addr,
+			  uint8_t val) {
+
+	if (addr - peripheral->addr_start == CONSOLE_DATA)
+		periph_send(peripheral, addr, val, false);
+
+	return;
+}
+
+/* input from infile, or stdin for "-", or none; output to stdout */
+struct console_t* new_console(uint16_t addr, const char* infile) {
+	struct console_t* console;
+
+	if (addr > MEM_MAX_ADDR - (CONSOLE_REGS - 1)) {
+		logk_err("Console at %.4x does not fit in memory.", addr);
+		return NULL;
+	}
+
+	console = calloc(1, sizeof(*console));
+	if (!console) {
+		logk_err("Could not allocate console.");
+		return NULL;
+	}
+
+	console->buf = malloc(CONSOLE_BUFFER_SIZE);
+	if (!console->buf) {
+		logk_err("Could not allocate console buffer.");
+		free(console);
+		return NULL;
+	}
+
+	console->out_fd = STDOUT_FILENO;
+	console->line_buffered = isatty(STDOUT_FILENO);
+	console->in_fd = -1;
+	console->eof = !infile;
+
+	if (infile && !strcmp(infile, "-"))
+		console->in_fd = STDIN_FILENO;
+	else if (infile) {
+		console->in_fd = open(infile, O_RDONLY);
+		if (console->in_fd < 0) {
+			logk_err("Could not open %s.", infile);
+			goto exit_new_console;
+		}
+
+		console->wait_for_input = true;
+	}
+
+	console->peripheral = (struct peripheral_t) {
+		.addr_start = addr,
+		.addr_end = addr + CONSOLE_REGS - 1,
+		.read = console_read,
+		.write = console_write,
+		.data = console
+	};
+
+	/* whatever was printed before goes out first */
+	fflush(stdout);
+
+	if (periph_start(&console->peripheral, &console_ops))
+		goto exit_new_console;
+
+	ktracei("Console at %.4x.", addr);
+
+	return console;
+
+exit_new_console:
+
+	if (console->in_fd > STDIN_FILENO)
+		close(console->in_fd);
+
+	free(console->buf);
+	free(console);
+
+	return NULL;
+}
+
+/* flushes what is left */
+void free_console(struct console_t* console) {
+
+	periph_stop(&console->peripheral);
+
+	if (console->in_fd > STDIN_FILENO)
+		close(console->in_fd);
+
+	free(console->buf);
+	free(console);
+
+	return;
+}
@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "common.h"
+#include "device.h"
 
 #define CSIG "CPU"
 
@@ -14,17 +15,80 @@
 #define ctracei(FMT, ...) ;
 #endif
 
-DEFINE_INSTR_MAP(instr_map);
+static action_t actions[INSTR_MAP_SIZE];
+DEFINE_FUSE_MAP(fuse_map);
+
+/* stands in for instructions without an action and for undefined
+ * opcodes, so dispatch needs no check of its own */
+static int no_action(const opdesc_t* op, uint16_t arg,
+		     struct cpu_regs_t* regs, void* data) {
+
+	log_err(CSIG, "No action for opcode %.3s.", opdesc_name(op));
+
+	return DEVICE_NO_ACTION;
+}
+
+/* each model has a build of the actions of its own (see
+ * source/cpu6502-actions.c), so none of them checks which one runs */
+void init_cpu_6502_actions(void) {
+	instr_t* instr;
+
+	for_each_instr(instr)
+		instr->action = NULL;
+
+	switch (get_cpu_model()) {
+	case CPU_6502_UNDOC:
+		init_cpu_6502_actions_undoc();
+		break;
+	case CPU_6502_65C02:
+		init_cpu_6502_actions_65c02();
+		break;
+	default:
+		init_cpu_6502_actions_nmos();
+		break;
+	}
+
+	return;
+}
+
+static const struct {
+	cpu_model_t model;
+	const char* name;
+} cpu_models[] = {
+	{ CPU_6502_NMOS, "nmos" },
+	{ CPU_6502_UNDOC, "undoc" },
+	{ CPU_6502_65C02, "65c02" }
+};
+
+/* 0 for a model that does not exist */
+cpu_model_t parse_cpu_model(const char* arg) {
+	unsigned int i;
+
+	for (i = 0; i < sizeof(cpu_models) / sizeof(*cpu_models); i++)
+		if (!strcmp(cpu_models[i].name, arg))
+			return cpu_models[i].model;
+
+	return 0;
+}
 
 void init_cpu(struct cpu_6502_t* cpu, instr_t* instr_list) {
+	unsigned int i;
+
+	for (i = 0; i < INSTR_MAP_SIZE; i++)
+		actions[i] = i < get_instr_list_size() && instr_list[i].action
+			   ? instr_list[i].action : no_action;
 
-	populate_imap(instr_map);
+	cpu->opdesc = get_opdesc_table();
+	cpu->model = get_cpu_model();
+	cpu->actions = actions;
 
 #ifdef CPU_TRACE
-	print_imap(instr_map);
+	print_opdesc_table(cpu->opdesc);
 #endif
 
-	cpu->instr_map = instr_map;
+	populate_fmap(fuse_map, cpu->opdesc);
+
+	cpu->fuse_map = fuse_map;
 
 #ifdef CPU_TRACE
 	dump_cpu(cpu, CPU_DUMP_PRETTY);
@@ -33,14 +97,16 @@ void init_cpu(struct cpu_6502_t* cpu, instr_t* instr_list) {
 	return;
 }
 
+/* stack_addr is the address just above the stack, so the first push
+ * goes to the byte below it, e.g. 0x01FF for 0x0200 */
 void start_cpu(struct cpu_6502_t* cpu, uint16_t load_addr,
 	       uint16_t stack_addr) {
 
 	cpu->A = 0x0;
 	cpu->X = 0x0;
 	cpu->Y = 0x0;
-	cpu->S = stack_addr;
-	cpu->P = (uint8_t)1 << 5;
+	cpu->S = (uint8_t)(stack_addr - 1);
+	cpu->P = P_UNUSED;
 	cpu->PC = load_addr;
 
 	return;
@@ -112,7 +178,7 @@ static char* get_cpu_dump_usage(void) {
 
 	while (i < get_cpu_dump_data_size()) {
 		curr_len = strlen(cpu_dump_data[i].mode_string);
-		strncpy(curr, cpu_dump_data[i].mode_string, curr_len);
+		memcpy(curr, cpu_dump_data[i].mode_string, curr_len);
 		curr[curr_len] = i == (get_cpu_dump_data_size() - 1)
 				 ? ']' : '|';
 		curr += curr_len + 1;
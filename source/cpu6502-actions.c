@@ -6,6 +6,22 @@
 #include "instr.h"
 #include "cpu.h"
 #include "common.h"
+#include "alu.h"
+
+/* built once per CPU model, with CPU_MODEL set to its bit (see the
+ * Makefile), so what sets the models apart is decided here rather than
+ * on every instruction */
+#ifndef CPU_MODEL
+#error "CPU_MODEL is not set"
+#endif
+
+#if CPU_MODEL == CPU_6502_65C02
+#define init_model_actions init_cpu_6502_actions_65c02
+#elif CPU_MODEL == CPU_6502_UNDOC
+#define init_model_actions init_cpu_6502_actions_undoc
+#else
+#define init_model_actions init_cpu_6502_actions_nmos
+#endif
 
 #define ASIG "ACT"
 
@@ -14,87 +30,40 @@
 extern instr_t* get_instr_list(void);
 
 #define DEFINE_ACTION(NAME) \
-	static int NAME ## _action(subinstr_t* s, uint16_t arg, void* data)
+	static int NAME ## _action(const opdesc_t* op, uint16_t arg, \
+				   cpu_regs_t* regs, void* data)
 
 #define _device \
 	((struct device_t*)data)
 
+#define _cpu (regs)
+
 #define add_action(NAME) \
 	instr_named(#NAME)->action = NAME ## _action;
 
 #define _mode \
-	(s->mode & 0xFF)
-
-/* if return value is 0, set Z flag; set N flag
- * to match 7th bit of return value */
-#define affect_NZ(device, ret) \
-	if (ret == 0) set_Z((device)->cpu); \
-	if (ret & 0x80) set_N((device)->cpu); \
-	else clr_N((device)->cpu);
-
-#define get_sign(x) \
-	(((x) & ((uint8_t)1 << 7)) ? -1 : 1)
-
-#define get_abs(x) \
-	((x) & ~((uint8_t)1 << 7))
-
-#define get_signed(x) \
-	((int)get_sign(x) * (int)get_abs(x))
-
-#define assert_zero_page(device, addr) \
-	if (get_page(device, addr) != 0) { \
-		loga_err("Address %d not in zero page", \
-			 addr); \
-		return DEVICE_INTERNAL_BUG; \
-	}
-
-#define check_carry_adc(cpu, x, y) \
-	if ((int)x + (int)y > 255) set_C(cpu); \
-	else clr_C(cpu)
-
-#define check_carry_sbc(cpu, x, y) \
-	if ((int)x < (int)y) clr_C(cpu); \
-	else set_C(cpu)
-
-#define check_overflow_adc(cpu, x, y) \
-	if (get_sign(x) == get_sign(y) \
-	 && get_sign(x + y + get_C(cpu)) != get_sign(x)) \
-			set_V(cpu); \
-	else clr_V(cpu)
+	opdesc_mode(op)
 
-#define check_overflow_sbc(cpu, x, y) \
-	check_overflow_adc(cpu, x, 255-y)
-	/*if (get_sign(x) != get_sign(y) \
-	   && get_sign(x - y + get_C(cpu) - 1) != get_sign(x)) \
-			set_V(cpu); \
-	else clr_V(cpu)*/
+/* set Z flag if value is 0; set N flag
+ * to match 7th bit of value */
+#define affect_NZ(cpu, val) \
+	alu_set_NZ(cpu, val)
 
 #define get_page(addr) ((addr) & 0xFF00)
 
-#define zero_page_wrap_around(addr) ((addr) & 0xFF)
+#define is_page_boundary_crossed(base, addr) \
+	(get_page(base) != get_page(addr))
 
-#define is_page_boundary_crossed(addr) \
-	(get_page(addr) != get_page((addr) + 1))
+/* pointers in zero page wrap around within it */
+static uint16_t read_zp_ptr(struct device_t* device, uint8_t ptr) {
 
-static uint16_t get_indX(struct device_t* device,
-			 uint16_t addr) {
-	uint16_t wrapped;
-
-	wrapped = zero_page_wrap_around(addr + device->cpu->X);
-
-	return ((uint16_t)device_read(device, wrapped + 1) << 8) 
-	      | (uint16_t)device_read(device, wrapped);
-}
-
-static uint16_t get_indY(struct device_t* device, uint16_t addr) {
-
-	return (((uint16_t)device_read(device, addr + 1) << 8)
-	       | (uint16_t)device_read(device, addr))
-	       + (uint16_t)device->cpu->Y;
+	return ((uint16_t)device_read_zp(device, ptr + 1) << 8)
+	      | (uint16_t)device_read_zp(device, ptr);
 }
 
-static int get_addr(struct device_t* device, uint16_t addr,
-		    instr_mode_t mode, uint16_t* new_addr) {
+static int get_addr(struct device_t* device, cpu_regs_t* regs,
+		    uint16_t addr, instr_mode_t mode, uint16_t* new_addr) {
+	uint16_t base;
 	int ret;
 
 	ret = 0;
@@ -102,13 +71,15 @@ static int get_addr(struct device_t* device, uint16_t addr,
 	switch (mode) {
 
 	case MODE_ZERO_PAGE:
-		//assert_zero_page(device, addr);
-		*new_addr = addr;
+		*new_addr = (uint8_t)addr;
 		break;
 
 	case MODE_ZERO_PAGE_X:
-		//assert_zero_page(device, addr);
-		*new_addr = addr + device->cpu->X;
+		*new_addr = (uint8_t)(addr + regs->X);
+		break;
+
+	case MODE_ZERO_PAGE_Y:
+		*new_addr = (uint8_t)(addr + regs->Y);
 		break;
 
 	case MODE_ABSOLUTE:
@@ -116,34 +87,56 @@ static int get_addr(struct device_t* device, uint16_t addr,
 		break;
 
 	case MODE_ABSOLUTE_X:
-		*new_addr = addr + device->cpu->X;
-		ret = is_page_boundary_crossed(*new_addr) ? DEVICE_NEED_EXTRA_CYCLE : 0;
+		*new_addr = addr + regs->X;
+		ret = is_page_boundary_crossed(addr, *new_addr)
+		    ? DEVICE_NEED_EXTRA_CYCLE : 0;
 		break;
 
 	case MODE_ABSOLUTE_Y:
-		*new_addr = addr + device->cpu->Y;
-		ret = is_page_boundary_crossed(*new_addr) ? DEVICE_NEED_EXTRA_CYCLE : 0;
+		*new_addr = addr + regs->Y;
+		ret = is_page_boundary_crossed(addr, *new_addr)
+		    ? DEVICE_NEED_EXTRA_CYCLE : 0;
 		break;
 
 	case MODE_INDIRECT_X:
-		*new_addr = get_indX(device, addr);
+		*new_addr = read_zp_ptr(device, addr + regs->X);
 		break;
 
 	case MODE_INDIRECT_Y:
-		*new_addr = get_indY(device, addr);
-		ret = is_page_boundary_crossed(addr) ? DEVICE_NEED_EXTRA_CYCLE : 0;
+		base = read_zp_ptr(device, addr);
+		*new_addr = base + regs->Y;
+		ret = is_page_boundary_crossed(base, *new_addr)
+		    ? DEVICE_NEED_EXTRA_CYCLE : 0;
 		break;
+
+	default:
+		loga_err("Mode %d has no effective address", mode);
+		return DEVICE_INSTRUCTION_ERROR;
 	}
 
 	return ret;
 }
 
-static int get_byte(struct device_t* device, uint16_t addr,
-		     instr_mode_t mode, uint8_t* byte) {
+/* zero page operands skip the address calculation altogether */
+static int get_byte(struct device_t* device, cpu_regs_t* regs,
+		    uint16_t addr, instr_mode_t mode, uint8_t* byte) {
 	uint16_t new_addr;
 	int ret;
 
-	ret = get_addr(device, addr, mode, &new_addr);
+	switch (mode) {
+	case MODE_ZERO_PAGE:
+		*byte = device_read_zp(device, addr);
+		return 0;
+
+	case MODE_ZERO_PAGE_X:
+		*byte = device_read_zp(device, addr + regs->X);
+		return 0;
+
+	default:
+		break;
+	}
+
+	ret = get_addr(device, regs, addr, mode, &new_addr);
 	if (ret < 0)
 		return ret;
 
@@ -152,12 +145,25 @@ static int get_byte(struct device_t* device, uint16_t addr,
 	return ret;
 }
 
-static int write_byte(struct device_t* device, uint16_t addr,
-		      instr_mode_t mode, uint8_t byte) {
+static int write_byte(struct device_t* device, cpu_regs_t* regs,
+		      uint16_t addr, instr_mode_t mode, uint8_t byte) {
 	uint16_t new_addr;
 	int ret;
 
-	ret = get_addr(device, addr, mode, &new_addr);
+	switch (mode) {
+	case MODE_ZERO_PAGE:
+		device_write_zp(device, addr, byte);
+		return 0;
+
+	case MODE_ZERO_PAGE_X:
+		device_write_zp(device, addr + regs->X, byte);
+		return 0;
+
+	default:
+		break;
+	}
+
+	ret = get_addr(device, regs, addr, mode, &new_addr);
 	if (ret < 0)
 		return ret;
 
@@ -166,33 +172,47 @@ static int write_byte(struct device_t* device, uint16_t addr,
 	return ret;
 }
 
+#if CPU_MODEL == CPU_6502_65C02
+/* in decimal mode the 65C02 takes N and Z from the result and spends a
+ * cycle more on it */
+static void decimal_fixup(struct device_t* device, cpu_regs_t* regs) {
+
+	if (!get_D(regs))
+		return;
+
+	affect_NZ(regs, regs->A);
+	device->cycles++;
+
+	return;
+}
+#endif
+
+/* ADC and SBC honour the D flag through the ALU tables, so decimal
+ * mode costs the same as binary */
 DEFINE_ACTION(ADC) {
 	uint8_t byte;
 	int ret;
-	uint8_t c;
 
-	c = get_C(_device->cpu);
+	ret = 0;
 
 	switch (_mode) {
 	case MODE_IMMEDIATE:
-		check_overflow_adc(_device->cpu, _device->cpu->A, arg);
-		check_carry_adc(_device->cpu, _device->cpu->A, arg);
-		_device->cpu->A += (arg + c);
+		byte = arg;
 
 		break;
 	default:
-		ret = get_byte(_device, arg, _mode, &byte);
-		if (ret)
+		ret = get_byte(_device, _cpu, arg, _mode, &byte);
+		if (ret < 0)
 			return ret;
 
-		check_overflow_adc(_device->cpu, _device->cpu->A, byte);
-		check_carry_adc(_device->cpu, _device->cpu->A, byte);
-		_device->cpu->A += (byte + c);
-
 		break;
 	}
 
-	affect_NZ(_device, _device->cpu->A)
+	alu_adc(_cpu, byte);
+
+#if CPU_MODEL == CPU_6502_65C02
+	decimal_fixup(_device, _cpu);
+#endif
 
 	return ret;
 }
@@ -203,7 +223,8 @@ typedef enum {
 	BITWISE_ORA
 } bitwise_t;
 
-static int bitwise_comm(subinstr_t* s, uint16_t arg, void* data, bitwise_t comm) {
+static int bitwise_comm(const opdesc_t* op, uint16_t arg, cpu_regs_t* regs,
+			void* data, bitwise_t comm) {
 	uint8_t byte;
 	int ret;
 
@@ -214,15 +235,15 @@ static int bitwise_comm(subinstr_t* s, uint16_t arg, void* data, bitwise_t comm)
 	case MODE_IMMEDIATE:
 		switch (comm) {
 		case BITWISE_AND:
-			_device->cpu->A &= arg;
+			_cpu->A &= arg;
 			break;
 
 		case BITWISE_EOR:
-			_device->cpu->A ^= arg;
+			_cpu->A ^= arg;
 			break;
 
 		case BITWISE_ORA:
-			_device->cpu->A |= arg;
+			_cpu->A |= arg;
 			break;
 		default:
 			return ret;
@@ -231,21 +252,21 @@ static int bitwise_comm(subinstr_t* s, uint16_t arg, void* data, bitwise_t comm)
 		break;
 
 	default:
-		ret = get_byte(_device, arg, _mode, &byte);
-		if (ret)
+		ret = get_byte(_device, _cpu, arg, _mode, &byte);
+		if (ret < 0)
 			return ret;
 
 		switch (comm) {
 		case BITWISE_AND:
-			_device->cpu->A &= byte;
+			_cpu->A &= byte;
 			break;
 
 		case BITWISE_EOR:
-			_device->cpu->A ^= byte;
+			_cpu->A ^= byte;
 			break;
 
 		case BITWISE_ORA:
-			_device->cpu->A |= byte;
+			_cpu->A |= byte;
 			break;
 		default:
 			return ret;
@@ -254,7 +275,7 @@ static int bitwise_comm(subinstr_t* s, uint16_t arg, void* data, bitwise_t comm)
 		break;
 	}
 
-	affect_NZ(_device, _device->cpu->A);
+	affect_NZ(_cpu, _cpu->A);
 
 	return ret;
 
@@ -262,7 +283,7 @@ static int bitwise_comm(subinstr_t* s, uint16_t arg, void* data, bitwise_t comm)
 
 DEFINE_ACTION(AND) {
 
-	return bitwise_comm(s, arg, data, BITWISE_AND);
+	return bitwise_comm(op, arg, regs, data, BITWISE_AND);
 }
 
 typedef enum {
@@ -272,12 +293,13 @@ typedef enum {
 	BIT_SHIFT_ROR
 } bit_shift_t;
 
-static void shift(struct device_t* device, bit_shift_t shift_type,
+/* the bit shifted out goes to C; only rotates shift the old C in */
+static void shift(cpu_regs_t* regs, bit_shift_t shift_type,
 		  uint8_t* byte) {
 	bool carry;
 	bool precarry;
 
-	precarry = get_C(device->cpu) != 0;
+	precarry = get_C(regs) != 0;
 
 	carry = shift_type == BIT_SHIFT_ASL
 	     || shift_type == BIT_SHIFT_ROL
@@ -289,24 +311,20 @@ static void shift(struct device_t* device, bit_shift_t shift_type,
 	      : *byte >> 1;
 
 	if (carry)
-		set_C(device->cpu);
-
-	if (precarry)
-		*byte = shift_type == BIT_SHIFT_ASL
-		     || shift_type == BIT_SHIFT_ROL
-		      ? *byte | 1
-		      : *byte | ((uint8_t)1 << 7);
+		set_C(regs);
 	else
-		*byte = shift_type == BIT_SHIFT_ASL
-		     || shift_type == BIT_SHIFT_ROL
-		      ? *byte & ~((uint8_t)1)
-		      : *byte & ~((uint8_t)1 << 7);
+		clr_C(regs);
+
+	if (precarry && shift_type == BIT_SHIFT_ROL)
+		*byte |= 1;
+	else if (precarry && shift_type == BIT_SHIFT_ROR)
+		*byte |= (uint8_t)1 << 7;
 
 	return;
 }
 
-static int shift_comm(subinstr_t* s, uint16_t arg, void* data,
-		      bit_shift_t shift_type) {
+static int shift_comm(const opdesc_t* op, uint16_t arg, cpu_regs_t* regs,
+		      void* data, bit_shift_t shift_type) {
 	uint8_t byte;
 	int ret;
 
@@ -315,23 +333,23 @@ static int shift_comm(subinstr_t* s, uint16_t arg, void* data,
 	switch (_mode) {
 
 	case MODE_ACCUMULATOR:
-		shift(_device, shift_type, &(_device->cpu->A));
-		affect_NZ(_device, _device->cpu->A);
+		shift(_cpu, shift_type, &(_cpu->A));
+		affect_NZ(_cpu, _cpu->A);
 
 		break;
 
 	default:
-		ret = get_byte(_device, arg, _mode, &byte);
-		if (ret)
+		ret = get_byte(_device, _cpu, arg, _mode, &byte);
+		if (ret < 0)
 			return ret;
 
-		shift(_device, shift_type, &byte);
+		shift(_cpu, shift_type, &byte);
 
-		ret = write_byte(_device, arg, _mode, byte);
-		if (ret)
+		ret = write_byte(_device, _cpu, arg, _mode, byte);
+		if (ret < 0)
 			return ret;
 
-		affect_NZ(_device, byte);
+		affect_NZ(_cpu, byte);
 
 		break;
 	}
@@ -341,7 +359,7 @@ static int shift_comm(subinstr_t* s, uint16_t arg, void* data,
 
 DEFINE_ACTION(ASL) {
 
-	return shift_comm(s, arg, data, BIT_SHIFT_ASL);
+	return shift_comm(op, arg, regs, data, BIT_SHIFT_ASL);
 }
 
 DEFINE_ACTION(BIT) {
@@ -350,168 +368,165 @@ DEFINE_ACTION(BIT) {
 
 	ret = 0;
 
-	ret = get_byte(_device, arg, _mode, &byte);
-	if (ret)
+#if CPU_MODEL == CPU_6502_65C02
+	/* an immediate operand only sets Z */
+	if (_mode == MODE_IMMEDIATE) {
+		if (arg & _cpu->A)
+			clr_Z(_cpu);
+		else
+			set_Z(_cpu);
+
+		return 0;
+	}
+#endif
+
+	ret = get_byte(_device, _cpu, arg, _mode, &byte);
+	if (ret < 0)
 		return ret;
 
-	if (byte & _device->cpu->A)
-		clr_Z(_device->cpu);
+	if (byte & _cpu->A)
+		clr_Z(_cpu);
 	else
-		set_Z(_device->cpu);
+		set_Z(_cpu);
 
 	if (byte & ((uint8_t)1 << 7))
-		set_N(_device->cpu);
+		set_N(_cpu);
 	else
-		clr_N(_device->cpu);
+		clr_N(_cpu);
 
 	if (byte & ((uint8_t)1 << 6))
-		set_V(_device->cpu);
+		set_V(_cpu);
 	else
-		clr_N(_device->cpu);
+		clr_V(_cpu);
 
 	return ret;
 }
 
-DEFINE_ACTION(BRK) {
-
-	_device->cpu->PC++;
-
-	set_B(_device->cpu);
-
-	return DEVICE_GENERATE_NMI;
-}
-
-static int sbc_comm(subinstr_t* s, uint16_t arg, void* data,
-		    bool cmp_only, uint8_t* reg) {
+static int sbc_comm(const opdesc_t* op, uint16_t arg, cpu_regs_t* regs,
+		    void* data, bool cmp_only, uint8_t* reg) {
 	uint8_t byte;
 	int ret;
-	uint8_t c;
 
-	c = get_C(_device->cpu);
+	ret = 0;
 
 	switch (_mode) {
 	case MODE_IMMEDIATE:
-		if (!cmp_only) {
-			check_overflow_sbc(_device->cpu, *reg, arg);
-		}
-
-		check_carry_sbc(_device->cpu, *reg, arg);
-
-		if (!cmp_only) {
-			*reg -= (arg - c + 1);
-		}
+		byte = arg;
 
 		break;
 	default:
-		ret = get_byte(_device, arg, _mode, &byte);
-		if (ret)
+		ret = get_byte(_device, _cpu, arg, _mode, &byte);
+		if (ret < 0)
 			return ret;
 
-
-		if (!cmp_only) {
-			check_overflow_sbc(_device->cpu, *reg, byte);
-		}
-		check_carry_sbc(_device->cpu, *reg, byte);
-		if (!cmp_only) {
-			*reg -= (byte + c - 1);
-		}
-
 		break;
 	}
 
-	affect_NZ(_device, _device->cpu->A)
+	if (cmp_only)
+		alu_cmp(_cpu, *reg, byte);
+	else {
+		alu_sbc(_cpu, byte);
+#if CPU_MODEL == CPU_6502_65C02
+		decimal_fixup(_device, _cpu);
+#endif
+	}
 
 	return ret;
-
-
 }
 
 DEFINE_ACTION(CMP) {
 
-	return sbc_comm(s, arg, data, true, &(_device->cpu->A));
+	return sbc_comm(op, arg, regs, data, true, &(_cpu->A));
 }
 
 DEFINE_ACTION(CPX) {
 
-	return sbc_comm(s, arg, data, true, &(_device->cpu->X));
+	return sbc_comm(op, arg, regs, data, true, &(_cpu->X));
 }
 
 DEFINE_ACTION(CPY) {
 
-	return sbc_comm(s, arg, data, true, &(_device->cpu->Y));
+	return sbc_comm(op, arg, regs, data, true, &(_cpu->Y));
 }
 
 DEFINE_ACTION(DEC) {
 	uint8_t byte;
 	int ret;
 
-	ret = get_byte(_device, arg, _mode, &byte);
-	if (ret)
-		return ret;
+#if CPU_MODEL == CPU_6502_65C02
+	if (_mode == MODE_ACCUMULATOR) {
+		_cpu->A--;
+		affect_NZ(_cpu, _cpu->A);
 
-	check_carry_sbc(_device->cpu, byte, 1);
+		return 0;
+	}
+#endif
+
+	ret = get_byte(_device, _cpu, arg, _mode, &byte);
+	if (ret < 0)
+		return ret;
 
 	byte--;
 
-	ret = write_byte(_device, arg, _mode, byte);
-	if (ret)
+	ret = write_byte(_device, _cpu, arg, _mode, byte);
+	if (ret < 0)
 		return ret;
 
-	affect_NZ(_device, byte);
+	affect_NZ(_cpu, byte);
 
 	return ret;
 }
 
 DEFINE_ACTION(EOR) {
 
-	return bitwise_comm(s, arg, data, BITWISE_EOR);
+	return bitwise_comm(op, arg, regs, data, BITWISE_EOR);
 }
 
 DEFINE_ACTION(CLC) {
 
-	clr_C(_device->cpu);
+	clr_C(_cpu);
 
 	return 0;
 }
 
 DEFINE_ACTION(SEC) {
 
-	set_C(_device->cpu);
+	set_C(_cpu);
 
 	return 0;
 }
 
 DEFINE_ACTION(CLI) {
 
-	clr_I(_device->cpu);
+	clr_I(_cpu);
 
 	return 0;
 }
 
 DEFINE_ACTION(SEI) {
 
-	set_I(_device->cpu);
+	set_I(_cpu);
 
 	return 0;
 }
 
 DEFINE_ACTION(CLV) {
 
-	clr_V(_device->cpu);
+	clr_V(_cpu);
 
 	return 0;
 }
 
 DEFINE_ACTION(CLD) {
 
-	clr_D(_device->cpu);
+	clr_D(_cpu);
 
 	return 0;
 }
 
 DEFINE_ACTION(SED) {
 
-	set_D(_device->cpu);
+	set_D(_cpu);
 
 	return 0;
 }
@@ -520,76 +535,461 @@ DEFINE_ACTION(LDA) {
 	uint8_t byte;
 	int ret;
 
+	ret = 0;
+
 	switch (_mode) {
 
 	case MODE_IMMEDIATE:
-		_device->cpu->A = arg;
+		_cpu->A = arg;
 		byte = arg;
 
 		break;
 	default:
-		ret = get_byte(_device, arg, _mode, &byte);
-		if (ret)
+		ret = get_byte(_device, _cpu, arg, _mode, &byte);
+		if (ret < 0)
 			return ret;
 
-		_device->cpu->A = byte;
+		_cpu->A = byte;
 
 		break;
 	}
 
-	affect_NZ(_device, byte);
+	affect_NZ(_cpu, byte);
 
 	return ret;
 }
 
 DEFINE_ACTION(JMP) {
-	uint8_t high_byte;
-	uint8_t low_byte;
 	int ret;
 
 	ret = 0;
 
 	switch (_mode) {
 	case MODE_ABSOLUTE:
-		_device->cpu->PC = arg;
+		/* a jump back may close an idle loop */
+		if (arg < _cpu->PC)
+			ret = DEVICE_JUMP_BACK;
+
+		_cpu->PC = arg;
 		break;
 
+#if CPU_MODEL == CPU_6502_65C02
+	/* the 65C02 carries into the high byte of the pointer */
 	case MODE_INDIRECT:
-		ret = get_byte(_device, arg, _mode, &low_byte);
-		if (ret)
-			return ret;
-
-		ret = get_byte(_device,
-			zero_page_wrap_around(arg + 1),
-			_mode, &high_byte);
-		if (ret)
-			return ret;
-
-		_device->cpu->PC = ((uint16_t)high_byte << 8);
-		_device->cpu->PC |= (uint16_t)low_byte;
-
+		_cpu->PC = ((uint16_t)device_read(_device,
+				(uint16_t)(arg + 1)) << 8)
+			 | (uint16_t)device_read(_device, arg);
+		break;
+#else
+	/* the pointer does not carry into its high byte */
+	case MODE_INDIRECT:
+		_cpu->PC = ((uint16_t)device_read(_device,
+				get_page(arg) | (uint8_t)(arg + 1)) << 8)
+			 | (uint16_t)device_read(_device, arg);
 		break;
+#endif
 
 	}
 
 	return ret;
 }
 
+/* ======= stack =======
+ *
+ * the stack is always page 1, which is always RAM, so pushes and pulls
+ * index the page directly unless it has to go the slow way (see
+ * device_push); addresses go on it high byte first */
+
+static void push_addr(struct device_t* device, cpu_regs_t* regs,
+		      uint16_t addr) {
+
+	device_push(device, regs->S, (uint8_t)(addr >> 8));
+	device_push(device, regs->S, (uint8_t)addr);
+
+	return;
+}
+
+static uint16_t pull_addr(struct device_t* device, cpu_regs_t* regs) {
+	uint16_t addr;
+
+	addr = device_pull(device, regs->S);
+	addr |= (uint16_t)device_pull(device, regs->S) << 8;
+
+	return addr;
+}
+
+/* pushes the address of its own last byte, which RTS steps past */
+DEFINE_ACTION(JSR) {
+
+	push_addr(_device, _cpu, _cpu->PC - 1);
+
+	_cpu->PC = arg;
+
+	return 0;
+}
+
+DEFINE_ACTION(RTS) {
+
+	_cpu->PC = pull_addr(_device, _cpu) + 1;
+
+	return 0;
+}
+
+DEFINE_ACTION(RTI) {
+
+	_cpu->P = p_pulled(device_pull(_device, _cpu->S));
+	_cpu->PC = pull_addr(_device, _cpu);
+
+	return 0;
+}
+
+/* taken like an IRQ (see take_irq), but P goes on the stack with B set,
+ * and the address pushed skips the byte after BRK */
+DEFINE_ACTION(BRK) {
+
+	push_addr(_device, _cpu, _cpu->PC + 1);
+	device_push(_device, _cpu->S, p_pushed(_cpu->P, true));
+
+	set_I(_cpu);
+
+	_cpu->PC = device_read(_device, IRQ_VECTOR)
+		 | (uint16_t)device_read(_device, IRQ_VECTOR + 1) << 8;
+
+	return 0;
+}
+
+DEFINE_ACTION(PHA) {
+
+	device_push(_device, _cpu->S, _cpu->A);
+
+	return 0;
+}
+
+DEFINE_ACTION(PHP) {
+
+	device_push(_device, _cpu->S, p_pushed(_cpu->P, true));
+
+	return 0;
+}
+
+DEFINE_ACTION(PLA) {
+
+	_cpu->A = device_pull(_device, _cpu->S);
+	affect_NZ(_cpu, _cpu->A);
+
+	return 0;
+}
+
+DEFINE_ACTION(PLP) {
+
+	_cpu->P = p_pulled(device_pull(_device, _cpu->S));
+
+	return 0;
+}
+
+DEFINE_ACTION(TSX) {
+
+	_cpu->X = _cpu->S;
+	affect_NZ(_cpu, _cpu->X);
+
+	return 0;
+}
+
+DEFINE_ACTION(TXS) {
+
+	_cpu->S = _cpu->X;
+
+	return 0;
+}
+
+/* ======= registers ======= */
+
+static int load_reg(cpu_regs_t* regs, uint8_t* reg, uint8_t value) {
+
+	*reg = value;
+	affect_NZ(regs, value);
+
+	return 0;
+}
+
+DEFINE_ACTION(TAX) {
+
+	return load_reg(_cpu, &(_cpu->X), _cpu->A);
+}
+
+DEFINE_ACTION(TXA) {
+
+	return load_reg(_cpu, &(_cpu->A), _cpu->X);
+}
+
+DEFINE_ACTION(TAY) {
+
+	return load_reg(_cpu, &(_cpu->Y), _cpu->A);
+}
+
+DEFINE_ACTION(TYA) {
+
+	return load_reg(_cpu, &(_cpu->A), _cpu->Y);
+}
+
+DEFINE_ACTION(DEX) {
+
+	return load_reg(_cpu, &(_cpu->X), _cpu->X - 1);
+}
+
+DEFINE_ACTION(INX) {
+
+	return load_reg(_cpu, &(_cpu->X), _cpu->X + 1);
+}
+
+DEFINE_ACTION(DEY) {
+
+	return load_reg(_cpu, &(_cpu->Y), _cpu->Y - 1);
+}
+
+DEFINE_ACTION(INY) {
+
+	return load_reg(_cpu, &(_cpu->Y), _cpu->Y + 1);
+}
+
+/* ======= branches =======
+ *
+ * a branch taken says so, and the run loop charges the cycle it takes
+ * and the one for crossing a page (see exec_instr) */
+
+static int branch(cpu_regs_t* regs, bool cond, uint16_t arg) {
+
+	if (!cond)
+		return 0;
+
+	regs->PC += (int8_t)arg;
+
+	return DEVICE_TAKE_BRANCH;
+}
+
+DEFINE_ACTION(BPL) {
+
+	return branch(_cpu, !get_N(_cpu), arg);
+}
+
+DEFINE_ACTION(BMI) {
+
+	return branch(_cpu, get_N(_cpu), arg);
+}
+
+DEFINE_ACTION(BVC) {
+
+	return branch(_cpu, !get_V(_cpu), arg);
+}
+
+DEFINE_ACTION(BVS) {
+
+	return branch(_cpu, get_V(_cpu), arg);
+}
+
+DEFINE_ACTION(BCC) {
+
+	return branch(_cpu, !get_C(_cpu), arg);
+}
+
+DEFINE_ACTION(BCS) {
+
+	return branch(_cpu, get_C(_cpu), arg);
+}
+
+DEFINE_ACTION(BNE) {
+
+	return branch(_cpu, !get_Z(_cpu), arg);
+}
+
+DEFINE_ACTION(BEQ) {
+
+	return branch(_cpu, get_Z(_cpu), arg);
+}
+
+#if CPU_MODEL == CPU_6502_UNDOC
+/* the undocumented ones with an operand still read it */
+DEFINE_ACTION(NOP) {
+	uint8_t byte;
+
+	if (_mode == MODE_IMPLIED || _mode == MODE_IMMEDIATE)
+		return 0;
+
+	return get_byte(_device, _cpu, arg, _mode, &byte);
+}
+#else
 DEFINE_ACTION(NOP) {
 
 	return 0;
 }
+#endif
 
 DEFINE_ACTION(SBC) {
 
-	return sbc_comm(s, arg, data, false, &(_device->cpu->A));
+	return sbc_comm(op, arg, regs, data, false, &(_cpu->A));
 }
 
 DEFINE_ACTION(STA) {
 
-	return write_byte(_device, arg, _mode, _device->cpu->A);
+	return write_byte(_device, _cpu, arg, _mode, _cpu->A);
 }
 
+#if CPU_MODEL == CPU_6502_UNDOC
+/* ======= undocumented NMOS opcodes ======= */
+
+DEFINE_ACTION(LAX) {
+	uint8_t byte;
+	int ret;
+
+	ret = get_byte(_device, _cpu, arg, _mode, &byte);
+	if (ret < 0)
+		return ret;
+
+	_cpu->A = byte;
+	_cpu->X = byte;
+	affect_NZ(_cpu, byte);
+
+	return ret;
+}
+
+DEFINE_ACTION(SAX) {
+
+	return write_byte(_device, _cpu, arg, _mode, _cpu->A & _cpu->X);
+}
+
+/* read-modify-write, then the operation on the new value; the page
+ * crossing is paid for in the base cycles */
+static int rmw_comm(const opdesc_t* op, uint16_t arg, cpu_regs_t* regs,
+		    void* data, int8_t delta, uint8_t* byte) {
+	int ret;
+
+	ret = get_byte(_device, _cpu, arg, _mode, byte);
+	if (ret < 0)
+		return ret;
+
+	*byte += delta;
+
+	ret = write_byte(_device, _cpu, arg, _mode, *byte);
+
+	return ret < 0 ? ret : 0;
+}
+
+DEFINE_ACTION(DCP) {
+	uint8_t byte;
+	int ret;
+
+	ret = rmw_comm(op, arg, regs, data, -1, &byte);
+	if (ret < 0)
+		return ret;
+
+	alu_cmp(_cpu, _cpu->A, byte);
+
+	return 0;
+}
+
+DEFINE_ACTION(ISC) {
+	uint8_t byte;
+	int ret;
+
+	ret = rmw_comm(op, arg, regs, data, 1, &byte);
+	if (ret < 0)
+		return ret;
+
+	alu_sbc(_cpu, byte);
+
+	return 0;
+}
+#endif
+
+#if CPU_MODEL == CPU_6502_65C02
+/* ======= 65C02 ======= */
+
+DEFINE_ACTION(BRA) {
+
+	return branch(_cpu, true, arg);
+}
+
+DEFINE_ACTION(STZ) {
+
+	return write_byte(_device, _cpu, arg, _mode, 0);
+}
+
+DEFINE_ACTION(PHX) {
+
+	device_push(_device, _cpu->S, _cpu->X);
+
+	return 0;
+}
+
+DEFINE_ACTION(PHY) {
+
+	device_push(_device, _cpu->S, _cpu->Y);
+
+	return 0;
+}
+
+DEFINE_ACTION(PLX) {
+
+	_cpu->X = device_pull(_device, _cpu->S);
+	affect_NZ(_cpu, _cpu->X);
+
+	return 0;
+}
+
+DEFINE_ACTION(PLY) {
+
+	_cpu->Y = device_pull(_device, _cpu->S);
+	affect_NZ(_cpu, _cpu->Y);
+
+	return 0;
+}
+
+/* Z is set as BIT would, then the bits of A are set in (TSB) or
+ * cleared from (TRB) memory */
+static int test_bits(const opdesc_t* op, uint16_t arg, cpu_regs_t* regs,
+		     void* data, bool set) {
+	uint8_t byte;
+	int ret;
+
+	ret = get_byte(_device, _cpu, arg, _mode, &byte);
+	if (ret < 0)
+		return ret;
+
+	if (byte & _cpu->A)
+		clr_Z(_cpu);
+	else
+		set_Z(_cpu);
+
+	byte = set ? byte | _cpu->A : byte & ~_cpu->A;
+
+	return write_byte(_device, _cpu, arg, _mode, byte);
+}
+
+DEFINE_ACTION(TSB) {
+
+	return test_bits(op, arg, regs, data, true);
+}
+
+DEFINE_ACTION(TRB) {
+
+	return test_bits(op, arg, regs, data, false);
+}
+#endif
+
+/* ======= fused instructions =======
+ *
+ * one handler per sequence in scripts/fused.txt, calling the actions
+ * above directly; the instructions before the last touch no memory and
+ * do not branch (genops.py checks it), so only what the last one
+ * returns matters */
+
+#define DEFINE_FUSED(NAME) \
+	static int NAME ## _fused(const opdesc_t* const* ops, \
+				  const uint16_t* args, cpu_regs_t* regs, \
+				  void* data)
+
+#include "cpu6502-fused.h"
+
 static instr_t* instr_named(char name[3]) {
 	instr_t* i;
 
@@ -600,12 +1000,23 @@ static instr_t* instr_named(char name[3]) {
 	return NULL;
 }
 
-void init_cpu_6502_actions(void) {
+void init_model_actions(void) {
+	size_t i;
+
+	init_alu();
 
 	add_action(ADC);
 	add_action(AND);
 	add_action(ASL);
 	add_action(BIT);
+	add_action(BPL);
+	add_action(BMI);
+	add_action(BVC);
+	add_action(BVS);
+	add_action(BCC);
+	add_action(BCS);
+	add_action(BNE);
+	add_action(BEQ);
 	add_action(BRK);
 	add_action(CMP);
 	add_action(CPX);
@@ -620,10 +1031,48 @@ void init_cpu_6502_actions(void) {
 	add_action(CLD);
 	add_action(SED);
 	add_action(JMP);
+	add_action(JSR);
+	add_action(RTS);
+	add_action(RTI);
+	add_action(PHA);
+	add_action(PHP);
+	add_action(PLA);
+	add_action(PLP);
+	add_action(TSX);
+	add_action(TXS);
+	add_action(TAX);
+	add_action(TXA);
+	add_action(TAY);
+	add_action(TYA);
+	add_action(DEX);
+	add_action(INX);
+	add_action(DEY);
+	add_action(INY);
 	add_action(LDA);
 	add_action(NOP);
 	add_action(SBC);
 	add_action(STA);
 
+#if CPU_MODEL == CPU_6502_UNDOC
+	add_action(LAX);
+	add_action(SAX);
+	add_action(DCP);
+	add_action(ISC);
+#endif
+
+#if CPU_MODEL == CPU_6502_65C02
+	add_action(BRA);
+	add_action(STZ);
+	add_action(PHX);
+	add_action(PHY);
+	add_action(PLX);
+	add_action(PLY);
+	add_action(TSB);
+	add_action(TRB);
+#endif
+
+	for (i = 0; i < get_fused_list_size(); i++)
+		get_fused_list()[i].action = fused_actions[i];
+
 	return;
 }
@@ -3,1566 +3,277 @@
 #include "cpu.h"
 #include "instr.h"
 
-subinstr_t adc_list[] = {
-	(subinstr_t) {
-		.opcode = 0x69,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x65,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x75,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x6d,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x7d,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x79,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x61,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_INDIRECT_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x71,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_INDIRECT_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t and_list[] = {
-	(subinstr_t) {
-		.opcode = 0x29,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x25,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x35,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x2d,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x3d,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x39,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x21,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_INDIRECT_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x31,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_INDIRECT_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t asl_list[] = {
-	(subinstr_t) {
-		.opcode = 0xa,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_ACCUMULATOR,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x6,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x16,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xe,
-		.cycles = 6,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x1e,
-		.cycles = 7,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t bit_list[] = {
-	(subinstr_t) {
-		.opcode = 0x24,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x2c,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t bpl_single[] = {
-	(subinstr_t) {
-		.opcode = 0x10,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_BRANCH | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t bmi_single[] = {
-	(subinstr_t) {
-		.opcode = 0x30,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_BRANCH | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t bvc_single[] = {
-	(subinstr_t) {
-		.opcode = 0x50,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_BRANCH | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t bvs_single[] = {
-	(subinstr_t) {
-		.opcode = 0x70,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_BRANCH | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t bcc_single[] = {
-	(subinstr_t) {
-		.opcode = 0x90,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_BRANCH | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t bcs_single[] = {
-	(subinstr_t) {
-		.opcode = 0xb0,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_BRANCH | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t bne_single[] = {
-	(subinstr_t) {
-		.opcode = 0xd0,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_BRANCH | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t beq_single[] = {
-	(subinstr_t) {
-		.opcode = 0xf0,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_BRANCH | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t brk_single[] = {
-	(subinstr_t) {
-		.opcode = 0x0,
-		.cycles = 7,
-		.length = 1,
-		.mode = MODE_IMPLIED,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t cmp_list[] = {
-	(subinstr_t) {
-		.opcode = 0xc9,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xc5,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xd5,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xcd,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xdd,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xd9,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xc1,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_INDIRECT_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xd1,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_INDIRECT_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t cpx_list[] = {
-	(subinstr_t) {
-		.opcode = 0xe0,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xe4,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xec,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t cpy_list[] = {
-	(subinstr_t) {
-		.opcode = 0xc0,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xc4,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xcc,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t dec_list[] = {
-	(subinstr_t) {
-		.opcode = 0xc6,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xd6,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xce,
-		.cycles = 6,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xde,
-		.cycles = 7,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t eor_list[] = {
-	(subinstr_t) {
-		.opcode = 0x49,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x45,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x55,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x4d,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x5d,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x59,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x41,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_INDIRECT_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x51,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_INDIRECT_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t clc_single[] = {
-	(subinstr_t) {
-		.opcode = 0x18,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_STATUS,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t sec_single[] = {
-	(subinstr_t) {
-		.opcode = 0x38,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_STATUS,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t cli_single[] = {
-	(subinstr_t) {
-		.opcode = 0x58,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_STATUS,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t sei_single[] = {
-	(subinstr_t) {
-		.opcode = 0x78,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_STATUS,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t clv_single[] = {
-	(subinstr_t) {
-		.opcode = 0xb8,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_STATUS,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t cld_single[] = {
-	(subinstr_t) {
-		.opcode = 0xd8,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_STATUS,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t sed_single[] = {
-	(subinstr_t) {
-		.opcode = 0xf8,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_STATUS,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t inc_list[] = {
-	(subinstr_t) {
-		.opcode = 0xe6,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xf6,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xee,
-		.cycles = 6,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xfe,
-		.cycles = 7,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t jmp_list[] = {
-	(subinstr_t) {
-		.opcode = 0x4c,
-		.cycles = 3,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x6c,
-		.cycles = 5,
-		.length = 3,
-		.mode = MODE_INDIRECT,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t jsr_single[] = {
-	(subinstr_t) {
-		.opcode = 0x20,
-		.cycles = 6,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t lda_list[] = {
-	(subinstr_t) {
-		.opcode = 0xa9,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xa5,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xb5,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xad,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xbd,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xb9,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xa1,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_INDIRECT_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xb1,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_INDIRECT_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t ldx_list[] = {
-	(subinstr_t) {
-		.opcode = 0xa2,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xa6,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xb6,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_Y,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xae,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xbe,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t ldy_list[] = {
-	(subinstr_t) {
-		.opcode = 0xa0,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xa4,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xb4,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xac,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xbc,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t lsr_list[] = {
-	(subinstr_t) {
-		.opcode = 0x4a,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_ACCUMULATOR,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x46,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x56,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x4e,
-		.cycles = 6,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x5e,
-		.cycles = 7,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t nop_single[] = {
-	(subinstr_t) {
-		.opcode = 0xea,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_IMPLIED,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t ora_list[] = {
-	(subinstr_t) {
-		.opcode = 0x9,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x5,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x15,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xd,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x1d,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x19,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x1,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_INDIRECT_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x11,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_INDIRECT_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t tax_single[] = {
-	(subinstr_t) {
-		.opcode = 0xaa,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_REGISTER,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t txa_single[] = {
-	(subinstr_t) {
-		.opcode = 0x8a,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_REGISTER,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t dex_single[] = {
-	(subinstr_t) {
-		.opcode = 0xca,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_REGISTER,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t inx_single[] = {
-	(subinstr_t) {
-		.opcode = 0xe8,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_REGISTER,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t tay_single[] = {
-	(subinstr_t) {
-		.opcode = 0xa8,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_REGISTER,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t tya_single[] = {
-	(subinstr_t) {
-		.opcode = 0x98,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_REGISTER,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t dey_single[] = {
-	(subinstr_t) {
-		.opcode = 0x88,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_REGISTER,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t iny_single[] = {
-	(subinstr_t) {
-		.opcode = 0xc8,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_REGISTER,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t rol_list[] = {
-	(subinstr_t) {
-		.opcode = 0x2a,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_ACCUMULATOR,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x26,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x36,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x2e,
-		.cycles = 6,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x3e,
-		.cycles = 7,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t ror_list[] = {
-	(subinstr_t) {
-		.opcode = 0x6a,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_ACCUMULATOR,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x66,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x76,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x6e,
-		.cycles = 6,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x7e,
-		.cycles = 7,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t rti_single[] = {
-	(subinstr_t) {
-		.opcode = 0x40,
-		.cycles = 6,
-		.length = 1,
-		.mode = MODE_IMPLIED,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t rts_single[] = {
-	(subinstr_t) {
-		.opcode = 0x60,
-		.cycles = 6,
-		.length = 1,
-		.mode = MODE_IMPLIED,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t sbc_list[] = {
-	(subinstr_t) {
-		.opcode = 0xe9,
-		.cycles = 2,
-		.length = 2,
-		.mode = MODE_IMMEDIATE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xe5,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xf5,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xed,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xfd,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xf9,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xe1,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_INDIRECT_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0xf1,
-		.cycles = 5,
-		.length = 2,
-		.mode = MODE_INDIRECT_Y | MODE_EXTRA_CYCLE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t sta_list[] = {
-	(subinstr_t) {
-		.opcode = 0x85,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x95,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x8d,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x9d,
-		.cycles = 5,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x99,
-		.cycles = 5,
-		.length = 3,
-		.mode = MODE_ABSOLUTE_Y,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x81,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_INDIRECT_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x91,
-		.cycles = 6,
-		.length = 2,
-		.mode = MODE_INDIRECT_Y,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t txs_single[] = {
-	(subinstr_t) {
-		.opcode = 0x9a,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_STACK,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t tsx_single[] = {
-	(subinstr_t) {
-		.opcode = 0xba,
-		.cycles = 2,
-		.length = 1,
-		.mode = MODE_STACK,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t pha_single[] = {
-	(subinstr_t) {
-		.opcode = 0x48,
-		.cycles = 3,
-		.length = 1,
-		.mode = MODE_STACK,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t pla_single[] = {
-	(subinstr_t) {
-		.opcode = 0x68,
-		.cycles = 4,
-		.length = 1,
-		.mode = MODE_STACK,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t php_single[] = {
-	(subinstr_t) {
-		.opcode = 0x8,
-		.cycles = 3,
-		.length = 1,
-		.mode = MODE_STACK,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t plp_single[] = {
-	(subinstr_t) {
-		.opcode = 0x28,
-		.cycles = 4,
-		.length = 1,
-		.mode = MODE_STACK,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t stx_list[] = {
-	(subinstr_t) {
-		.opcode = 0x86,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x96,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_Y,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x8e,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	}
-};
-
-subinstr_t sty_list[] = {
-	(subinstr_t) {
-		.opcode = 0x84,
-		.cycles = 3,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x94,
-		.cycles = 4,
-		.length = 2,
-		.mode = MODE_ZERO_PAGE_X,
-		.supported = CPU_6502_CORE
-	},
-	(subinstr_t) {
-		.opcode = 0x8c,
-		.cycles = 4,
-		.length = 3,
-		.mode = MODE_ABSOLUTE,
-		.supported = CPU_6502_CORE
-	}
-};
-
 instr_t instr_list[] = {
 	(instr_t) {
 		.name = "ADC",
-		.list = adc_list,
-		.size = 8,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "AND",
-		.list = and_list,
-		.size = 8,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "ASL",
-		.list = asl_list,
-		.size = 5,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "BIT",
-		.list = bit_list,
-		.size = 2,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "BPL",
-		.list = bpl_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "BMI",
-		.list = bmi_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "BVC",
-		.list = bvc_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "BVS",
-		.list = bvs_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "BCC",
-		.list = bcc_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "BCS",
-		.list = bcs_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "BNE",
-		.list = bne_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "BEQ",
-		.list = beq_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "BRK",
-		.list = brk_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "CMP",
-		.list = cmp_list,
-		.size = 8,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "CPX",
-		.list = cpx_list,
-		.size = 3,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "CPY",
-		.list = cpy_list,
-		.size = 3,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "DEC",
-		.list = dec_list,
-		.size = 4,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "EOR",
-		.list = eor_list,
-		.size = 8,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "CLC",
-		.list = clc_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "SEC",
-		.list = sec_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "CLI",
-		.list = cli_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "SEI",
-		.list = sei_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "CLV",
-		.list = clv_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "CLD",
-		.list = cld_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "SED",
-		.list = sed_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "INC",
-		.list = inc_list,
-		.size = 4,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "JMP",
-		.list = jmp_list,
-		.size = 2,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "JSR",
-		.list = jsr_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "LDA",
-		.list = lda_list,
-		.size = 8,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "LDX",
-		.list = ldx_list,
-		.size = 5,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "LDY",
-		.list = ldy_list,
-		.size = 5,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "LSR",
-		.list = lsr_list,
-		.size = 5,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "NOP",
-		.list = nop_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "ORA",
-		.list = ora_list,
-		.size = 8,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "TAX",
-		.list = tax_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "TXA",
-		.list = txa_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "DEX",
-		.list = dex_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "INX",
-		.list = inx_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "TAY",
-		.list = tay_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "TYA",
-		.list = tya_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "DEY",
-		.list = dey_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "INY",
-		.list = iny_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "ROL",
-		.list = rol_list,
-		.size = 5,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "ROR",
-		.list = ror_list,
-		.size = 5,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "RTI",
-		.list = rti_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "RTS",
-		.list = rts_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "SBC",
-		.list = sbc_list,
-		.size = 8,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "STA",
-		.list = sta_list,
-		.size = 7,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "TXS",
-		.list = txs_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "TSX",
-		.list = tsx_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "PHA",
-		.list = pha_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "PLA",
-		.list = pla_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "PHP",
-		.list = php_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "PLP",
-		.list = plp_single,
-		.size = 1,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "STX",
-		.list = stx_list,
-		.size = 3,
 		.action = NULL
 	},
 	(instr_t) {
 		.name = "STY",
-		.list = sty_list,
-		.size = 3,
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "LAX",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "SAX",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "DCP",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "ISC",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "BRA",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "STZ",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "PHX",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "PHY",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "PLX",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "PLY",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "TSB",
+		.action = NULL
+	},
+	(instr_t) {
+		.name = "TRB",
 		.action = NULL
 	}
 };
@@ -1574,3 +285,1610 @@ instr_t* get_instr_list(void) {
 size_t get_instr_list_size(void) {
 	return sizeof(instr_list) / sizeof(*instr_list);
 }
+
+static const opdesc_t opdesc_nmos[INSTR_MAP_SIZE] = {
+	/* 00 BRK */
+	OPDESC(12, MODE_IMPLIED, 1, 7, CPU_6502_CORE),
+	/* 01 ORA */
+	OPDESC(33, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 02 ??? */
+	OPDESC_INVALID,
+	/* 03 ??? */
+	OPDESC_INVALID,
+	/* 04 ??? */
+	OPDESC_INVALID,
+	/* 05 ORA */
+	OPDESC(33, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 06 ASL */
+	OPDESC(2, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 07 ??? */
+	OPDESC_INVALID,
+	/* 08 PHP */
+	OPDESC(52, MODE_STACK, 1, 3, CPU_6502_CORE),
+	/* 09 ORA */
+	OPDESC(33, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 0a ASL */
+	OPDESC(2, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 0b ??? */
+	OPDESC_INVALID,
+	/* 0c ??? */
+	OPDESC_INVALID,
+	/* 0d ORA */
+	OPDESC(33, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 0e ASL */
+	OPDESC(2, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 0f ??? */
+	OPDESC_INVALID,
+	/* 10 BPL */
+	OPDESC(4, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 11 ORA */
+	OPDESC(33, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 12 ??? */
+	OPDESC_INVALID,
+	/* 13 ??? */
+	OPDESC_INVALID,
+	/* 14 ??? */
+	OPDESC_INVALID,
+	/* 15 ORA */
+	OPDESC(33, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 16 ASL */
+	OPDESC(2, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 17 ??? */
+	OPDESC_INVALID,
+	/* 18 CLC */
+	OPDESC(18, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 19 ORA */
+	OPDESC(33, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 1a ??? */
+	OPDESC_INVALID,
+	/* 1b ??? */
+	OPDESC_INVALID,
+	/* 1c ??? */
+	OPDESC_INVALID,
+	/* 1d ORA */
+	OPDESC(33, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 1e ASL */
+	OPDESC(2, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 1f ??? */
+	OPDESC_INVALID,
+	/* 20 JSR */
+	OPDESC(27, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 21 AND */
+	OPDESC(1, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 22 ??? */
+	OPDESC_INVALID,
+	/* 23 ??? */
+	OPDESC_INVALID,
+	/* 24 BIT */
+	OPDESC(3, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 25 AND */
+	OPDESC(1, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 26 ROL */
+	OPDESC(42, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 27 ??? */
+	OPDESC_INVALID,
+	/* 28 PLP */
+	OPDESC(53, MODE_STACK, 1, 4, CPU_6502_CORE),
+	/* 29 AND */
+	OPDESC(1, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 2a ROL */
+	OPDESC(42, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 2b ??? */
+	OPDESC_INVALID,
+	/* 2c BIT */
+	OPDESC(3, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 2d AND */
+	OPDESC(1, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 2e ROL */
+	OPDESC(42, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 2f ??? */
+	OPDESC_INVALID,
+	/* 30 BMI */
+	OPDESC(5, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 31 AND */
+	OPDESC(1, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 32 ??? */
+	OPDESC_INVALID,
+	/* 33 ??? */
+	OPDESC_INVALID,
+	/* 34 ??? */
+	OPDESC_INVALID,
+	/* 35 AND */
+	OPDESC(1, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 36 ROL */
+	OPDESC(42, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 37 ??? */
+	OPDESC_INVALID,
+	/* 38 SEC */
+	OPDESC(19, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 39 AND */
+	OPDESC(1, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 3a ??? */
+	OPDESC_INVALID,
+	/* 3b ??? */
+	OPDESC_INVALID,
+	/* 3c ??? */
+	OPDESC_INVALID,
+	/* 3d AND */
+	OPDESC(1, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 3e ROL */
+	OPDESC(42, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 3f ??? */
+	OPDESC_INVALID,
+	/* 40 RTI */
+	OPDESC(44, MODE_IMPLIED, 1, 6, CPU_6502_CORE),
+	/* 41 EOR */
+	OPDESC(17, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 42 ??? */
+	OPDESC_INVALID,
+	/* 43 ??? */
+	OPDESC_INVALID,
+	/* 44 ??? */
+	OPDESC_INVALID,
+	/* 45 EOR */
+	OPDESC(17, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 46 LSR */
+	OPDESC(31, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 47 ??? */
+	OPDESC_INVALID,
+	/* 48 PHA */
+	OPDESC(50, MODE_STACK, 1, 3, CPU_6502_CORE),
+	/* 49 EOR */
+	OPDESC(17, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 4a LSR */
+	OPDESC(31, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 4b ??? */
+	OPDESC_INVALID,
+	/* 4c JMP */
+	OPDESC(26, MODE_ABSOLUTE, 3, 3, CPU_6502_CORE),
+	/* 4d EOR */
+	OPDESC(17, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 4e LSR */
+	OPDESC(31, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 4f ??? */
+	OPDESC_INVALID,
+	/* 50 BVC */
+	OPDESC(6, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 51 EOR */
+	OPDESC(17, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 52 ??? */
+	OPDESC_INVALID,
+	/* 53 ??? */
+	OPDESC_INVALID,
+	/* 54 ??? */
+	OPDESC_INVALID,
+	/* 55 EOR */
+	OPDESC(17, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 56 LSR */
+	OPDESC(31, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 57 ??? */
+	OPDESC_INVALID,
+	/* 58 CLI */
+	OPDESC(20, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 59 EOR */
+	OPDESC(17, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 5a ??? */
+	OPDESC_INVALID,
+	/* 5b ??? */
+	OPDESC_INVALID,
+	/* 5c ??? */
+	OPDESC_INVALID,
+	/* 5d EOR */
+	OPDESC(17, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 5e LSR */
+	OPDESC(31, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 5f ??? */
+	OPDESC_INVALID,
+	/* 60 RTS */
+	OPDESC(45, MODE_IMPLIED, 1, 6, CPU_6502_CORE),
+	/* 61 ADC */
+	OPDESC(0, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 62 ??? */
+	OPDESC_INVALID,
+	/* 63 ??? */
+	OPDESC_INVALID,
+	/* 64 ??? */
+	OPDESC_INVALID,
+	/* 65 ADC */
+	OPDESC(0, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 66 ROR */
+	OPDESC(43, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 67 ??? */
+	OPDESC_INVALID,
+	/* 68 PLA */
+	OPDESC(51, MODE_STACK, 1, 4, CPU_6502_CORE),
+	/* 69 ADC */
+	OPDESC(0, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 6a ROR */
+	OPDESC(43, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 6b ??? */
+	OPDESC_INVALID,
+	/* 6c JMP */
+	OPDESC(26, MODE_INDIRECT, 3, 5, CPU_6502_NMOS | CPU_6502_UNDOC),
+	/* 6d ADC */
+	OPDESC(0, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 6e ROR */
+	OPDESC(43, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 6f ??? */
+	OPDESC_INVALID,
+	/* 70 BVS */
+	OPDESC(7, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 71 ADC */
+	OPDESC(0, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 72 ??? */
+	OPDESC_INVALID,
+	/* 73 ??? */
+	OPDESC_INVALID,
+	/* 74 ??? */
+	OPDESC_INVALID,
+	/* 75 ADC */
+	OPDESC(0, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 76 ROR */
+	OPDESC(43, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 77 ??? */
+	OPDESC_INVALID,
+	/* 78 SEI */
+	OPDESC(21, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 79 ADC */
+	OPDESC(0, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 7a ??? */
+	OPDESC_INVALID,
+	/* 7b ??? */
+	OPDESC_INVALID,
+	/* 7c ??? */
+	OPDESC_INVALID,
+	/* 7d ADC */
+	OPDESC(0, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 7e ROR */
+	OPDESC(43, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 7f ??? */
+	OPDESC_INVALID,
+	/* 80 ??? */
+	OPDESC_INVALID,
+	/* 81 STA */
+	OPDESC(47, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 82 ??? */
+	OPDESC_INVALID,
+	/* 83 ??? */
+	OPDESC_INVALID,
+	/* 84 STY */
+	OPDESC(55, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 85 STA */
+	OPDESC(47, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 86 STX */
+	OPDESC(54, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 87 ??? */
+	OPDESC_INVALID,
+	/* 88 DEY */
+	OPDESC(40, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* 89 ??? */
+	OPDESC_INVALID,
+	/* 8a TXA */
+	OPDESC(35, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* 8b ??? */
+	OPDESC_INVALID,
+	/* 8c STY */
+	OPDESC(55, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 8d STA */
+	OPDESC(47, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 8e STX */
+	OPDESC(54, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 8f ??? */
+	OPDESC_INVALID,
+	/* 90 BCC */
+	OPDESC(8, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 91 STA */
+	OPDESC(47, MODE_INDIRECT_Y, 2, 6, CPU_6502_CORE),
+	/* 92 ??? */
+	OPDESC_INVALID,
+	/* 93 ??? */
+	OPDESC_INVALID,
+	/* 94 STY */
+	OPDESC(55, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 95 STA */
+	OPDESC(47, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 96 STX */
+	OPDESC(54, MODE_ZERO_PAGE_Y, 2, 4, CPU_6502_CORE),
+	/* 97 ??? */
+	OPDESC_INVALID,
+	/* 98 TYA */
+	OPDESC(39, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* 99 STA */
+	OPDESC(47, MODE_ABSOLUTE_Y, 3, 5, CPU_6502_CORE),
+	/* 9a TXS */
+	OPDESC(48, MODE_STACK, 1, 2, CPU_6502_CORE),
+	/* 9b ??? */
+	OPDESC_INVALID,
+	/* 9c ??? */
+	OPDESC_INVALID,
+	/* 9d STA */
+	OPDESC(47, MODE_ABSOLUTE_X, 3, 5, CPU_6502_CORE),
+	/* 9e ??? */
+	OPDESC_INVALID,
+	/* 9f ??? */
+	OPDESC_INVALID,
+	/* a0 LDY */
+	OPDESC(30, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* a1 LDA */
+	OPDESC(28, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* a2 LDX */
+	OPDESC(29, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* a3 ??? */
+	OPDESC_INVALID,
+	/* a4 LDY */
+	OPDESC(30, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* a5 LDA */
+	OPDESC(28, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* a6 LDX */
+	OPDESC(29, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* a7 ??? */
+	OPDESC_INVALID,
+	/* a8 TAY */
+	OPDESC(38, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* a9 LDA */
+	OPDESC(28, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* aa TAX */
+	OPDESC(34, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* ab ??? */
+	OPDESC_INVALID,
+	/* ac LDY */
+	OPDESC(30, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ad LDA */
+	OPDESC(28, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ae LDX */
+	OPDESC(29, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* af ??? */
+	OPDESC_INVALID,
+	/* b0 BCS */
+	OPDESC(9, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* b1 LDA */
+	OPDESC(28, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* b2 ??? */
+	OPDESC_INVALID,
+	/* b3 ??? */
+	OPDESC_INVALID,
+	/* b4 LDY */
+	OPDESC(30, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* b5 LDA */
+	OPDESC(28, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* b6 LDX */
+	OPDESC(29, MODE_ZERO_PAGE_Y, 2, 4, CPU_6502_CORE),
+	/* b7 ??? */
+	OPDESC_INVALID,
+	/* b8 CLV */
+	OPDESC(22, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* b9 LDA */
+	OPDESC(28, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* ba TSX */
+	OPDESC(49, MODE_STACK, 1, 2, CPU_6502_CORE),
+	/* bb ??? */
+	OPDESC_INVALID,
+	/* bc LDY */
+	OPDESC(30, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* bd LDA */
+	OPDESC(28, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* be LDX */
+	OPDESC(29, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* bf ??? */
+	OPDESC_INVALID,
+	/* c0 CPY */
+	OPDESC(15, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* c1 CMP */
+	OPDESC(13, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* c2 ??? */
+	OPDESC_INVALID,
+	/* c3 ??? */
+	OPDESC_INVALID,
+	/* c4 CPY */
+	OPDESC(15, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* c5 CMP */
+	OPDESC(13, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* c6 DEC */
+	OPDESC(16, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* c7 ??? */
+	OPDESC_INVALID,
+	/* c8 INY */
+	OPDESC(41, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* c9 CMP */
+	OPDESC(13, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* ca DEX */
+	OPDESC(36, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* cb ??? */
+	OPDESC_INVALID,
+	/* cc CPY */
+	OPDESC(15, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* cd CMP */
+	OPDESC(13, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ce DEC */
+	OPDESC(16, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* cf ??? */
+	OPDESC_INVALID,
+	/* d0 BNE */
+	OPDESC(10, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* d1 CMP */
+	OPDESC(13, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* d2 ??? */
+	OPDESC_INVALID,
+	/* d3 ??? */
+	OPDESC_INVALID,
+	/* d4 ??? */
+	OPDESC_INVALID,
+	/* d5 CMP */
+	OPDESC(13, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* d6 DEC */
+	OPDESC(16, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* d7 ??? */
+	OPDESC_INVALID,
+	/* d8 CLD */
+	OPDESC(23, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* d9 CMP */
+	OPDESC(13, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* da ??? */
+	OPDESC_INVALID,
+	/* db ??? */
+	OPDESC_INVALID,
+	/* dc ??? */
+	OPDESC_INVALID,
+	/* dd CMP */
+	OPDESC(13, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* de DEC */
+	OPDESC(16, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* df ??? */
+	OPDESC_INVALID,
+	/* e0 CPX */
+	OPDESC(14, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* e1 SBC */
+	OPDESC(46, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* e2 ??? */
+	OPDESC_INVALID,
+	/* e3 ??? */
+	OPDESC_INVALID,
+	/* e4 CPX */
+	OPDESC(14, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* e5 SBC */
+	OPDESC(46, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* e6 INC */
+	OPDESC(25, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* e7 ??? */
+	OPDESC_INVALID,
+	/* e8 INX */
+	OPDESC(37, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* e9 SBC */
+	OPDESC(46, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* ea NOP */
+	OPDESC(32, MODE_IMPLIED, 1, 2, CPU_6502_CORE),
+	/* eb ??? */
+	OPDESC_INVALID,
+	/* ec CPX */
+	OPDESC(14, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ed SBC */
+	OPDESC(46, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ee INC */
+	OPDESC(25, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* ef ??? */
+	OPDESC_INVALID,
+	/* f0 BEQ */
+	OPDESC(11, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* f1 SBC */
+	OPDESC(46, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* f2 ??? */
+	OPDESC_INVALID,
+	/* f3 ??? */
+	OPDESC_INVALID,
+	/* f4 ??? */
+	OPDESC_INVALID,
+	/* f5 SBC */
+	OPDESC(46, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* f6 INC */
+	OPDESC(25, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* f7 ??? */
+	OPDESC_INVALID,
+	/* f8 SED */
+	OPDESC(24, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* f9 SBC */
+	OPDESC(46, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* fa ??? */
+	OPDESC_INVALID,
+	/* fb ??? */
+	OPDESC_INVALID,
+	/* fc ??? */
+	OPDESC_INVALID,
+	/* fd SBC */
+	OPDESC(46, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* fe INC */
+	OPDESC(25, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* ff ??? */
+	OPDESC_INVALID
+};
+
+static const opdesc_t opdesc_undoc[INSTR_MAP_SIZE] = {
+	/* 00 BRK */
+	OPDESC(12, MODE_IMPLIED, 1, 7, CPU_6502_CORE),
+	/* 01 ORA */
+	OPDESC(33, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 02 ??? */
+	OPDESC_INVALID,
+	/* 03 ??? */
+	OPDESC_INVALID,
+	/* 04 NOP */
+	OPDESC(32, MODE_ZERO_PAGE, 2, 3, CPU_6502_UNDOC),
+	/* 05 ORA */
+	OPDESC(33, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 06 ASL */
+	OPDESC(2, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 07 ??? */
+	OPDESC_INVALID,
+	/* 08 PHP */
+	OPDESC(52, MODE_STACK, 1, 3, CPU_6502_CORE),
+	/* 09 ORA */
+	OPDESC(33, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 0a ASL */
+	OPDESC(2, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 0b ??? */
+	OPDESC_INVALID,
+	/* 0c NOP */
+	OPDESC(32, MODE_ABSOLUTE, 3, 4, CPU_6502_UNDOC),
+	/* 0d ORA */
+	OPDESC(33, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 0e ASL */
+	OPDESC(2, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 0f ??? */
+	OPDESC_INVALID,
+	/* 10 BPL */
+	OPDESC(4, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 11 ORA */
+	OPDESC(33, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 12 ??? */
+	OPDESC_INVALID,
+	/* 13 ??? */
+	OPDESC_INVALID,
+	/* 14 NOP */
+	OPDESC(32, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_UNDOC),
+	/* 15 ORA */
+	OPDESC(33, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 16 ASL */
+	OPDESC(2, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 17 ??? */
+	OPDESC_INVALID,
+	/* 18 CLC */
+	OPDESC(18, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 19 ORA */
+	OPDESC(33, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 1a NOP */
+	OPDESC(32, MODE_IMPLIED, 1, 2, CPU_6502_UNDOC),
+	/* 1b ??? */
+	OPDESC_INVALID,
+	/* 1c NOP */
+	OPDESC(32, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_UNDOC),
+	/* 1d ORA */
+	OPDESC(33, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 1e ASL */
+	OPDESC(2, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 1f ??? */
+	OPDESC_INVALID,
+	/* 20 JSR */
+	OPDESC(27, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 21 AND */
+	OPDESC(1, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 22 ??? */
+	OPDESC_INVALID,
+	/* 23 ??? */
+	OPDESC_INVALID,
+	/* 24 BIT */
+	OPDESC(3, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 25 AND */
+	OPDESC(1, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 26 ROL */
+	OPDESC(42, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 27 ??? */
+	OPDESC_INVALID,
+	/* 28 PLP */
+	OPDESC(53, MODE_STACK, 1, 4, CPU_6502_CORE),
+	/* 29 AND */
+	OPDESC(1, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 2a ROL */
+	OPDESC(42, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 2b ??? */
+	OPDESC_INVALID,
+	/* 2c BIT */
+	OPDESC(3, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 2d AND */
+	OPDESC(1, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 2e ROL */
+	OPDESC(42, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 2f ??? */
+	OPDESC_INVALID,
+	/* 30 BMI */
+	OPDESC(5, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 31 AND */
+	OPDESC(1, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 32 ??? */
+	OPDESC_INVALID,
+	/* 33 ??? */
+	OPDESC_INVALID,
+	/* 34 NOP */
+	OPDESC(32, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_UNDOC),
+	/* 35 AND */
+	OPDESC(1, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 36 ROL */
+	OPDESC(42, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 37 ??? */
+	OPDESC_INVALID,
+	/* 38 SEC */
+	OPDESC(19, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 39 AND */
+	OPDESC(1, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 3a NOP */
+	OPDESC(32, MODE_IMPLIED, 1, 2, CPU_6502_UNDOC),
+	/* 3b ??? */
+	OPDESC_INVALID,
+	/* 3c NOP */
+	OPDESC(32, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_UNDOC),
+	/* 3d AND */
+	OPDESC(1, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 3e ROL */
+	OPDESC(42, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 3f ??? */
+	OPDESC_INVALID,
+	/* 40 RTI */
+	OPDESC(44, MODE_IMPLIED, 1, 6, CPU_6502_CORE),
+	/* 41 EOR */
+	OPDESC(17, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 42 ??? */
+	OPDESC_INVALID,
+	/* 43 ??? */
+	OPDESC_INVALID,
+	/* 44 NOP */
+	OPDESC(32, MODE_ZERO_PAGE, 2, 3, CPU_6502_UNDOC),
+	/* 45 EOR */
+	OPDESC(17, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 46 LSR */
+	OPDESC(31, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 47 ??? */
+	OPDESC_INVALID,
+	/* 48 PHA */
+	OPDESC(50, MODE_STACK, 1, 3, CPU_6502_CORE),
+	/* 49 EOR */
+	OPDESC(17, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 4a LSR */
+	OPDESC(31, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 4b ??? */
+	OPDESC_INVALID,
+	/* 4c JMP */
+	OPDESC(26, MODE_ABSOLUTE, 3, 3, CPU_6502_CORE),
+	/* 4d EOR */
+	OPDESC(17, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 4e LSR */
+	OPDESC(31, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 4f ??? */
+	OPDESC_INVALID,
+	/* 50 BVC */
+	OPDESC(6, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 51 EOR */
+	OPDESC(17, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 52 ??? */
+	OPDESC_INVALID,
+	/* 53 ??? */
+	OPDESC_INVALID,
+	/* 54 NOP */
+	OPDESC(32, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_UNDOC),
+	/* 55 EOR */
+	OPDESC(17, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 56 LSR */
+	OPDESC(31, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 57 ??? */
+	OPDESC_INVALID,
+	/* 58 CLI */
+	OPDESC(20, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 59 EOR */
+	OPDESC(17, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 5a NOP */
+	OPDESC(32, MODE_IMPLIED, 1, 2, CPU_6502_UNDOC),
+	/* 5b ??? */
+	OPDESC_INVALID,
+	/* 5c NOP */
+	OPDESC(32, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_UNDOC),
+	/* 5d EOR */
+	OPDESC(17, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 5e LSR */
+	OPDESC(31, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 5f ??? */
+	OPDESC_INVALID,
+	/* 60 RTS */
+	OPDESC(45, MODE_IMPLIED, 1, 6, CPU_6502_CORE),
+	/* 61 ADC */
+	OPDESC(0, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 62 ??? */
+	OPDESC_INVALID,
+	/* 63 ??? */
+	OPDESC_INVALID,
+	/* 64 NOP */
+	OPDESC(32, MODE_ZERO_PAGE, 2, 3, CPU_6502_UNDOC),
+	/* 65 ADC */
+	OPDESC(0, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 66 ROR */
+	OPDESC(43, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 67 ??? */
+	OPDESC_INVALID,
+	/* 68 PLA */
+	OPDESC(51, MODE_STACK, 1, 4, CPU_6502_CORE),
+	/* 69 ADC */
+	OPDESC(0, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 6a ROR */
+	OPDESC(43, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 6b ??? */
+	OPDESC_INVALID,
+	/* 6c JMP */
+	OPDESC(26, MODE_INDIRECT, 3, 5, CPU_6502_NMOS | CPU_6502_UNDOC),
+	/* 6d ADC */
+	OPDESC(0, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 6e ROR */
+	OPDESC(43, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 6f ??? */
+	OPDESC_INVALID,
+	/* 70 BVS */
+	OPDESC(7, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 71 ADC */
+	OPDESC(0, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 72 ??? */
+	OPDESC_INVALID,
+	/* 73 ??? */
+	OPDESC_INVALID,
+	/* 74 NOP */
+	OPDESC(32, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_UNDOC),
+	/* 75 ADC */
+	OPDESC(0, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 76 ROR */
+	OPDESC(43, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 77 ??? */
+	OPDESC_INVALID,
+	/* 78 SEI */
+	OPDESC(21, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 79 ADC */
+	OPDESC(0, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 7a NOP */
+	OPDESC(32, MODE_IMPLIED, 1, 2, CPU_6502_UNDOC),
+	/* 7b ??? */
+	OPDESC_INVALID,
+	/* 7c NOP */
+	OPDESC(32, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_UNDOC),
+	/* 7d ADC */
+	OPDESC(0, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 7e ROR */
+	OPDESC(43, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 7f ??? */
+	OPDESC_INVALID,
+	/* 80 NOP */
+	OPDESC(32, MODE_IMMEDIATE, 2, 2, CPU_6502_UNDOC),
+	/* 81 STA */
+	OPDESC(47, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 82 NOP */
+	OPDESC(32, MODE_IMMEDIATE, 2, 2, CPU_6502_UNDOC),
+	/* 83 SAX */
+	OPDESC(57, MODE_INDIRECT_X, 2, 6, CPU_6502_UNDOC),
+	/* 84 STY */
+	OPDESC(55, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 85 STA */
+	OPDESC(47, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 86 STX */
+	OPDESC(54, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 87 SAX */
+	OPDESC(57, MODE_ZERO_PAGE, 2, 3, CPU_6502_UNDOC),
+	/* 88 DEY */
+	OPDESC(40, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* 89 NOP */
+	OPDESC(32, MODE_IMMEDIATE, 2, 2, CPU_6502_UNDOC),
+	/* 8a TXA */
+	OPDESC(35, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* 8b ??? */
+	OPDESC_INVALID,
+	/* 8c STY */
+	OPDESC(55, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 8d STA */
+	OPDESC(47, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 8e STX */
+	OPDESC(54, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 8f SAX */
+	OPDESC(57, MODE_ABSOLUTE, 3, 4, CPU_6502_UNDOC),
+	/* 90 BCC */
+	OPDESC(8, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 91 STA */
+	OPDESC(47, MODE_INDIRECT_Y, 2, 6, CPU_6502_CORE),
+	/* 92 ??? */
+	OPDESC_INVALID,
+	/* 93 ??? */
+	OPDESC_INVALID,
+	/* 94 STY */
+	OPDESC(55, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 95 STA */
+	OPDESC(47, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 96 STX */
+	OPDESC(54, MODE_ZERO_PAGE_Y, 2, 4, CPU_6502_CORE),
+	/* 97 SAX */
+	OPDESC(57, MODE_ZERO_PAGE_Y, 2, 4, CPU_6502_UNDOC),
+	/* 98 TYA */
+	OPDESC(39, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* 99 STA */
+	OPDESC(47, MODE_ABSOLUTE_Y, 3, 5, CPU_6502_CORE),
+	/* 9a TXS */
+	OPDESC(48, MODE_STACK, 1, 2, CPU_6502_CORE),
+	/* 9b ??? */
+	OPDESC_INVALID,
+	/* 9c ??? */
+	OPDESC_INVALID,
+	/* 9d STA */
+	OPDESC(47, MODE_ABSOLUTE_X, 3, 5, CPU_6502_CORE),
+	/* 9e ??? */
+	OPDESC_INVALID,
+	/* 9f ??? */
+	OPDESC_INVALID,
+	/* a0 LDY */
+	OPDESC(30, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* a1 LDA */
+	OPDESC(28, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* a2 LDX */
+	OPDESC(29, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* a3 LAX */
+	OPDESC(56, MODE_INDIRECT_X, 2, 6, CPU_6502_UNDOC),
+	/* a4 LDY */
+	OPDESC(30, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* a5 LDA */
+	OPDESC(28, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* a6 LDX */
+	OPDESC(29, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* a7 LAX */
+	OPDESC(56, MODE_ZERO_PAGE, 2, 3, CPU_6502_UNDOC),
+	/* a8 TAY */
+	OPDESC(38, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* a9 LDA */
+	OPDESC(28, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* aa TAX */
+	OPDESC(34, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* ab ??? */
+	OPDESC_INVALID,
+	/* ac LDY */
+	OPDESC(30, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ad LDA */
+	OPDESC(28, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ae LDX */
+	OPDESC(29, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* af LAX */
+	OPDESC(56, MODE_ABSOLUTE, 3, 4, CPU_6502_UNDOC),
+	/* b0 BCS */
+	OPDESC(9, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* b1 LDA */
+	OPDESC(28, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* b2 ??? */
+	OPDESC_INVALID,
+	/* b3 LAX */
+	OPDESC(56, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_UNDOC),
+	/* b4 LDY */
+	OPDESC(30, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* b5 LDA */
+	OPDESC(28, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* b6 LDX */
+	OPDESC(29, MODE_ZERO_PAGE_Y, 2, 4, CPU_6502_CORE),
+	/* b7 LAX */
+	OPDESC(56, MODE_ZERO_PAGE_Y, 2, 4, CPU_6502_UNDOC),
+	/* b8 CLV */
+	OPDESC(22, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* b9 LDA */
+	OPDESC(28, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* ba TSX */
+	OPDESC(49, MODE_STACK, 1, 2, CPU_6502_CORE),
+	/* bb ??? */
+	OPDESC_INVALID,
+	/* bc LDY */
+	OPDESC(30, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* bd LDA */
+	OPDESC(28, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* be LDX */
+	OPDESC(29, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* bf LAX */
+	OPDESC(56, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_UNDOC),
+	/* c0 CPY */
+	OPDESC(15, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* c1 CMP */
+	OPDESC(13, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* c2 NOP */
+	OPDESC(32, MODE_IMMEDIATE, 2, 2, CPU_6502_UNDOC),
+	/* c3 DCP */
+	OPDESC(58, MODE_INDIRECT_X, 2, 8, CPU_6502_UNDOC),
+	/* c4 CPY */
+	OPDESC(15, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* c5 CMP */
+	OPDESC(13, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* c6 DEC */
+	OPDESC(16, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* c7 DCP */
+	OPDESC(58, MODE_ZERO_PAGE, 2, 5, CPU_6502_UNDOC),
+	/* c8 INY */
+	OPDESC(41, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* c9 CMP */
+	OPDESC(13, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* ca DEX */
+	OPDESC(36, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* cb ??? */
+	OPDESC_INVALID,
+	/* cc CPY */
+	OPDESC(15, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* cd CMP */
+	OPDESC(13, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ce DEC */
+	OPDESC(16, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* cf DCP */
+	OPDESC(58, MODE_ABSOLUTE, 3, 6, CPU_6502_UNDOC),
+	/* d0 BNE */
+	OPDESC(10, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* d1 CMP */
+	OPDESC(13, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* d2 ??? */
+	OPDESC_INVALID,
+	/* d3 DCP */
+	OPDESC(58, MODE_INDIRECT_Y, 2, 8, CPU_6502_UNDOC),
+	/* d4 NOP */
+	OPDESC(32, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_UNDOC),
+	/* d5 CMP */
+	OPDESC(13, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* d6 DEC */
+	OPDESC(16, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* d7 DCP */
+	OPDESC(58, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_UNDOC),
+	/* d8 CLD */
+	OPDESC(23, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* d9 CMP */
+	OPDESC(13, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* da NOP */
+	OPDESC(32, MODE_IMPLIED, 1, 2, CPU_6502_UNDOC),
+	/* db DCP */
+	OPDESC(58, MODE_ABSOLUTE_Y, 3, 7, CPU_6502_UNDOC),
+	/* dc NOP */
+	OPDESC(32, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_UNDOC),
+	/* dd CMP */
+	OPDESC(13, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* de DEC */
+	OPDESC(16, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* df DCP */
+	OPDESC(58, MODE_ABSOLUTE_X, 3, 7, CPU_6502_UNDOC),
+	/* e0 CPX */
+	OPDESC(14, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* e1 SBC */
+	OPDESC(46, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* e2 NOP */
+	OPDESC(32, MODE_IMMEDIATE, 2, 2, CPU_6502_UNDOC),
+	/* e3 ISC */
+	OPDESC(59, MODE_INDIRECT_X, 2, 8, CPU_6502_UNDOC),
+	/* e4 CPX */
+	OPDESC(14, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* e5 SBC */
+	OPDESC(46, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* e6 INC */
+	OPDESC(25, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* e7 ISC */
+	OPDESC(59, MODE_ZERO_PAGE, 2, 5, CPU_6502_UNDOC),
+	/* e8 INX */
+	OPDESC(37, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* e9 SBC */
+	OPDESC(46, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* ea NOP */
+	OPDESC(32, MODE_IMPLIED, 1, 2, CPU_6502_CORE),
+	/* eb SBC */
+	OPDESC(46, MODE_IMMEDIATE, 2, 2, CPU_6502_UNDOC),
+	/* ec CPX */
+	OPDESC(14, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ed SBC */
+	OPDESC(46, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ee INC */
+	OPDESC(25, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* ef ISC */
+	OPDESC(59, MODE_ABSOLUTE, 3, 6, CPU_6502_UNDOC),
+	/* f0 BEQ */
+	OPDESC(11, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* f1 SBC */
+	OPDESC(46, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* f2 ??? */
+	OPDESC_INVALID,
+	/* f3 ISC */
+	OPDESC(59, MODE_INDIRECT_Y, 2, 8, CPU_6502_UNDOC),
+	/* f4 NOP */
+	OPDESC(32, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_UNDOC),
+	/* f5 SBC */
+	OPDESC(46, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* f6 INC */
+	OPDESC(25, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* f7 ISC */
+	OPDESC(59, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_UNDOC),
+	/* f8 SED */
+	OPDESC(24, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* f9 SBC */
+	OPDESC(46, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* fa NOP */
+	OPDESC(32, MODE_IMPLIED, 1, 2, CPU_6502_UNDOC),
+	/* fb ISC */
+	OPDESC(59, MODE_ABSOLUTE_Y, 3, 7, CPU_6502_UNDOC),
+	/* fc NOP */
+	OPDESC(32, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_UNDOC),
+	/* fd SBC */
+	OPDESC(46, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* fe INC */
+	OPDESC(25, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* ff ISC */
+	OPDESC(59, MODE_ABSOLUTE_X, 3, 7, CPU_6502_UNDOC)
+};
+
+static const opdesc_t opdesc_65c02[INSTR_MAP_SIZE] = {
+	/* 00 BRK */
+	OPDESC(12, MODE_IMPLIED, 1, 7, CPU_6502_CORE),
+	/* 01 ORA */
+	OPDESC(33, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 02 ??? */
+	OPDESC_INVALID,
+	/* 03 ??? */
+	OPDESC_INVALID,
+	/* 04 TSB */
+	OPDESC(66, MODE_ZERO_PAGE, 2, 5, CPU_6502_65C02),
+	/* 05 ORA */
+	OPDESC(33, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 06 ASL */
+	OPDESC(2, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 07 ??? */
+	OPDESC_INVALID,
+	/* 08 PHP */
+	OPDESC(52, MODE_STACK, 1, 3, CPU_6502_CORE),
+	/* 09 ORA */
+	OPDESC(33, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 0a ASL */
+	OPDESC(2, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 0b ??? */
+	OPDESC_INVALID,
+	/* 0c TSB */
+	OPDESC(66, MODE_ABSOLUTE, 3, 6, CPU_6502_65C02),
+	/* 0d ORA */
+	OPDESC(33, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 0e ASL */
+	OPDESC(2, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 0f ??? */
+	OPDESC_INVALID,
+	/* 10 BPL */
+	OPDESC(4, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 11 ORA */
+	OPDESC(33, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 12 ??? */
+	OPDESC_INVALID,
+	/* 13 ??? */
+	OPDESC_INVALID,
+	/* 14 TRB */
+	OPDESC(67, MODE_ZERO_PAGE, 2, 5, CPU_6502_65C02),
+	/* 15 ORA */
+	OPDESC(33, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 16 ASL */
+	OPDESC(2, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 17 ??? */
+	OPDESC_INVALID,
+	/* 18 CLC */
+	OPDESC(18, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 19 ORA */
+	OPDESC(33, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 1a INC */
+	OPDESC(25, MODE_ACCUMULATOR, 1, 2, CPU_6502_65C02),
+	/* 1b ??? */
+	OPDESC_INVALID,
+	/* 1c TRB */
+	OPDESC(67, MODE_ABSOLUTE, 3, 6, CPU_6502_65C02),
+	/* 1d ORA */
+	OPDESC(33, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 1e ASL */
+	OPDESC(2, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 1f ??? */
+	OPDESC_INVALID,
+	/* 20 JSR */
+	OPDESC(27, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 21 AND */
+	OPDESC(1, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 22 ??? */
+	OPDESC_INVALID,
+	/* 23 ??? */
+	OPDESC_INVALID,
+	/* 24 BIT */
+	OPDESC(3, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 25 AND */
+	OPDESC(1, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 26 ROL */
+	OPDESC(42, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 27 ??? */
+	OPDESC_INVALID,
+	/* 28 PLP */
+	OPDESC(53, MODE_STACK, 1, 4, CPU_6502_CORE),
+	/* 29 AND */
+	OPDESC(1, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 2a ROL */
+	OPDESC(42, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 2b ??? */
+	OPDESC_INVALID,
+	/* 2c BIT */
+	OPDESC(3, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 2d AND */
+	OPDESC(1, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 2e ROL */
+	OPDESC(42, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 2f ??? */
+	OPDESC_INVALID,
+	/* 30 BMI */
+	OPDESC(5, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 31 AND */
+	OPDESC(1, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 32 ??? */
+	OPDESC_INVALID,
+	/* 33 ??? */
+	OPDESC_INVALID,
+	/* 34 BIT */
+	OPDESC(3, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_65C02),
+	/* 35 AND */
+	OPDESC(1, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 36 ROL */
+	OPDESC(42, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 37 ??? */
+	OPDESC_INVALID,
+	/* 38 SEC */
+	OPDESC(19, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 39 AND */
+	OPDESC(1, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 3a DEC */
+	OPDESC(16, MODE_ACCUMULATOR, 1, 2, CPU_6502_65C02),
+	/* 3b ??? */
+	OPDESC_INVALID,
+	/* 3c BIT */
+	OPDESC(3, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_65C02),
+	/* 3d AND */
+	OPDESC(1, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 3e ROL */
+	OPDESC(42, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 3f ??? */
+	OPDESC_INVALID,
+	/* 40 RTI */
+	OPDESC(44, MODE_IMPLIED, 1, 6, CPU_6502_CORE),
+	/* 41 EOR */
+	OPDESC(17, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 42 ??? */
+	OPDESC_INVALID,
+	/* 43 ??? */
+	OPDESC_INVALID,
+	/* 44 ??? */
+	OPDESC_INVALID,
+	/* 45 EOR */
+	OPDESC(17, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 46 LSR */
+	OPDESC(31, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 47 ??? */
+	OPDESC_INVALID,
+	/* 48 PHA */
+	OPDESC(50, MODE_STACK, 1, 3, CPU_6502_CORE),
+	/* 49 EOR */
+	OPDESC(17, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 4a LSR */
+	OPDESC(31, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 4b ??? */
+	OPDESC_INVALID,
+	/* 4c JMP */
+	OPDESC(26, MODE_ABSOLUTE, 3, 3, CPU_6502_CORE),
+	/* 4d EOR */
+	OPDESC(17, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 4e LSR */
+	OPDESC(31, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 4f ??? */
+	OPDESC_INVALID,
+	/* 50 BVC */
+	OPDESC(6, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 51 EOR */
+	OPDESC(17, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 52 ??? */
+	OPDESC_INVALID,
+	/* 53 ??? */
+	OPDESC_INVALID,
+	/* 54 ??? */
+	OPDESC_INVALID,
+	/* 55 EOR */
+	OPDESC(17, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 56 LSR */
+	OPDESC(31, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 57 ??? */
+	OPDESC_INVALID,
+	/* 58 CLI */
+	OPDESC(20, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 59 EOR */
+	OPDESC(17, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 5a PHY */
+	OPDESC(63, MODE_STACK, 1, 3, CPU_6502_65C02),
+	/* 5b ??? */
+	OPDESC_INVALID,
+	/* 5c ??? */
+	OPDESC_INVALID,
+	/* 5d EOR */
+	OPDESC(17, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 5e LSR */
+	OPDESC(31, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 5f ??? */
+	OPDESC_INVALID,
+	/* 60 RTS */
+	OPDESC(45, MODE_IMPLIED, 1, 6, CPU_6502_CORE),
+	/* 61 ADC */
+	OPDESC(0, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 62 ??? */
+	OPDESC_INVALID,
+	/* 63 ??? */
+	OPDESC_INVALID,
+	/* 64 STZ */
+	OPDESC(61, MODE_ZERO_PAGE, 2, 3, CPU_6502_65C02),
+	/* 65 ADC */
+	OPDESC(0, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 66 ROR */
+	OPDESC(43, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* 67 ??? */
+	OPDESC_INVALID,
+	/* 68 PLA */
+	OPDESC(51, MODE_STACK, 1, 4, CPU_6502_CORE),
+	/* 69 ADC */
+	OPDESC(0, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* 6a ROR */
+	OPDESC(43, MODE_ACCUMULATOR, 1, 2, CPU_6502_CORE),
+	/* 6b ??? */
+	OPDESC_INVALID,
+	/* 6c JMP */
+	OPDESC(26, MODE_INDIRECT, 3, 6, CPU_6502_65C02),
+	/* 6d ADC */
+	OPDESC(0, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 6e ROR */
+	OPDESC(43, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* 6f ??? */
+	OPDESC_INVALID,
+	/* 70 BVS */
+	OPDESC(7, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 71 ADC */
+	OPDESC(0, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* 72 ??? */
+	OPDESC_INVALID,
+	/* 73 ??? */
+	OPDESC_INVALID,
+	/* 74 STZ */
+	OPDESC(61, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_65C02),
+	/* 75 ADC */
+	OPDESC(0, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 76 ROR */
+	OPDESC(43, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* 77 ??? */
+	OPDESC_INVALID,
+	/* 78 SEI */
+	OPDESC(21, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* 79 ADC */
+	OPDESC(0, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 7a PLY */
+	OPDESC(65, MODE_STACK, 1, 4, CPU_6502_65C02),
+	/* 7b ??? */
+	OPDESC_INVALID,
+	/* 7c ??? */
+	OPDESC_INVALID,
+	/* 7d ADC */
+	OPDESC(0, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* 7e ROR */
+	OPDESC(43, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* 7f ??? */
+	OPDESC_INVALID,
+	/* 80 BRA */
+	OPDESC(60, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_65C02),
+	/* 81 STA */
+	OPDESC(47, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* 82 ??? */
+	OPDESC_INVALID,
+	/* 83 ??? */
+	OPDESC_INVALID,
+	/* 84 STY */
+	OPDESC(55, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 85 STA */
+	OPDESC(47, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 86 STX */
+	OPDESC(54, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* 87 ??? */
+	OPDESC_INVALID,
+	/* 88 DEY */
+	OPDESC(40, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* 89 BIT */
+	OPDESC(3, MODE_IMMEDIATE, 2, 2, CPU_6502_65C02),
+	/* 8a TXA */
+	OPDESC(35, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* 8b ??? */
+	OPDESC_INVALID,
+	/* 8c STY */
+	OPDESC(55, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 8d STA */
+	OPDESC(47, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 8e STX */
+	OPDESC(54, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* 8f ??? */
+	OPDESC_INVALID,
+	/* 90 BCC */
+	OPDESC(8, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* 91 STA */
+	OPDESC(47, MODE_INDIRECT_Y, 2, 6, CPU_6502_CORE),
+	/* 92 ??? */
+	OPDESC_INVALID,
+	/* 93 ??? */
+	OPDESC_INVALID,
+	/* 94 STY */
+	OPDESC(55, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 95 STA */
+	OPDESC(47, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* 96 STX */
+	OPDESC(54, MODE_ZERO_PAGE_Y, 2, 4, CPU_6502_CORE),
+	/* 97 ??? */
+	OPDESC_INVALID,
+	/* 98 TYA */
+	OPDESC(39, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* 99 STA */
+	OPDESC(47, MODE_ABSOLUTE_Y, 3, 5, CPU_6502_CORE),
+	/* 9a TXS */
+	OPDESC(48, MODE_STACK, 1, 2, CPU_6502_CORE),
+	/* 9b ??? */
+	OPDESC_INVALID,
+	/* 9c STZ */
+	OPDESC(61, MODE_ABSOLUTE, 3, 4, CPU_6502_65C02),
+	/* 9d STA */
+	OPDESC(47, MODE_ABSOLUTE_X, 3, 5, CPU_6502_CORE),
+	/* 9e STZ */
+	OPDESC(61, MODE_ABSOLUTE_X, 3, 5, CPU_6502_65C02),
+	/* 9f ??? */
+	OPDESC_INVALID,
+	/* a0 LDY */
+	OPDESC(30, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* a1 LDA */
+	OPDESC(28, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* a2 LDX */
+	OPDESC(29, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* a3 ??? */
+	OPDESC_INVALID,
+	/* a4 LDY */
+	OPDESC(30, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* a5 LDA */
+	OPDESC(28, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* a6 LDX */
+	OPDESC(29, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* a7 ??? */
+	OPDESC_INVALID,
+	/* a8 TAY */
+	OPDESC(38, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* a9 LDA */
+	OPDESC(28, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* aa TAX */
+	OPDESC(34, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* ab ??? */
+	OPDESC_INVALID,
+	/* ac LDY */
+	OPDESC(30, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ad LDA */
+	OPDESC(28, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ae LDX */
+	OPDESC(29, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* af ??? */
+	OPDESC_INVALID,
+	/* b0 BCS */
+	OPDESC(9, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* b1 LDA */
+	OPDESC(28, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* b2 ??? */
+	OPDESC_INVALID,
+	/* b3 ??? */
+	OPDESC_INVALID,
+	/* b4 LDY */
+	OPDESC(30, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* b5 LDA */
+	OPDESC(28, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* b6 LDX */
+	OPDESC(29, MODE_ZERO_PAGE_Y, 2, 4, CPU_6502_CORE),
+	/* b7 ??? */
+	OPDESC_INVALID,
+	/* b8 CLV */
+	OPDESC(22, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* b9 LDA */
+	OPDESC(28, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* ba TSX */
+	OPDESC(49, MODE_STACK, 1, 2, CPU_6502_CORE),
+	/* bb ??? */
+	OPDESC_INVALID,
+	/* bc LDY */
+	OPDESC(30, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* bd LDA */
+	OPDESC(28, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* be LDX */
+	OPDESC(29, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* bf ??? */
+	OPDESC_INVALID,
+	/* c0 CPY */
+	OPDESC(15, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* c1 CMP */
+	OPDESC(13, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* c2 ??? */
+	OPDESC_INVALID,
+	/* c3 ??? */
+	OPDESC_INVALID,
+	/* c4 CPY */
+	OPDESC(15, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* c5 CMP */
+	OPDESC(13, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* c6 DEC */
+	OPDESC(16, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* c7 ??? */
+	OPDESC_INVALID,
+	/* c8 INY */
+	OPDESC(41, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* c9 CMP */
+	OPDESC(13, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* ca DEX */
+	OPDESC(36, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* cb ??? */
+	OPDESC_INVALID,
+	/* cc CPY */
+	OPDESC(15, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* cd CMP */
+	OPDESC(13, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ce DEC */
+	OPDESC(16, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* cf ??? */
+	OPDESC_INVALID,
+	/* d0 BNE */
+	OPDESC(10, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* d1 CMP */
+	OPDESC(13, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* d2 ??? */
+	OPDESC_INVALID,
+	/* d3 ??? */
+	OPDESC_INVALID,
+	/* d4 ??? */
+	OPDESC_INVALID,
+	/* d5 CMP */
+	OPDESC(13, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* d6 DEC */
+	OPDESC(16, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* d7 ??? */
+	OPDESC_INVALID,
+	/* d8 CLD */
+	OPDESC(23, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* d9 CMP */
+	OPDESC(13, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* da PHX */
+	OPDESC(62, MODE_STACK, 1, 3, CPU_6502_65C02),
+	/* db ??? */
+	OPDESC_INVALID,
+	/* dc ??? */
+	OPDESC_INVALID,
+	/* dd CMP */
+	OPDESC(13, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* de DEC */
+	OPDESC(16, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* df ??? */
+	OPDESC_INVALID,
+	/* e0 CPX */
+	OPDESC(14, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* e1 SBC */
+	OPDESC(46, MODE_INDIRECT_X, 2, 6, CPU_6502_CORE),
+	/* e2 ??? */
+	OPDESC_INVALID,
+	/* e3 ??? */
+	OPDESC_INVALID,
+	/* e4 CPX */
+	OPDESC(14, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* e5 SBC */
+	OPDESC(46, MODE_ZERO_PAGE, 2, 3, CPU_6502_CORE),
+	/* e6 INC */
+	OPDESC(25, MODE_ZERO_PAGE, 2, 5, CPU_6502_CORE),
+	/* e7 ??? */
+	OPDESC_INVALID,
+	/* e8 INX */
+	OPDESC(37, MODE_REGISTER, 1, 2, CPU_6502_CORE),
+	/* e9 SBC */
+	OPDESC(46, MODE_IMMEDIATE, 2, 2, CPU_6502_CORE),
+	/* ea NOP */
+	OPDESC(32, MODE_IMPLIED, 1, 2, CPU_6502_CORE),
+	/* eb ??? */
+	OPDESC_INVALID,
+	/* ec CPX */
+	OPDESC(14, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ed SBC */
+	OPDESC(46, MODE_ABSOLUTE, 3, 4, CPU_6502_CORE),
+	/* ee INC */
+	OPDESC(25, MODE_ABSOLUTE, 3, 6, CPU_6502_CORE),
+	/* ef ??? */
+	OPDESC_INVALID,
+	/* f0 BEQ */
+	OPDESC(11, MODE_BRANCH | MODE_EXTRA_CYCLE, 2, 2, CPU_6502_CORE),
+	/* f1 SBC */
+	OPDESC(46, MODE_INDIRECT_Y | MODE_EXTRA_CYCLE, 2, 5, CPU_6502_CORE),
+	/* f2 ??? */
+	OPDESC_INVALID,
+	/* f3 ??? */
+	OPDESC_INVALID,
+	/* f4 ??? */
+	OPDESC_INVALID,
+	/* f5 SBC */
+	OPDESC(46, MODE_ZERO_PAGE_X, 2, 4, CPU_6502_CORE),
+	/* f6 INC */
+	OPDESC(25, MODE_ZERO_PAGE_X, 2, 6, CPU_6502_CORE),
+	/* f7 ??? */
+	OPDESC_INVALID,
+	/* f8 SED */
+	OPDESC(24, MODE_STATUS, 1, 2, CPU_6502_CORE),
+	/* f9 SBC */
+	OPDESC(46, MODE_ABSOLUTE_Y | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* fa PLX */
+	OPDESC(64, MODE_STACK, 1, 4, CPU_6502_65C02),
+	/* fb ??? */
+	OPDESC_INVALID,
+	/* fc ??? */
+	OPDESC_INVALID,
+	/* fd SBC */
+	OPDESC(46, MODE_ABSOLUTE_X | MODE_EXTRA_CYCLE, 3, 4, CPU_6502_CORE),
+	/* fe INC */
+	OPDESC(25, MODE_ABSOLUTE_X, 3, 7, CPU_6502_CORE),
+	/* ff ??? */
+	OPDESC_INVALID
+};
+
+const opdesc_t* get_model_opdesc_table(cpu_model_t model) {
+	switch (model) {
+	case CPU_6502_UNDOC:
+		return opdesc_undoc;
+	case CPU_6502_65C02:
+		return opdesc_65c02;
+	default:
+		return opdesc_nmos;
+	}
+}
+
+fused_t fused_list[] = {
+	(fused_t) {
+		.opcodes = { 0xca, 0xd0 },
+		.count = 2,
+		.action = NULL
+	},
+	(fused_t) {
+		.opcodes = { 0x88, 0xd0 },
+		.count = 2,
+		.action = NULL
+	},
+	(fused_t) {
+		.opcodes = { 0xc8, 0xc0, 0xd0 },
+		.count = 3,
+		.action = NULL
+	},
+	(fused_t) {
+		.opcodes = { 0xe8, 0xe0, 0xd0 },
+		.count = 3,
+		.action = NULL
+	},
+	(fused_t) {
+		.opcodes = { 0xc9, 0xf0 },
+		.count = 2,
+		.action = NULL
+	},
+	(fused_t) {
+		.opcodes = { 0xa9, 0x85 },
+		.count = 2,
+		.action = NULL
+	},
+	(fused_t) {
+		.opcodes = { 0x18, 0x69 },
+		.count = 2,
+		.action = NULL
+	},
+	(fused_t) {
+		.opcodes = { 0x38, 0xe9 },
+		.count = 2,
+		.action = NULL
+	}
+};
+
+fused_t* get_fused_list(void) {
+	return fused_list;
+}
+
+size_t get_fused_list_size(void) {
+	return sizeof(fused_list) / sizeof(*fused_list);
+}
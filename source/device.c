@@ -4,7 +4,14 @@
 #include "cpu.h"
 #include "mem.h"
 #include "common.h"
+#include "replay.h"
+#include "profile.h"
+#include "aot.h"
+#include "mapper.h"
+#include "rom.h"
+#include "peripheral.h"
 
+#include <stdlib.h>
 #include <string.h> /* memcpy */
 
 #include <time.h>
@@ -23,31 +30,1096 @@
 
 extern void print_mem_region(struct device_t* device, struct mem_region_t* mr);
 extern void dump_mem(struct device_t* device, struct mem_region_t* mr);
+extern int dump_mem_raw(struct device_t* device, struct mem_region_t* mr,
+			const char* outfile);
+
+const uint8_t ram_zero_page[PAGE_SIZE] = { 0 };
 
 void fill_ram(struct device_t* device, uint8_t byte) {
 	unsigned int i;
 
-	for (i = 0; i < device->ram.ram_size; i++)
-		device->ram.ram[i] = byte;
+	for (i = 0; i < device->ram.ram_size; i++)
+		device_poke(device, i, byte);
+
+	return;
+}
+
+#define in_aot_image(device, addr) \
+	((device)->aot && (uint16_t)((addr) - (device)->aot->load_addr) \
+			  < (device)->aot->size)
+
+#define page_in_aot_image(device, page) \
+	((device)->aot && (page) >= get_page_num((device)->aot->load_addr) \
+	 && (page) <= get_page_num((device)->aot->load_addr \
+				   + (device)->aot->size - 1))
+
+#define page_mapped(device, page) \
+	((device)->ram.page_flags[page] & PAGE_MAPPED)
+
+#define page_read_only(device, page) \
+	((device)->ram.page_flags[page] & PAGE_READ_ONLY)
+
+#define page_attr(device, page) ((device)->ram.page_attr[page])
+
+/* RAM or ROM, including mapper banks */
+#define in_memory(device, addr) \
+	(page_attr(device, get_page_num(addr)) <= PAGE_ROM)
+
+static void update_page_flags(struct device_t* device, uint8_t page) {
+	uint8_t kinds;
+	unsigned int i;
+
+	kinds = 0;
+
+	if (device->ram.watch[page]) {
+		for (i = 0; i < PAGE_SIZE; i++)
+			kinds |= device->ram.watch[page][i];
+
+		if (!kinds) {
+			free(device->ram.watch[page]);
+			device->ram.watch[page] = NULL;
+		}
+	}
+
+	device->ram.page_flags[page] &= PAGE_STOP | PAGE_MAPPED
+				      | PAGE_READ_ONLY | PAGE_END;
+
+	if (page_attr(device, page) == PAGE_ROM)
+		device->ram.page_flags[page] |= PAGE_SLOW_WRITE;
+	else if (page_attr(device, page) != PAGE_RAM)
+		device->ram.page_flags[page] |= PAGE_SLOW_READ
+					      | PAGE_SLOW_WRITE;
+	if (kinds & WATCH_READ)
+		device->ram.page_flags[page] |= PAGE_SLOW_READ;
+	if (kinds & WATCH_WRITE)
+		device->ram.page_flags[page] |= PAGE_SLOW_WRITE;
+	if ((kinds & WATCH_EXEC) || device->profile)
+		device->ram.page_flags[page] |= PAGE_SLOW_EXEC;
+	if (page_in_aot_image(device, page) || !page_allocated(device, page)
+	 || (device->mapper && mapper_reg_on_page(device->mapper, page)))
+		device->ram.page_flags[page] |= PAGE_SLOW_WRITE;
+
+	return;
+}
+
+/* gives the page memory of its own, on the first write to it */
+static bool alloc_page(struct device_t* device, uint8_t page) {
+	uint8_t* mem;
+
+	if (page_allocated(device, page))
+		return true;
+
+	mem = calloc(PAGE_SIZE, 1);
+	if (!mem) {
+		logd_err("Could not allocate RAM page %.2x.", page);
+		return false;
+	}
+
+	device->ram.pages[page] = mem;
+	update_page_flags(device, page);
+
+	return true;
+}
+
+#define is_watched(device, addr, kind) \
+	((device)->ram.watch[get_page_num(addr)] \
+	 && ((device)->ram.watch[get_page_num(addr)][(addr) & 0xFF] & (kind)))
+
+/* errors from memory accesses cannot be returned through the action,
+ * so they stop the device before the next instruction instead */
+#define device_set_error(device, err, addr) do { \
+	(device)->error = (err); \
+	device_request_stop((device), DEVICE_EXIT_ERROR, (addr)); \
+} while (0)
+
+static struct peripheral_t* find_peripheral(struct device_t* device,
+					    uint16_t addr) {
+	unsigned int i;
+
+	for (i = 0; i < device->num_of_peripherals; i++)
+		if (addr >= device->peripherals[i]->addr_start
+		 && addr <= device->peripherals[i]->addr_end)
+			return device->peripherals[i];
+
+	return NULL;
+}
+
+uint8_t device_read_slow(struct device_t* device, uint16_t addr) {
+	struct peripheral_t* peripheral;
+	uint8_t val;
+
+	if (is_watched(device, addr, WATCH_READ))
+		device_request_stop(device, DEVICE_EXIT_WATCHPOINT, addr);
+
+	if (in_memory(device, addr))
+		return ram_byte(device, addr);
+
+	if (page_attr(device, get_page_num(addr)) == PAGE_UNMAPPED) {
+		device_set_error(device, DEVICE_INVALID_ADDR, addr);
+		return 0;
+	}
+
+	if (device->replay && replay_playing(device))
+		return replay_read(device, addr);
+
+	peripheral = find_peripheral(device, addr);
+
+	if (peripheral && peripheral->read)
+		val = peripheral->read(peripheral, addr);
+	else if (peripheral || !device->read) {
+		device_set_error(device, DEVICE_INVALID_ADDR, addr);
+		return 0;
+	}
+	else
+		val = device->read(device, addr);
+
+	if (device->replay)
+		replay_log_read(device, addr, val);
+
+	return val;
+}
+
+void device_write_slow(struct device_t* device, uint16_t addr, uint8_t val) {
+	struct peripheral_t* peripheral;
+	int ret;
+
+	if (is_watched(device, addr, WATCH_WRITE))
+		device_request_stop(device, DEVICE_EXIT_WATCHPOINT, addr);
+
+	if (device->mapper && mapper_has_reg(device->mapper, addr))
+		mapper_write(device->mapper, addr, val);
+	else if (page_attr(device, get_page_num(addr)) == PAGE_RAM) {
+		if (in_aot_image(device, addr))
+			device_detach_aot(device);
+
+		if (alloc_page(device, get_page_num(addr)))
+			ram_byte(device, addr) = val;
+		else
+			device_set_error(device, DEVICE_OUT_OF_MEMORY, addr);
+	}
+	else if (page_attr(device, get_page_num(addr)) == PAGE_ROM) {
+		if (device->rom_policy == ROM_WRITES_TRAP)
+			device_set_error(device, DEVICE_ROM_WRITE, addr);
+	}
+	else if (page_attr(device, get_page_num(addr)) == PAGE_UNMAPPED)
+		device_set_error(device, DEVICE_INVALID_ADDR, addr);
+	else if ((peripheral = find_peripheral(device, addr))) {
+		if (peripheral->write)
+			peripheral->write(peripheral, addr, val);
+		else
+			device_set_error(device, DEVICE_INVALID_ADDR, addr);
+	}
+	else if (!device->write)
+		device_set_error(device, DEVICE_INVALID_ADDR, addr);
+	else if ((ret = device->write(device, addr, val)))
+		device_set_error(device, ret, addr);
+
+	return;
+}
+
+/* debugger access: no watchpoints and no errors, and ROM is writable;
+ * peripherals are left alone, as accessing them can change them */
+uint8_t device_peek(struct device_t* device, uint16_t addr) {
+
+	if (in_memory(device, addr))
+		return ram_byte(device, addr);
+
+	if (page_attr(device, get_page_num(addr)) == PAGE_UNMAPPED
+	 || find_peripheral(device, addr))
+		return 0;
+
+	return device->read ? device->read(device, addr) : 0;
+}
+
+void device_poke(struct device_t* device, uint16_t addr, uint8_t val) {
+
+	if (page_read_only(device, get_page_num(addr)))
+		return;
+
+	if (in_aot_image(device, addr))
+		device_detach_aot(device);
+
+	if (in_memory(device, addr)) {
+		if (alloc_page(device, get_page_num(addr)))
+			ram_byte(device, addr) = val;
+	}
+	else if (page_attr(device, get_page_num(addr)) == PAGE_MMIO
+	      && !find_peripheral(device, addr) && device->write)
+		(void)device->write(device, addr, val);
+
+	return;
+}
+
+/* raw RAM contents, without peripherals; pages never written read as
+ * zero */
+void device_copy_ram(struct device_t* device, uint8_t* dst, uint16_t addr,
+		     unsigned int len) {
+	unsigned int chunk;
+
+	while (len) {
+		chunk = PAGE_SIZE - (addr & 0xFF);
+		if (chunk > len)
+			chunk = len;
+
+		memcpy(dst, &ram_byte(device, addr), chunk);
+
+		dst += chunk;
+		addr += chunk;
+		len -= chunk;
+	}
+
+	return;
+}
+
+#define is_zero(mem, len) \
+	((len) == 0 || ((mem)[0] == 0 && !memcmp((mem), (mem) + 1, (len) - 1)))
+
+/* the reverse, e.g. for a checkpoint; all-zero chunks of pages that
+ * were never written are skipped, so they stay shared, and so are
+ * shared ROM images, which cannot have changed */
+int device_load_ram(struct device_t* device, uint16_t addr,
+		    const uint8_t* src, unsigned int len) {
+	unsigned int chunk;
+
+	while (len) {
+		chunk = PAGE_SIZE - (addr & 0xFF);
+		if (chunk > len)
+			chunk = len;
+
+		if (!page_read_only(device, get_page_num(addr))
+		 && (page_allocated(device, get_page_num(addr))
+		     || !is_zero(src, chunk))) {
+			if (!alloc_page(device, get_page_num(addr)))
+				return DEVICE_OUT_OF_MEMORY;
+
+			memcpy(&ram_byte(device, addr), src, chunk);
+		}
+
+		src += chunk;
+		addr += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+int device_set_watch(struct device_t* device, uint16_t addr, uint8_t kind) {
+	uint8_t page;
+
+	page = get_page_num(addr);
+
+	if (!device->ram.watch[page]) {
+		device->ram.watch[page] = calloc(PAGE_SIZE, 1);
+		if (!device->ram.watch[page]) {
+			logd_err("Could not allocate watch page %.2x.", page);
+			return -1;
+		}
+	}
+
+	device->ram.watch[page][addr & 0xFF] |= kind;
+	update_page_flags(device, page);
+
+	return 0;
+}
+
+void device_clear_watch(struct device_t* device, uint16_t addr, uint8_t kind) {
+	uint8_t page;
+
+	page = get_page_num(addr);
+
+	if (!device->ram.watch[page])
+		return;
+
+	device->ram.watch[page][addr & 0xFF] &= ~kind;
+	update_page_flags(device, page);
+
+	return;
+}
+
+/* stop before the next instruction; this only flags the pages, so it
+ * costs nothing until it is actually requested */
+void device_request_stop(struct device_t* device, device_exit_t reason,
+			 uint16_t addr) {
+	unsigned int i;
+
+	/* errors take precedence over any other pending stop */
+	if (device->stop_reason != DEVICE_EXIT_NONE
+	 && reason != DEVICE_EXIT_ERROR)
+		return;
+
+	device->stop_reason = reason;
+	device->stop_addr = addr;
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		device->ram.page_flags[i] |= PAGE_STOP;
+
+	/* compiled code only looks at the deadline */
+	device->deadline = 0;
+
+	return;
+}
+
+/* the only way to stop the device from another thread: it only sets
+ * the flag and the deadline, and the run loop turns them into a stop
+ * request on its own thread (see run_events) */
+void device_interrupt(struct device_t* device) {
+
+	atomic_store(&device->interrupt, true);
+	__atomic_store_n(&device->deadline, 0, __ATOMIC_SEQ_CST);
+
+	return;
+}
+
+/* a raised IRQ line or a pending stop keeps the deadline at 0, so the
+ * run loop looks at it after every instruction until it is dealt with */
+static void update_deadline(struct device_t* device) {
+	unsigned int i;
+
+	device->deadline = DEVICE_NO_DEADLINE;
+
+	if (device->irq || device->stop_reason != DEVICE_EXIT_NONE) {
+		device->deadline = 0;
+		return;
+	}
+
+	for (i = 0; i < DEVICE_MAX_EVENTS; i++)
+		if (device->events[i].fire
+		 && device->events[i].cycle < device->deadline)
+			device->deadline = device->events[i].cycle;
+
+	/* an interrupt that came in while this was worked out must not
+	 * be overwritten */
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load(&device->interrupt))
+		device->deadline = 0;
+
+	return;
+}
+
+int device_schedule(struct device_t* device, uint64_t cycle,
+		    device_event_fn fire, void* data) {
+	unsigned int i;
+
+	for (i = 0; i < DEVICE_MAX_EVENTS; i++) {
+		if (!device->events[i].fire) {
+			device->events[i] = (struct device_event_t) {
+				.cycle = cycle,
+				.fire = fire,
+				.data = data,
+				.passive = false
+			};
+
+			if (cycle < device->deadline)
+				device->deadline = cycle;
+
+			return i;
+		}
+	}
+
+	logd_err("No free event slots.");
+
+	return -1;
+}
+
+int device_schedule_passive(struct device_t* device, uint64_t cycle,
+			    device_event_fn fire, void* data) {
+	int i;
+
+	i = device_schedule(device, cycle, fire, data);
+	if (i >= 0)
+		device->events[i].passive = true;
+
+	return i;
+}
+
+void device_unschedule(struct device_t* device, device_event_fn fire,
+		       void* data) {
+	unsigned int i;
+
+	for (i = 0; i < DEVICE_MAX_EVENTS; i++)
+		if (device->events[i].fire == fire
+		 && device->events[i].data == data)
+			device->events[i].fire = NULL;
+
+	update_deadline(device);
+
+	return;
+}
+
+static void run_events(struct device_t* device) {
+	struct device_event_t event;
+	unsigned int i;
+
+	if (atomic_exchange(&device->interrupt, false))
+		device_request_stop(device, DEVICE_EXIT_INTERRUPT,
+				    device->cpu->PC);
+
+	for (i = 0; i < DEVICE_MAX_EVENTS; i++) {
+		if (device->events[i].fire
+		 && device->events[i].cycle <= device->cycles) {
+			/* free the slot first, so the event can reschedule */
+			event = device->events[i];
+			device->events[i].fire = NULL;
+			event.fire(device, event.data);
+
+			/* it may have changed what an idle loop runs, or
+			 * raised an IRQ whose handler would count as part of
+			 * the next pass, so the period is measured again */
+			if (!event.passive)
+				device_reset_idle(device);
+		}
+	}
+
+	update_deadline(device);
+
+	return;
+}
+
+static uint64_t next_wake(struct device_t* device) {
+	uint64_t wake;
+	unsigned int i;
+
+	wake = DEVICE_NO_DEADLINE;
+
+	for (i = 0; i < DEVICE_MAX_EVENTS; i++)
+		if (device->events[i].fire && !device->events[i].passive
+		 && device->events[i].cycle < wake)
+			wake = device->events[i].cycle;
+
+	return wake;
+}
+
+#define IDLE_MAX_INSTRS 16
+
+/* instructions that write memory or the stack, or leave the loop */
+static const char* idle_busy[] = {
+	"STA", "STX", "STY", "INC", "DEC", "ASL", "LSR", "ROL", "ROR",
+	"PHA", "PHP", "PLA", "PLP", "JSR", "RTS", "RTI", "BRK",
+	"SAX", "DCP", "ISC", "STZ", "TSB", "TRB", "PHX", "PHY", "PLX", "PLY"
+};
+
+/* follows the loop from its head to the jump or branch that closes it;
+ * forward branches out of it are fine, as one pass decides them all */
+static int scan_idle_body(struct device_t* device, uint16_t head) {
+	const opdesc_t* op;
+	instr_mode_t mode;
+	uint16_t target;
+	uint16_t addr;
+	uint16_t arg;
+	unsigned int i;
+	unsigned int j;
+	int body;
+
+	body = DEVICE_IDLE_RAM;
+	addr = head;
+
+	for (i = 0; i < IDLE_MAX_INSTRS; i++) {
+		op = &(device->cpu->opdesc[ram_byte(device, addr)]);
+		if (!opdesc_valid(op) || !opdesc_instr(op)->action)
+			return DEVICE_IDLE_BUSY;
+
+		mode = opdesc_mode(op);
+		arg = opdesc_length(op) == 3
+		    ? ram_byte(device, (uint16_t)(addr + 1))
+		    | (uint16_t)ram_byte(device, (uint16_t)(addr + 2)) << 8
+		    : ram_byte(device, (uint16_t)(addr + 1));
+
+		if (!strncmp(opdesc_name(op), "JMP", 3))
+			return mode == MODE_ABSOLUTE && arg == head
+			     ? body : DEVICE_IDLE_BUSY;
+
+		if (mode == MODE_BRANCH) {
+			target = addr + 2 + (int8_t)arg;
+			if (target == head)
+				return body;
+			if (target < addr)
+				return DEVICE_IDLE_BUSY;
+		}
+
+		for (j = 0; j < sizeof(idle_busy) / sizeof(*idle_busy); j++)
+			if (!strncmp(opdesc_name(op), idle_busy[j], 3)
+			 && mode != MODE_ACCUMULATOR)
+				return DEVICE_IDLE_BUSY;
+
+		switch (mode) {
+		case MODE_ZERO_PAGE:
+		case MODE_ABSOLUTE:
+			if (device->ram.page_flags[get_page_num(arg)]
+			  & PAGE_SLOW_READ)
+				body = DEVICE_IDLE_EXTERNAL;
+			break;
+		case MODE_ZERO_PAGE_X:
+		case MODE_ZERO_PAGE_Y:
+		case MODE_ABSOLUTE_X:
+		case MODE_ABSOLUTE_Y:
+		case MODE_INDIRECT_X:
+		case MODE_INDIRECT_Y:
+		case MODE_INDIRECT:
+			body = DEVICE_IDLE_EXTERNAL;
+			break;
+		default:
+			break;
+		}
+
+		addr += opdesc_length(op);
+	}
+
+	return DEVICE_IDLE_BUSY;
+}
+
+/* a backward jump to the same place with the same registers, over a
+ * body that cannot write, repeats exactly until an event changes what
+ * it reads; so time skips whole passes ahead to the next event that can
+ * wake it, and a loop over RAM with no such event is idle for good;
+ * returns true when the device should stop */
+static bool check_idle(struct device_t* device) {
+	struct device_idle_t* idle;
+	uint8_t regs[5];
+	uint64_t period;
+	uint64_t instrs;
+	uint64_t passes;
+	uint64_t wake;
+
+	idle = &(device->idle);
+
+	regs[0] = device->cpu->A;
+	regs[1] = device->cpu->X;
+	regs[2] = device->cpu->Y;
+	regs[3] = device->cpu->S;
+	regs[4] = device->cpu->P;
+
+	if (idle->body == DEVICE_IDLE_NONE
+	 || idle->head != device->cpu->PC
+	 || memcmp(idle->regs, regs, sizeof(regs))) {
+		idle->head = device->cpu->PC;
+		memcpy(idle->regs, regs, sizeof(regs));
+		idle->body = DEVICE_IDLE_UNKNOWN;
+	}
+	else {
+		if (idle->body == DEVICE_IDLE_UNKNOWN)
+			idle->body = scan_idle_body(device, idle->head);
+
+		if (idle->body != DEVICE_IDLE_BUSY) {
+			period = device->cycles - idle->cycles;
+			instrs = device->instr_count - idle->instr_count;
+			wake = next_wake(device);
+
+			if (wake == DEVICE_NO_DEADLINE
+			 && idle->body == DEVICE_IDLE_RAM) {
+				dtracei("Idle loop at %.4x", idle->head);
+				device->exit_reason = DEVICE_EXIT_IDLE;
+				return true;
+			}
+
+			if (wake != DEVICE_NO_DEADLINE && wake > device->cycles) {
+				passes = (wake - device->cycles + period - 1)
+				       / period;
+				dtracei("Skipping %llu passes of idle loop at "
+					"%.4x", (unsigned long long)passes,
+					idle->head);
+				device->cycles += passes * period;
+				device->instr_count += passes * instrs;
+			}
+		}
+	}
+
+	idle->cycles = device->cycles;
+	idle->instr_count = device->instr_count;
+
+	return false;
+}
+
+/* profiling counts on the exec slow path, which also keeps pairs from
+ * being fused while it is on */
+int device_enable_profile(struct device_t* device) {
+	unsigned int i;
+
+	if (!device->profile) {
+		device->profile = new_profile();
+		if (!device->profile)
+			return -1;
+	}
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		update_page_flags(device, i);
+
+	return 0;
+}
+
+/* compiled code stands in for the image only while RAM still holds it;
+ * its pages are write-protected so that changing them detaches it */
+int device_attach_aot(struct device_t* device,
+		      const struct aot_image_t* image) {
+	unsigned int i;
+	uint8_t* mem;
+	uint32_t hash;
+
+	for (i = image->load_addr; i < image->load_addr + image->size;
+	     i += PAGE_SIZE) {
+		if (i >= 0x10000 || !in_memory(device, i)) {
+			logd_err("Compiled image at %.4x does not fit in "
+				 "memory.", image->load_addr);
+			return -1;
+		}
+	}
+
+	mem = malloc(image->size);
+	if (!mem) {
+		logd_err("Could not allocate memory to check compiled image.");
+		return -1;
+	}
+
+	device_copy_ram(device, mem, image->load_addr, image->size);
+	hash = aot_hash(mem, image->size);
+	free(mem);
+
+	if (hash != image->hash) {
+		logd_err("Compiled image does not match RAM at %.4x.",
+			 image->load_addr);
+		return -1;
+	}
+
+	if (image->model != device->cpu->model) {
+		logd_err("Compiled image is for another CPU model.");
+		return -1;
+	}
+
+	/* compiled code only looks for the end of the binary between
+	 * blocks, which end where the image does */
+	if (image->load_addr + image->size > device->ram.end_instr) {
+		logd_err("Compiled image runs past the end of the binary.");
+		return -1;
+	}
+
+	device->aot = image;
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		update_page_flags(device, i);
+
+	dtracei("Attached compiled image at %.4x (%u bytes).",
+		image->load_addr, image->size);
+
+	return 0;
+}
+
+void device_detach_aot(struct device_t* device) {
+	unsigned int i;
+
+	if (!device->aot)
+		return;
+
+	dtracei("Detached compiled image at %.4x.", device->aot->load_addr);
+
+	device->aot = NULL;
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		update_page_flags(device, i);
+
+	return;
+}
+
+/* points count pages from page on at mem, e.g. a mapper bank; RAM the
+ * window covered is dropped, and compiled code is detached if the
+ * window covers it, as the code there changes */
+void device_map_pages(struct device_t* device, uint8_t page, uint8_t* mem,
+		      unsigned int count) {
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		if (page_allocated(device, page + i)
+		 && !page_mapped(device, page + i))
+			free(device->ram.pages[page + i]);
+
+		device->ram.pages[page + i] = mem + i * PAGE_SIZE;
+		device->ram.page_flags[page + i] |= PAGE_MAPPED;
+		device->ram.page_flags[page + i] &= ~PAGE_READ_ONLY;
+
+		if (page_attr(device, page + i) != PAGE_ROM)
+			page_attr(device, page + i) = PAGE_RAM;
+
+		if (page_in_aot_image(device, page + i))
+			device_detach_aot(device);
+
+		update_page_flags(device, page + i);
+	}
+
+	return;
+}
+
+/* pages 0 and 1 stay RAM; pages that stop being memory lose what they
+ * held, and a window can only be made ROM or RAM */
+int device_set_page_attr(struct device_t* device, uint16_t start_addr,
+			 uint16_t end_addr, page_attr_t attr) {
+	unsigned int page;
+
+	if (start_addr > end_addr)
+		return -1;
+
+	for (page = get_page_num(start_addr); page <= get_page_num(end_addr);
+	     page++) {
+		if (page < 2 && attr != PAGE_RAM) {
+			logd_err("The zero page and the stack must stay RAM.");
+			return -1;
+		}
+
+		if (page_mapped(device, page) && attr > PAGE_ROM) {
+			logd_err("Page %.2x shows a mapper window.", page);
+			return -1;
+		}
+
+		if (page_read_only(device, page) && attr != PAGE_ROM) {
+			logd_err("Page %.2x shows a shared ROM image.", page);
+			return -1;
+		}
+	}
+
+	for (page = get_page_num(start_addr); page <= get_page_num(end_addr);
+	     page++) {
+		if (attr > PAGE_ROM) {
+			if (page_allocated(device, page))
+				free(device->ram.pages[page]);
+
+			device->ram.pages[page] = (uint8_t*)ram_zero_page;
+
+			if (page_in_aot_image(device, page))
+				device_detach_aot(device);
+		}
+
+		page_attr(device, page) = attr;
+		update_page_flags(device, page);
+	}
+
+	dtracei("Pages %.2x-%.2x set to %u.", get_page_num(start_addr),
+		get_page_num(end_addr), attr);
+
+	return 0;
+}
+
+/* the peripheral's pages become MMIO; it outlives the device */
+int device_attach_peripheral(struct device_t* device,
+			     struct peripheral_t* peripheral) {
+
+	if (device->num_of_peripherals == DEVICE_MAX_PERIPHERALS) {
+		logd_err("No more than %d peripherals.",
+			 DEVICE_MAX_PERIPHERALS);
+		return -1;
+	}
+
+	if (peripheral->addr_start > peripheral->addr_end
+	 || device_set_page_attr(device, peripheral->addr_start,
+				 peripheral->addr_end, PAGE_MMIO)) {
+		logd_err("Cannot map peripheral at %.4x-%.4x.",
+			 peripheral->addr_start, peripheral->addr_end);
+		return -1;
+	}
+
+	peripheral->device = device;
+	device->peripherals[device->num_of_peripherals++] = peripheral;
+
+	dtracei("Attached peripheral at %.4x-%.4x.", peripheral->addr_start,
+		peripheral->addr_end);
+
+	return 0;
+}
+
+/* level-triggered, like the 6502's IRQ pin: the line stays raised until
+ * the peripheral lowers it, e.g. when the handler acknowledges it */
+void device_set_irq(struct device_t* device, struct peripheral_t* peripheral,
+		    bool raised) {
+	unsigned int i;
+
+	for (i = 0; i < device->num_of_peripherals; i++)
+		if (device->peripherals[i] == peripheral)
+			break;
+
+	if (i == device->num_of_peripherals)
+		return;
+
+	if (raised)
+		device->irq |= (uint8_t)1 << i;
+	else
+		device->irq &= ~((uint8_t)1 << i);
+
+	update_deadline(device);
+
+	return;
+}
+
+/* for CPUs on a shared bus: the device sees the memory of bus from
+ * page 2 up, with its page attributes, peripherals, mapper and ROM policy,
+ * while the zero page and the stack stay its own; RAM is allocated up
+ * front, since a page allocated later would belong to one of them */
+int device_share_bus(struct device_t* device, struct device_t* bus) {
+	unsigned int page;
+
+	for (page = 2; page < PAGE_COUNT; page++) {
+		if (page_attr(bus, page) > PAGE_ROM) {
+			page_attr(device, page) = page_attr(bus, page);
+			update_page_flags(device, page);
+			continue;
+		}
+
+		if (!alloc_page(bus, page))
+			return DEVICE_OUT_OF_MEMORY;
+
+		page_attr(device, page) = page_attr(bus, page);
+		device_map_pages(device, page, bus->ram.pages[page], 1);
+
+		device->ram.page_flags[page] |= page_read_only(bus, page);
+		update_page_flags(device, page);
+	}
+
+	memcpy(device->peripherals, bus->peripherals,
+	       sizeof(device->peripherals));
+	device->num_of_peripherals = bus->num_of_peripherals;
+	device->data = bus->data;
+	device->read = bus->read;
+	device->write = bus->write;
+	device->rom_policy = bus->rom_policy;
+	device->ram.end_instr = bus->ram.end_instr;
+
+	/* so its writes reach the mapper's registers, and switches by any
+	 * CPU show on all of them */
+	if (bus->mapper)
+		return device_attach_mapper(device, bus->mapper);
+
+	return 0;
+}
+
+/* shows rom from addr on, which must start a page, as ROM; the pages
+ * point into the shared mapping, so nothing is copied, and the device
+ * never writes them, not even from the debugger or a checkpoint */
+int device_map_rom(struct device_t* device, uint16_t addr,
+		   const struct rom_t* rom) {
+	unsigned int count;
+	unsigned int i;
+
+	count = (rom->size + PAGE_SIZE - 1) / PAGE_SIZE;
+
+	if ((addr & 0xFF) || addr + count * PAGE_SIZE > MEM_MAX_ADDR + 1) {
+		logd_err("ROM image at %.4x does not fit in whole pages.",
+			 addr);
+		return -1;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (page_mapped(device, get_page_num(addr) + i)) {
+			logd_err("ROM image at %.4x overlaps a window.", addr);
+			return -1;
+		}
+	}
+
+	if (device_set_page_attr(device, addr, addr + count * PAGE_SIZE - 1,
+				 PAGE_ROM))
+		return -1;
+
+	device_map_pages(device, get_page_num(addr), (uint8_t*)rom->mem,
+			 count);
+
+	for (i = 0; i < count; i++) {
+		device->ram.page_flags[get_page_num(addr) + i]
+			|= PAGE_READ_ONLY;
+		update_page_flags(device, get_page_num(addr) + i);
+	}
+
+	dtracei("Mapped ROM image %.8x at %.4x (%u pages).", rom->hash,
+		addr, count);
+
+	return 0;
+}
+
+/* pages 0 and 1 stay RAM; the mapper outlives the device, and may be
+ * attached to every device on a shared bus */
+int device_attach_mapper(struct device_t* device, struct mapper_t* mapper) {
+	unsigned int i;
+
+	for (i = 0; i < mapper->num_windows; i++) {
+		if (mapper->windows[i].page < 2) {
+			logd_err("Mapper window cannot cover the zero page "
+				 "or the stack.");
+			return -1;
+		}
+	}
+
+	if (mapper->num_devices == MAPPER_MAX_DEVICES) {
+		logd_err("No more than %d devices on a mapper.",
+			 MAPPER_MAX_DEVICES);
+		return -1;
+	}
+
+	device->mapper = mapper;
+	mapper->devices[mapper->num_devices++] = device;
+
+	for (i = 0; i < mapper->num_windows; i++)
+		device_map_pages(device, mapper->windows[i].page,
+				 mapper_bank(mapper, mapper->windows[i].bank),
+				 mapper_window_pages(mapper));
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		update_page_flags(device, i);
+
+	dtracei("Attached %s mapper with %u windows.", mapper->ops->name,
+		mapper->num_windows);
+
+	return 0;
+}
+
+static void clear_stop(struct device_t* device) {
+	unsigned int i;
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		device->ram.page_flags[i] &= ~PAGE_STOP;
+
+	device->stop_reason = DEVICE_EXIT_NONE;
+
+	update_deadline(device);
+
+	return;
+}
+
+/* pages before first lose PAGE_END and the rest get it, PAGE_COUNT
+ * clearing it everywhere; only done when the end moves to another page */
+static void mark_end_pages(struct device_t* device, unsigned int first) {
+	unsigned int i;
+
+	if (first == device->ram.end_page)
+		return;
+
+	for (i = 0; i < PAGE_COUNT; i++) {
+		if (i < first)
+			device->ram.page_flags[i] &= ~PAGE_END;
+		else
+			device->ram.page_flags[i] |= PAGE_END;
+	}
+
+	device->ram.end_page = first;
 
 	return;
 }
 
+static bool check_exec_stop(struct device_t* device) {
+
+	if (device->stop_reason != DEVICE_EXIT_NONE) {
+		device->exit_reason = device->stop_reason;
+		clear_stop(device);
+
+		return true;
+	}
+
+	if (is_watched(device, device->cpu->PC, WATCH_EXEC)) {
+		device->exit_reason = DEVICE_EXIT_BREAKPOINT;
+		device->stop_addr = device->cpu->PC;
+
+		return true;
+	}
+
+	if (device->profile) {
+		profile_count(device->profile, device->cpu->PC,
+			      ram_byte(device, device->cpu->PC),
+			      opdesc_length(&(device->cpu->opdesc[
+				ram_byte(device, device->cpu->PC)])));
+	}
+
+	return false;
+}
+
 void init_device(struct device_t* device, struct cpu_6502_t* cpu,
 		 uint16_t load_addr, uint16_t stack_addr, uint16_t ram_size) {
+	unsigned int i;
 
 	device->cpu = cpu;
 	device->load_addr = load_addr;
 	device->stack_addr = stack_addr;
-	device->peripherals = NULL;
 	device->num_of_peripherals = 0;
 	device->run_device = NULL;
 	device->data = NULL;
 	device->read = NULL;
 	device->write = NULL;
 	device->error = 0;
+	device->cycles = 0;
+	device->instr_count = 0;
+	device->exit_reason = DEVICE_EXIT_NONE;
+	device->stop_reason = DEVICE_EXIT_NONE;
+	device->stop_addr = 0;
+	atomic_init(&device->interrupt, false);
+	device->deadline = DEVICE_NO_DEADLINE;
+	device->safeguard = 0;
+	device->replay = NULL;
+	device->profile = NULL;
+	device->aot = NULL;
+	device->mapper = NULL;
+	device->rom_policy = ROM_WRITES_DROP;
+	device->irq = 0;
+	device_reset_idle(device);
+
+	for (i = 0; i < DEVICE_MAX_EVENTS; i++)
+		device->events[i].fire = NULL;
+
+	if (ram_size < DEVICE_MIN_RAM_SIZE) {
+		logd_err("RAM size %.4x does not cover the zero page and "
+			 "the stack, using %.4x.", ram_size,
+			 DEVICE_MIN_RAM_SIZE);
+		ram_size = DEVICE_MIN_RAM_SIZE;
+	}
 
 	device->ram.ram_size = ram_size;
+	device->ram.end_page = PAGE_COUNT;
+
+	/* RAM covers whole pages; the rest is left to the peripherals */
+	for (i = 0; i < PAGE_COUNT; i++) {
+		device->ram.pages[i] = (uint8_t*)ram_zero_page;
+		device->ram.watch[i] = NULL;
+		device->ram.page_flags[i] = 0;
+		device->ram.page_attr[i] = i * PAGE_SIZE < ram_size
+					   ? PAGE_RAM : PAGE_MMIO;
+		update_page_flags(device, i);
+	}
+
+	return;
+}
+
+void free_device(struct device_t* device) {
+	struct mapper_t* mapper;
+	unsigned int i;
+
+	replay_close(device);
+
+	free_profile(device->profile);
+	device->profile = NULL;
+
+	for (i = 0; i < PAGE_COUNT; i++) {
+		if (device->ram.watch[i]) {
+			free(device->ram.watch[i]);
+			device->ram.watch[i] = NULL;
+		}
+
+		if (page_allocated(device, i) && !page_mapped(device, i))
+			free(device->ram.pages[i]);
+
+		device->ram.pages[i] = (uint8_t*)ram_zero_page;
+		device->ram.page_flags[i] &= ~(PAGE_MAPPED | PAGE_READ_ONLY);
+	}
+
+	if (device->mapper) {
+		mapper = device->mapper;
+
+		for (i = 0; i < mapper->num_devices; i++)
+			if (mapper->devices[i] == device)
+				break;
+
+		if (i < mapper->num_devices)
+			mapper->devices[i] = mapper->devices[
+						--mapper->num_devices];
+
+		device->mapper = NULL;
+	}
+
+	for (i = 0; i < device->num_of_peripherals; i++)
+		if (device->peripherals[i]->device == device)
+			device->peripherals[i]->device = NULL;
+
+	device->num_of_peripherals = 0;
+	device->irq = 0;
 
 	return;
 }
@@ -57,8 +1129,18 @@ int load_to_ram(struct device_t* device, uint16_t load_addr,
 		bool binary) {
 	unsigned int i;
 
+	/* images go into ROM as well, but not into a shared one */
 	for (i = 0; i < data_size; i++) {
-		device_write(device, (uint16_t)i + load_addr, data[i]);
+		if (page_read_only(device, get_page_num(i + load_addr))) {
+			logd_err("Cannot load over the ROM image at %.4x.",
+				 (uint16_t)i + load_addr);
+			return DEVICE_ROM_WRITE;
+		}
+
+		if (page_attr(device, get_page_num(i + load_addr)) == PAGE_ROM)
+			device_poke(device, (uint16_t)i + load_addr, data[i]);
+		else
+			device_write(device, (uint16_t)i + load_addr, data[i]);
 		if (device->error) {
 			logd_err("Error loading data to RAM (addr: %.4x).",
 				 (uint16_t)i + load_addr);
@@ -73,36 +1155,237 @@ int load_to_ram(struct device_t* device, uint16_t load_addr,
 }
 
 #define instr_length(device, opc) \
-	(device)->cpu->instr_map[opc].subinstr->length
+	opdesc_length(&((device)->cpu->opdesc[opc]))
 
 #define instr_cycles(device, opc) \
-	(device)->cpu->instr_map[opc].subinstr->cycles
+	opdesc_cycles(&((device)->cpu->opdesc[opc]))
+
+/* a branch taken costs a cycle, and another if it lands on another page
+ * than the instruction after it; taken backwards, it may close an idle
+ * loop like a jump back */
+static inline int take_branch(struct device_t* device, uint16_t next,
+			      cpu_regs_t* regs) {
+
+	device->cycles += 1 + (((next ^ regs->PC) & 0xFF00) != 0);
+
+	return regs->PC < next ? DEVICE_JUMP_BACK : 0;
+}
+
+static inline uint16_t fetch_arg(struct device_t* device,
+				 const opdesc_t* op, uint16_t addr) {
+
+	switch (opdesc_length(op)) {
+	case 2:
+		return (uint16_t)ram_byte(device, addr);
+	case 3:
+		return (uint16_t)ram_byte(device, addr)
+		     | (uint16_t)ram_byte(device, (uint16_t)(addr + 1)) << 8;
+	default:
+		return 0;
+	}
+}
+
+/* a branch taken or a page crossed by the (last) instruction run */
+static inline int finish_instr(struct device_t* device, const opdesc_t* op,
+			       uint16_t next, cpu_regs_t* regs, int ret) {
 
-#define instr_mode(device, opc) \
-	((device)->cpu->instr_map[opc].subinstr->mode & 0xFF)
+	if (ret == DEVICE_NEED_EXTRA_CYCLE && opdesc_extra(op))
+		device->cycles++;
+	else if (ret == DEVICE_TAKE_BRANCH)
+		ret = take_branch(device, next, regs);
 
-#define run_action(device, opc, arg, data) \
-	device->cpu->instr_map[opc].instr->action( \
-		device->cpu->instr_map[opc].subinstr, arg, data)
+	return ret;
+}
 
-typedef union {
+/* runs the instruction whose opcode was just fetched */
+static inline int exec_instr(struct device_t* device, const opdesc_t* op,
+			     cpu_regs_t* regs) {
+	uint16_t next;
 	uint16_t arg;
-	uint8_t mem[2];
-} arg_conv_t;
+	int ret;
 
-int run_device(struct device_t* device,
-	       bool end_on_last_instr,
-	       cpu_dump_mode_t cpu_dump_mode,
-	       struct mem_region_t* mrhead) {
+	arg = fetch_arg(device, op, regs->PC);
+	next = (uint16_t)(regs->PC + opdesc_length(op) - 1);
+	regs->PC = next;
+
+	ret = device->cpu->actions[op->handler](op, arg, regs, (void*)device);
+
+	device->instr_count++;
+	device->cycles += opdesc_cycles(op);
+
+	return finish_instr(device, op, next, regs, ret);
+}
+
+#define fused_addr(regs, fuse, i) \
+	((uint16_t)((regs)->PC - 1 + (fuse)->offsets[i]))
+
+/* the sequence can only run as one if nothing needs the loop in
+ * between: a stop or breakpoint, a due event or the last instruction */
+static inline bool can_fuse(struct device_t* device, fuse_map_t* fuse,
+			    cpu_regs_t* regs, bool end_on_last_instr) {
+	uint16_t addr;
+	unsigned int i;
+
+	addr = regs->PC;
+
+	for (i = 1; i < fuse->count; i++) {
+		addr = fused_addr(regs, fuse, i);
+
+		if (ram_byte(device, addr) != fuse->opcodes[i]
+		 || (device->ram.page_flags[get_page_num(addr)]
+		     & (PAGE_SLOW_EXEC | PAGE_STOP)))
+			return false;
+	}
+
+	return device->cycles + fuse->lead_cycles < device->deadline
+	    && (!end_on_last_instr || addr < device->ram.end_instr);
+}
+
+/* one dispatch for the whole sequence; as only the last instruction
+ * may touch memory or branch, it is the only one that can stop the run
+ * or need a cycle more */
+static inline int exec_fused(struct device_t* device, fuse_map_t* fuse,
+			     cpu_regs_t* regs) {
+	uint16_t args[FUSED_MAX];
+	uint16_t next;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < fuse->count; i++)
+		args[i] = fetch_arg(device, fuse->ops[i],
+				    (uint16_t)(fused_addr(regs, fuse, i) + 1));
+
+	next = (uint16_t)(regs->PC - 1 + fuse->length);
+	regs->PC = next;
+
+	ret = fuse->action(fuse->ops, args, regs, (void*)device);
+
+	device->instr_count += fuse->count;
+	device->cycles += fuse->cycles;
+
+	return finish_instr(device, fuse->ops[fuse->count - 1], next, regs,
+			    ret);
+}
+
+/* between instructions, as the hardware does: PC and P go on the stack,
+ * P with B clear, and the handler runs with further IRQs masked */
+static void take_irq(struct device_t* device) {
+	cpu_6502_t* cpu;
+
+	cpu = device->cpu;
+
+	dtracei("Taking IRQ at %.4x (lines %.2x)", cpu->PC, device->irq);
+
+	device_push(device, cpu->S, (uint8_t)(cpu->PC >> 8));
+	device_push(device, cpu->S, (uint8_t)cpu->PC);
+	device_push(device, cpu->S, p_pushed(cpu->P, false));
+
+	set_I(cpu);
+
+	cpu->PC = device_read(device, IRQ_VECTOR)
+		| (uint16_t)device_read(device, IRQ_VECTOR + 1) << 8;
+
+	device->cycles += IRQ_CYCLES;
+
+	/* RTI comes back to the loop with the same registers */
+	device_reset_idle(device);
+
+	return;
+}
+
+static const char* exit_reason_names[] = {
+	[DEVICE_EXIT_NONE] = "none",
+	[DEVICE_EXIT_LAST_INSTR] = "last_instr",
+	[DEVICE_EXIT_SAFEGUARD] = "safeguard",
+	[DEVICE_EXIT_ERROR] = "error",
+	[DEVICE_EXIT_BREAKPOINT] = "breakpoint",
+	[DEVICE_EXIT_WATCHPOINT] = "watchpoint",
+	[DEVICE_EXIT_STEP] = "step",
+	[DEVICE_EXIT_INTERRUPT] = "interrupt",
+	[DEVICE_EXIT_SEEK] = "seek",
+	[DEVICE_EXIT_REPLAY_END] = "replay_end",
+	[DEVICE_EXIT_IDLE] = "idle",
+	[DEVICE_EXIT_SLICE] = "slice",
+	[DEVICE_EXIT_INSTR_LIMIT] = "instr_limit"
+};
+
+const char* get_exit_reason_name(device_exit_t exit_reason) {
+
+	if (exit_reason >= sizeof(exit_reason_names)
+			 / sizeof(*exit_reason_names))
+		return "unknown";
+
+	return exit_reason_names[exit_reason];
+}
+
+/* no instruction takes fewer cycles than this, so a limit of n more
+ * instructions cannot be reached in fewer than n times as many cycles */
+#define DEVICE_MIN_INSTR_CYCLES 2
+
+/* instructions are not counted against the deadline: a limit on them
+ * is checked on the first cycle it could have been reached on, and
+ * from there on the next one, so the run loop pays nothing for it */
+#define instr_limit_cycle(device, limit) \
+	((device)->cycles + ((limit) - (device)->instr_count) \
+			    * DEVICE_MIN_INSTR_CYCLES)
+
+/* passive, so an idle loop still ends the run rather than the
+ * safeguard, and one that waits for an event is skipped past it */
+static void check_safeguard(struct device_t* device, void* data) {
+
+	if (device->instr_count >= device->safeguard) {
+		dtracei("Reached safeguard (%llu instructions)!",
+			(unsigned long long)device->safeguard);
+		device_request_stop(device, DEVICE_EXIT_SAFEGUARD,
+				    device->cpu->PC);
+		return;
+	}
+
+	device_schedule_passive(device,
+				instr_limit_cycle(device, device->safeguard),
+				check_safeguard, NULL);
+
+	return;
+}
+
+void start_device(struct device_t* device) {
+
+	start_cpu(device->cpu, device->load_addr, device->stack_addr);
+
+	device->cycles = 0;
+	device->instr_count = 0;
+	device->exit_reason = DEVICE_EXIT_NONE;
+
+	device_unschedule(device, check_safeguard, NULL);
+	if (device->safeguard
+	 && device_schedule_passive(device,
+				    instr_limit_cycle(device, device->safeguard),
+				    check_safeguard, NULL) < 0)
+		logd_err("Running without safeguard.");
+
+	if (device->replay)
+		replay_start(device);
+
+	return;
+}
+
+/* runs from the current state until something stops the device; with
+ * resume set, a stop pending on the first instruction is ignored so a
+ * debugger can continue from a breakpoint
+ *
+ * registers live in regs for the whole run and are only written back
+ * to the CPU for whatever looks at it: stops, events, IRQs, idle
+ * checks and compiled code */
+int exec_device(struct device_t* device, bool end_on_last_instr,
+		bool resume) {
+	cpu_regs_t regs;
 	int ret;
-	uint16_t arg;
 	uint8_t byte;
+	uint8_t flags;
+	fuse_map_t* fuse;
 #ifdef DEVICE_TRACE
 	char name[4] = { 0 };
 #endif
-#ifdef DEVICE_SAFEGUARD
-	int safeguard;
-#endif
 
 #ifdef CLOCK_TRACE
 	struct timespec cycle_start;
@@ -114,66 +1397,105 @@ int run_device(struct device_t* device,
 	if (end_on_last_instr)
 		dtracei("Ending on %.4x", device->ram.end_instr);
 
-#ifdef DEVICE_SAFEGUARD
-	safeguard = DEVICE_SAFEGUARD;
-#endif
-	if (!device->cpu) {
-		logd_err("Please plug CPU into device.");
+	mark_end_pages(device, end_on_last_instr
+			       ? get_page_num(device->ram.end_instr)
+			       : PAGE_COUNT);
 
-		return DEVICE_NO_CPU_ERROR;
-	}
+	device->exit_reason = DEVICE_EXIT_NONE;
+	device_reset_idle(device);
 
-	start_cpu(device->cpu, device->load_addr, device->stack_addr);
+	cpu_load_regs(regs, device->cpu);
 
 	while (true) {
 #ifdef CLOCK_TRACE
 		timespec_get(&cycle_start, TIME_UTC);
 #endif
 
-		if ((end_on_last_instr)
-		 && (device->cpu->PC >= device->ram.end_instr)) {
-			dtracei("Reached last instruction "
-				"(PC=%.4x)", device->cpu->PC);
-			break;
+		/* the end of the binary, stops and breakpoints all cost a
+		 * single test on pages that have none of them */
+		flags = device->ram.page_flags[get_page_num(regs.PC)];
+
+		if (flags & (PAGE_SLOW_EXEC | PAGE_STOP | PAGE_END)) {
+			if ((flags & PAGE_END)
+			 && regs.PC >= device->ram.end_instr) {
+				dtracei("Reached last instruction "
+					"(PC=%.4x)", regs.PC);
+				device->exit_reason = DEVICE_EXIT_LAST_INSTR;
+				break;
+			}
+
+			if ((flags & (PAGE_SLOW_EXEC | PAGE_STOP)) && !resume) {
+				cpu_store_regs(device->cpu, regs);
+
+				if (check_exec_stop(device)) {
+					dtracei("Stopped on %s at %.4x "
+						"(PC=%.4x)",
+						get_exit_reason_name(
+							device->exit_reason),
+						device->stop_addr, regs.PC);
+					break;
+				}
+			}
 		}
 
-#ifdef DEVICE_SAFEGUARD
-		if (!(--safeguard)) {
-			dtracei("Reached safeguard (%d cycles)!",
-				DEVICE_SAFEGUARD);
-			break;
+		resume = false;
+
+		if (device->aot) {
+			cpu_store_regs(device->cpu, regs);
+			ret = device->aot->run(device, end_on_last_instr);
+			cpu_load_regs(regs, device->cpu);
+
+			if (ret != DEVICE_AOT_MISS) {
+				dtracei("Ran compiled code up to %.4x", regs.PC);
+				goto exec_done;
+			}
 		}
-#endif
-		byte = device->ram.ram[device->cpu->PC++];
+
+		byte = ram_byte(device, regs.PC);
+		regs.PC++;
 
 #ifdef DEVICE_TRACE
-		memcpy(name, device->cpu->instr_map[byte].instr->name, 3);
-		dtracei("Fetching instruction at %.4x", device->cpu->PC - 1);
+		memcpy(name, opdesc_name(&(device->cpu->opdesc[byte])), 3);
+		dtracei("Fetching instruction at %.4x", regs.PC - 1);
 		dtrace("opcode: %.2x", byte);
 		dtrace("name: %s", name);
 		dtrace("length: %d", instr_length(device, byte));
 		dtrace("cycles: %d", instr_cycles(device, byte));
 #endif
 
-		switch (instr_length(device, byte)) {
-		case 1:
-			arg = 0;
-			break;
-		case 2:
-			arg = (uint16_t)device->ram.ram[device->cpu->PC++];
-			break;
-		case 3:
-			arg = ((arg_conv_t*)
-			     (&(device->ram.ram[device->cpu->PC])))->arg;
-			device->cpu->PC += 2;
-			break;
-		default:
-			break;
+		fuse = &(device->cpu->fuse_map[byte]);
+
+		if (IS_FUSED(fuse)
+		 && can_fuse(device, fuse, &regs, end_on_last_instr)) {
+			dtrace("fused: %u instructions", fuse->count);
+			ret = exec_fused(device, fuse, &regs);
+		}
+		else
+			ret = exec_instr(device, &(device->cpu->opdesc[byte]),
+					 &regs);
+
+exec_done:
+		if (ret) {
+			if (ret < 0) {
+				device->exit_reason = DEVICE_EXIT_ERROR;
+				break;
+			}
+
+			if (ret == DEVICE_JUMP_BACK) {
+				cpu_store_regs(device->cpu, regs);
+				if (check_idle(device))
+					break;
+			}
 		}
 
-		ret = run_action(device, (opcode_t)byte, arg, (void*)device);
-		if (ret == DEVICE_NEED_EXTRA_CYCLE) {
-			printf("Need extra");
+		if (device->cycles >= device->deadline) {
+			cpu_store_regs(device->cpu, regs);
+			run_events(device);
+
+			if (device->irq && !get_I(device->cpu))
+				take_irq(device);
+
+			cpu_load_regs(regs, device->cpu);
 		}
 
 #ifdef CLOCK_TRACE
@@ -186,22 +1508,147 @@ int run_device(struct device_t* device,
 #endif
 	}
 
+	cpu_store_regs(device->cpu, regs);
+
+	if (device->exit_reason == DEVICE_EXIT_ERROR && ret >= 0)
+		ret = device->error;
+	else if (ret > 0)
+		ret = 0;	/* hints from actions are not results */
+
+	return ret;
+}
+
+int run_device(struct device_t* device,
+	       bool end_on_last_instr,
+	       const result_opts_t* ropts) {
+	int ret;
+
+	if (!device->cpu) {
+		logd_err("Please plug CPU into device.");
+
+		return DEVICE_NO_CPU_ERROR;
+	}
+
+	start_device(device);
+
+	ret = exec_device(device, end_on_last_instr, false);
+
+	report_device(device, ret, ropts);
+
+	return ret;
+}
+
+static void end_slice(struct device_t* device, void* data) {
+
+	device_request_stop(device, DEVICE_EXIT_SLICE, device->cpu->PC);
+
+	return;
+}
+
+static void check_instr_limit(struct device_t* device, void* data) {
+	uint64_t limit;
+
+	limit = *(uint64_t*)data;
+
+	if (device->instr_count >= limit) {
+		device_request_stop(device, DEVICE_EXIT_INSTR_LIMIT,
+				    device->cpu->PC);
+		return;
+	}
+
+	/* the slot it fired from is free, so this cannot fail */
+	device_schedule(device, instr_limit_cycle(device, limit),
+			check_instr_limit, data);
+
+	return;
+}
+
+/* runs a started device for at most about max_cycles cycles and
+ * max_instrs instructions (0 for no limit) and returns why it stopped:
+ * DEVICE_EXIT_SLICE or DEVICE_EXIT_INSTR_LIMIT when a budget ran out,
+ * and the device can be run again from there; the result of the run
+ * is in ret
+ *
+ * a budget runs out on an instruction boundary, so the cycles can go
+ * past it by part of an instruction, or both by part of an idle loop
+ * pass that was skipped; a device stopped on a breakpoint runs past it */
+device_exit_t device_run_slice(struct device_t* device, uint64_t max_cycles,
+			       uint64_t max_instrs, bool end_on_last_instr,
+			       int* ret) {
+	uint64_t instr_limit;
+	bool resume;
+
+	resume = device->exit_reason == DEVICE_EXIT_BREAKPOINT;
+	instr_limit = device->instr_count + max_instrs;
+
+	*ret = 0;
+
+	if (max_cycles
+	 && (*ret = device_schedule(device, device->cycles + max_cycles,
+				    end_slice, device)) < 0)
+		goto exit_run_slice;
+
+	if (max_instrs
+	 && (*ret = device_schedule(device,
+				    instr_limit_cycle(device, instr_limit),
+				    check_instr_limit, &instr_limit)) < 0)
+		goto exit_run_slice;
+
+	*ret = exec_device(device, end_on_last_instr, resume);
+
+exit_run_slice:
+
+	device_unschedule(device, end_slice, device);
+	device_unschedule(device, check_instr_limit, &instr_limit);
+
+	/* a budget that ran out as something else stopped the run is
+	 * not carried over to the next one */
+	if (device->stop_reason == DEVICE_EXIT_SLICE
+	 || device->stop_reason == DEVICE_EXIT_INSTR_LIMIT)
+		clear_stop(device);
+
+	if (*ret < 0)
+		device->exit_reason = DEVICE_EXIT_ERROR;
+
+	return device->exit_reason;
+}
+
+/* the run is over, so peripherals on threads are stopped first and
+ * whatever they hold comes out before the result */
+void report_device(struct device_t* device, int ret,
+		   const result_opts_t* ropts) {
+	unsigned int i;
+
+	for (i = 0; i < device->num_of_peripherals; i++)
+		periph_stop(device->peripherals[i]);
+
 	if (ret < 0)
 		logd_err("Cycle execution returned %d", ret);
-	else {
+	else
 		dtracei("Return value: %d", ret);
 
-		if (cpu_dump_mode != CPU_DUMP_NONE) {
+	if (ropts->format != RESULT_FORMAT_TEXT) {
+		dtracei("Dumping result...");
+		dump_result(device, ret, ropts);
+	}
+	else if (ret >= 0) {
+
+		if (ropts->cpu_dump_mode != CPU_DUMP_NONE) {
 			dtracei("Dumping CPU registers...");
-			dump_cpu(device->cpu, cpu_dump_mode);
+			dump_cpu(device->cpu, ropts->cpu_dump_mode);
 		}
 
-		if (mrhead) {
+		if (ropts->mrhead && !ropts->mem_raw_file) {
 			dtracei("Dumping memory...");
-			dump_mem(device, mrhead);
+			dump_mem(device, ropts->mrhead);
 		}
 	}
 
-	return ret;
+	if (ret >= 0 && ropts->mem_raw_file) {
+		dtracei("Dumping raw memory to %s...", ropts->mem_raw_file);
+		dump_mem_raw(device, ropts->mrhead, ropts->mem_raw_file);
+	}
+
+	return;
 }
 
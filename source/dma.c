@@ -0,0 +1,172 @@
+#include "dma.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+#define VSIG "DMA"
+
+#define logv_err(FMT, ...) log_err(VSIG, FMT, ## __VA_ARGS__)
+
+#ifdef DMA_TRACE
+#define vtracei(FMT, ...) tracei(VSIG, FMT, ## __VA_ARGS__)
+#else
+#define vtracei(FMT, ...) ;
+#endif
+
+#define dma_reg16(dma, reg) \
+	((dma)->regs[reg] | (uint16_t)(dma)->regs[(reg) + 1] << 8)
+
+#define dma_min(a, b) ((a) < (b) ? (a) : (b))
+
+/* in address order, so a block copied onto a later part of itself
+ * repeats its start, as it does on the hardware; addresses wrap */
+static void dma_copy(struct device_t* device, uint16_t dst, uint16_t src,
+		     unsigned int len) {
+	unsigned int count;
+	unsigned int i;
+	uint16_t from;
+	uint16_t to;
+	bool bytewise;
+
+	bytewise = dst != src && (uint16_t)(dst - src) < len;
+
+	while (len) {
+		count = dma_min(len, dma_min(PAGE_SIZE - (uint8_t)src,
+					     PAGE_SIZE - (uint8_t)dst));
+
+		if (!bytewise
+		 && !(device->ram.page_flags[get_page_num(src)]
+		      & PAGE_SLOW_READ)
+		 && !(device->ram.page_flags[get_page_num(dst)]
+		      & PAGE_SLOW_WRITE))
+			memmove(&ram_byte(device, dst), &ram_byte(device, src),
+				count);
+		else {
+			for (i = 0; i < count; i++) {
+				from = src + i;
+				to = dst + i;
+				device_write(device, to,
+					     device_read(device, from));
+			}
+		}
+
+		src += count;
+		dst += count;
+		len -= count;
+	}
+
+	return;
+}
+
+static uint8_t dma_read(struct peripheral_t* peripheral, uint16_t addr) {
+	struct dma_t* dma;
+
+	dma = peripheral->data;
+
+	return dma->regs[addr - peripheral->addr_start];
+}
+
+static void dma_write(struct peripheral_t* peripheral, uint16_t addr,
+		      uint8_t val) {
+	struct device_t* device;
+	struct dma_t* dma;
+	unsigned int len;
+
+	dma = peripheral->data;
+	device = peripheral->device;
+
+	switch (addr - peripheral->addr_start) {
+	case DMA_STATUS:
+		dma->regs[DMA_STATUS] = 0;
+		break;
+	case DMA_CONTROL:
+		dma->regs[DMA_CONTROL] = val & ~DMA_START;
+
+		if (!(val & DMA_START))
+			break;
+
+		len = dma_reg16(dma, DMA_LENGTH);
+
+		vtracei("Copying %u bytes from %.4x to %.4x.", len,
+			dma_reg16(dma, DMA_SOURCE), dma_reg16(dma, DMA_DEST));
+
+		dma_copy(device, dma_reg16(dma, DMA_DEST),
+			 dma_reg16(dma, DMA_SOURCE), len);
+
+		device->cycles += (uint64_t)len * DMA_BYTE_CYCLES;
+
+		dma->regs[DMA_STATUS] |= DMA_DONE;
+		break;
+	default:
+		dma->regs[addr - peripheral->addr_start] = val;
+		break;
+	}
+
+	device_set_irq(device, peripheral,
+		       (dma->regs[DMA_STATUS] & DMA_DONE)
+		       && (dma->regs[DMA_CONTROL] & DMA_IRQ));
+
+	return;
+}
+
+static void dma_save(struct peripheral_t* peripheral, uint8_t* state) {
+
+	memcpy(state, ((struct dma_t*)peripheral->data)->regs, DMA_REGS);
+
+	return;
+}
+
+static void dma_restore(struct peripheral_t* peripheral,
+			const uint8_t* state) {
+	struct dma_t* dma;
+
+	dma = peripheral->data;
+
+	memcpy(dma->regs, state, DMA_REGS);
+
+	device_set_irq(peripheral->device, peripheral,
+		       (dma->regs[DMA_STATUS] & DMA_DONE)
+		       && (dma->regs[DMA_CONTROL] & DMA_IRQ));
+
+	return;
+}
+
+struct dma_t* new_dma(uint16_t addr) {
+	struct dma_t* dma;
+
+	if (addr > MEM_MAX_ADDR - (DMA_REGS - 1)) {
+		logv_err("DMA at %.4x does not fit in memory.", addr);
+		return NULL;
+	}
+
+	dma = calloc(1, sizeof(*dma));
+	if (!dma) {
+		logv_err("Could not allocate DMA.");
+		return NULL;
+	}
+
+	dma->peripheral = (struct peripheral_t) {
+		.addr_start = addr,
+		.addr_end = addr + DMA_REGS - 1,
+		.read = dma_read,
+		.write = dma_write,
+		.state_size = DMA_REGS,
+		.save = dma_save,
+		.restore = dma_restore,
+		.data = dma
+	};
+
+	vtracei("DMA at %.4x.", addr);
+
+	return dma;
+}
+
+void free_dma(struct dma_t* dma) {
+
+	free(dma);
+
+	return;
+}
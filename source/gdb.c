@@ -0,0 +1,844 @@
+#include "gdb.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "common.h"
+#include "device.h"
+#include "replay.h"
+
+#define GSIG "GDB"
+
+#define logg_err(FMT, ...) log_err(GSIG, FMT, ## __VA_ARGS__)
+
+#ifdef GDB_TRACE
+#define gtrace(FMT, ...) trace(FMT, ## __VA_ARGS__)
+#define gtracei(FMT, ...) tracei(GSIG, FMT, ## __VA_ARGS__)
+#else
+#define gtrace(FMT, ...) ;
+#define gtracei(FMT, ...) ;
+#endif
+
+#define GDB_PACKET_SIZE 4096
+#define GDB_POLL_MS 100
+#define GDB_INTERRUPT 0x03
+
+/* largest m packet that still fits into a reply */
+#define GDB_MAX_MEM ((GDB_PACKET_SIZE - 4) / 2)
+
+typedef struct {
+	int fd;
+	bool no_ack;
+	bool end_on_last_instr;
+	bool done;
+	struct device_t* device;
+	atomic_bool running;
+	uint8_t rbuf[GDB_PACKET_SIZE];
+	unsigned int rlen;
+	unsigned int rpos;
+	char in[GDB_PACKET_SIZE + 1];
+	char out[GDB_PACKET_SIZE + 1];
+} gdb_t;
+
+/* ========= packet I/O ========= */
+
+static int gdb_getc(gdb_t* gdb) {
+	ssize_t ret;
+
+	if (gdb->rpos == gdb->rlen) {
+		do {
+			ret = recv(gdb->fd, gdb->rbuf, sizeof(gdb->rbuf), 0);
+		} while (ret < 0 && errno == EINTR);
+
+		if (ret <= 0)
+			return -1;
+
+		gdb->rlen = ret;
+		gdb->rpos = 0;
+	}
+
+	return gdb->rbuf[gdb->rpos++];
+}
+
+static int gdb_write(gdb_t* gdb, const char* data, size_t len) {
+	ssize_t ret;
+
+	while (len) {
+		ret = send(gdb->fd, data, len, 0);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+
+			logg_err("Could not send data (%s).", strerror(errno));
+			return -1;
+		}
+
+		data += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+static int hex_val(int c) {
+
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+
+	return -1;
+}
+
+/* reads the next packet into gdb->in, returns its length or -1 */
+static int gdb_recv_packet(gdb_t* gdb) {
+	unsigned int len;
+	uint8_t sum;
+	int c, hi, lo;
+
+	while (true) {
+
+		do {
+			c = gdb_getc(gdb);
+			if (c < 0)
+				return -1;
+		} while (c != '$');
+
+		len = 0;
+		sum = 0;
+
+		while ((c = gdb_getc(gdb)) != '#') {
+			if (c < 0)
+				return -1;
+
+			if (len == GDB_PACKET_SIZE) {
+				logg_err("Packet too long.");
+				return -1;
+			}
+
+			gdb->in[len++] = c;
+			sum += c;
+		}
+
+		gdb->in[len] = '\0';
+
+		hi = hex_val(gdb_getc(gdb));
+		lo = hex_val(gdb_getc(gdb));
+
+		if (gdb->no_ack)
+			return len;
+
+		if (hi >= 0 && lo >= 0 && ((hi << 4) | lo) == sum) {
+			if (gdb_write(gdb, "+", 1))
+				return -1;
+
+			return len;
+		}
+
+		gtrace("Bad checksum, requesting retransmission.");
+
+		if (gdb_write(gdb, "-", 1))
+			return -1;
+	}
+}
+
+static int gdb_send_packet(gdb_t* gdb, const char* data) {
+	char trailer[4];
+	uint8_t sum;
+	size_t len;
+	size_t i;
+	int c;
+
+	len = strlen(data);
+	sum = 0;
+
+	for (i = 0; i < len; i++)
+		sum += (uint8_t)data[i];
+
+	snprintf(trailer, sizeof(trailer), "#%.2x", sum);
+
+	gtrace("Sending: %s", data);
+
+	while (true) {
+		if (gdb_write(gdb, "$", 1)
+		 || gdb_write(gdb, data, len)
+		 || gdb_write(gdb, trailer, 3))
+			return -1;
+
+		if (gdb->no_ack)
+			return 0;
+
+		do {
+			c = gdb_getc(gdb);
+			if (c < 0)
+				return -1;
+		} while (c != '+' && c != '-');
+
+		if (c == '+')
+			return 0;
+	}
+}
+
+/* ========= argument parsing ========= */
+
+static const char* parse_hex(const char* str, unsigned int* val) {
+	int digit;
+
+	*val = 0;
+
+	if (hex_val(*str) < 0)
+		return NULL;
+
+	while ((digit = hex_val(*str)) >= 0) {
+		*val = (*val << 4) | digit;
+		str++;
+	}
+
+	return str;
+}
+
+static const char* parse_hex_bytes(const char* str, uint8_t* out,
+				   unsigned int len) {
+	unsigned int i;
+	int hi, lo;
+
+	for (i = 0; i < len; i++) {
+		hi = hex_val(str[2 * i]);
+		lo = hi < 0 ? -1 : hex_val(str[2 * i + 1]);
+
+		if (lo < 0)
+			return NULL;
+
+		out[i] = (hi << 4) | lo;
+	}
+
+	return str + 2 * len;
+}
+
+/* ========= commands ========= */
+
+static void gdb_stop_reply(gdb_t* gdb) {
+	struct device_t* device;
+
+	device = gdb->device;
+
+	switch (device->exit_reason) {
+	case DEVICE_EXIT_LAST_INSTR:
+		strcpy(gdb->out, "W00");
+		break;
+	case DEVICE_EXIT_WATCHPOINT:
+		sprintf(gdb->out, "T05awatch:%x;", device->stop_addr);
+		break;
+	case DEVICE_EXIT_INTERRUPT:
+		strcpy(gdb->out, "S02");
+		break;
+	case DEVICE_EXIT_ERROR:
+		strcpy(gdb->out, device->error == DEVICE_INVALID_ADDR
+				 ? "S0b" : "S04");
+		break;
+	default:
+		strcpy(gdb->out, "S05");
+		break;
+	}
+
+	return;
+}
+
+static void gdb_read_regs(gdb_t* gdb) {
+	cpu_6502_t* cpu;
+
+	cpu = gdb->device->cpu;
+
+	sprintf(gdb->out, "%.2x%.2x%.2x%.2x%.2x%.2x%.2x",
+		cpu->A, cpu->X, cpu->Y, cpu->S, cpu->P,
+		cpu->PC & 0xFF, cpu->PC >> 8);
+
+	return;
+}
+
+static void gdb_write_regs(gdb_t* gdb, const char* args) {
+	cpu_6502_t* cpu;
+	uint8_t regs[7];
+
+	cpu = gdb->device->cpu;
+
+	if (!parse_hex_bytes(args, regs, sizeof(regs))) {
+		strcpy(gdb->out, "E01");
+		return;
+	}
+
+	cpu->A = regs[0];
+	cpu->X = regs[1];
+	cpu->Y = regs[2];
+	cpu->S = regs[3];
+	cpu->P = regs[4];
+	cpu->PC = regs[5] | ((uint16_t)regs[6] << 8);
+
+	strcpy(gdb->out, "OK");
+
+	return;
+}
+
+static uint8_t* gdb_reg_ptr(cpu_6502_t* cpu, unsigned int reg) {
+
+	switch (reg) {
+	case GDB_REG_A:
+		return &(cpu->A);
+	case GDB_REG_X:
+		return &(cpu->X);
+	case GDB_REG_Y:
+		return &(cpu->Y);
+	case GDB_REG_S:
+		return &(cpu->S);
+	case GDB_REG_P:
+		return &(cpu->P);
+	default:
+		return NULL;
+	}
+}
+
+static void gdb_read_reg(gdb_t* gdb, const char* args) {
+	cpu_6502_t* cpu;
+	unsigned int reg;
+	uint8_t* ptr;
+
+	cpu = gdb->device->cpu;
+
+	if (!parse_hex(args, &reg)) {
+		strcpy(gdb->out, "E01");
+		return;
+	}
+
+	if (reg == GDB_REG_PC)
+		sprintf(gdb->out, "%.2x%.2x", cpu->PC & 0xFF, cpu->PC >> 8);
+	else if ((ptr = gdb_reg_ptr(cpu, reg)))
+		sprintf(gdb->out, "%.2x", *ptr);
+	else
+		strcpy(gdb->out, "E01");
+
+	return;
+}
+
+static void gdb_write_reg(gdb_t* gdb, const char* args) {
+	cpu_6502_t* cpu;
+	unsigned int reg;
+	uint8_t val[2];
+	uint8_t* ptr;
+
+	cpu = gdb->device->cpu;
+
+	args = parse_hex(args, &reg);
+	if (!args || *(args++) != '=') {
+		strcpy(gdb->out, "E01");
+		return;
+	}
+
+	if (reg == GDB_REG_PC && parse_hex_bytes(args, val, 2))
+		cpu->PC = val[0] | ((uint16_t)val[1] << 8);
+	else if ((ptr = gdb_reg_ptr(cpu, reg)) && parse_hex_bytes(args, val, 1))
+		*ptr = val[0];
+	else {
+		strcpy(gdb->out, "E01");
+		return;
+	}
+
+	strcpy(gdb->out, "OK");
+
+	return;
+}
+
+static void gdb_read_mem(gdb_t* gdb, const char* args) {
+	uint8_t buff[GDB_MAX_MEM];
+	unsigned int addr;
+	unsigned int len;
+	unsigned int i;
+
+	args = parse_hex(args, &addr);
+	if (!args || *(args++) != ',' || !parse_hex(args, &len)) {
+		strcpy(gdb->out, "E01");
+		return;
+	}
+
+	if (len > GDB_MAX_MEM)
+		len = GDB_MAX_MEM;
+
+	if (addr + len > MEM_MAX_ADDR + 1)
+		len = addr > MEM_MAX_ADDR ? 0 : MEM_MAX_ADDR + 1 - addr;
+
+	for (i = 0; i < len; i++)
+		buff[i] = device_peek(gdb->device, addr + i);
+
+	gdb->out[format_hex_str(gdb->out, buff, len)] = '\0';
+
+	return;
+}
+
+static void gdb_write_mem(gdb_t* gdb, const char* args) {
+	uint8_t buff[GDB_MAX_MEM];
+	unsigned int addr;
+	unsigned int len;
+	unsigned int i;
+
+	args = parse_hex(args, &addr);
+	if (!args || *(args++) != ',')
+		goto write_mem_error;
+
+	args = parse_hex(args, &len);
+	if (!args || *(args++) != ':' || len > GDB_MAX_MEM
+	 || addr + len > MEM_MAX_ADDR + 1)
+		goto write_mem_error;
+
+	if (!parse_hex_bytes(args, buff, len))
+		goto write_mem_error;
+
+	for (i = 0; i < len; i++)
+		device_poke(gdb->device, addr + i, buff[i]);
+
+	strcpy(gdb->out, "OK");
+
+	return;
+
+write_mem_error:
+
+	strcpy(gdb->out, "E01");
+
+	return;
+}
+
+static uint8_t gdb_watch_kind(unsigned int type) {
+
+	switch (type) {
+	case 0: /* software breakpoint */
+	case 1: /* hardware breakpoint */
+		return WATCH_EXEC;
+	case 2:
+		return WATCH_WRITE;
+	case 3:
+		return WATCH_READ;
+	case 4:
+		return WATCH_READ | WATCH_WRITE;
+	default:
+		return 0;
+	}
+}
+
+static void gdb_set_watch(gdb_t* gdb, const char* args, bool insert) {
+	unsigned int type;
+	unsigned int addr;
+	unsigned int len;
+	unsigned int i;
+	uint8_t kind;
+
+	args = parse_hex(args, &type);
+	if (!args || *(args++) != ',')
+		goto set_watch_error;
+
+	args = parse_hex(args, &addr);
+	if (!args || *(args++) != ',' || !parse_hex(args, &len))
+		goto set_watch_error;
+
+	kind = gdb_watch_kind(type);
+	if (!kind) {
+		/* unsupported type */
+		gdb->out[0] = '\0';
+		return;
+	}
+
+	/* for breakpoints, length is the instruction kind */
+	if (kind == WATCH_EXEC || !len)
+		len = 1;
+
+	for (i = 0; i < len && addr + i <= MEM_MAX_ADDR; i++) {
+		if (!insert)
+			device_clear_watch(gdb->device, addr + i, kind);
+		else if (device_set_watch(gdb->device, addr + i, kind))
+			goto set_watch_error;
+	}
+
+	strcpy(gdb->out, "OK");
+
+	return;
+
+set_watch_error:
+
+	strcpy(gdb->out, "E01");
+
+	return;
+}
+
+/* while the device runs, a helper thread reads from the client and
+ * interrupts the device on an interrupt (or a hang-up); anything else
+ * is kept in rbuf, which only this thread touches until it is joined,
+ * for when the device stops; the interpreter never looks at the socket */
+static void* gdb_interrupt_thread(void* data) {
+	struct pollfd pfd;
+	gdb_t* gdb;
+	unsigned int kept;
+	bool interrupt;
+	ssize_t ret;
+	ssize_t i;
+
+	gdb = (gdb_t*)data;
+	pfd.fd = gdb->fd;
+	pfd.events = POLLIN;
+	interrupt = false;
+
+	while (!interrupt && atomic_load(&gdb->running)) {
+
+		if (gdb->rpos) {
+			memmove(gdb->rbuf, gdb->rbuf + gdb->rpos,
+				gdb->rlen - gdb->rpos);
+			gdb->rlen -= gdb->rpos;
+			gdb->rpos = 0;
+		}
+
+		/* nowhere to keep more, so wait for the device to stop */
+		if (gdb->rlen == sizeof(gdb->rbuf)) {
+			poll(NULL, 0, GDB_POLL_MS);
+			continue;
+		}
+
+		if (poll(&pfd, 1, GDB_POLL_MS) <= 0)
+			continue;
+
+		ret = recv(gdb->fd, gdb->rbuf + gdb->rlen,
+			   sizeof(gdb->rbuf) - gdb->rlen, 0);
+		if (ret < 0 && errno == EINTR)
+			continue;
+
+		if (ret <= 0) {
+			gdb->done = true;
+			interrupt = true;
+			break;
+		}
+
+		for (i = 0, kept = 0; i < ret; i++) {
+			if (gdb->rbuf[gdb->rlen + i] == GDB_INTERRUPT)
+				interrupt = true;
+			else
+				gdb->rbuf[gdb->rlen + kept++] =
+					gdb->rbuf[gdb->rlen + i];
+		}
+
+		gdb->rlen += kept;
+	}
+
+	if (interrupt)
+		device_interrupt(gdb->device);
+
+	return NULL;
+}
+
+static void gdb_resume(gdb_t* gdb, const char* args, bool step) {
+	pthread_t thread;
+	unsigned int addr;
+	unsigned int kept;
+	unsigned int i;
+	bool interrupt;
+
+	if (parse_hex(args, &addr))
+		gdb->device->cpu->PC = addr;
+
+	if (step) {
+		device_request_stop(gdb->device, DEVICE_EXIT_STEP,
+				    gdb->device->cpu->PC);
+		exec_device(gdb->device, gdb->end_on_last_instr, true);
+		gdb_stop_reply(gdb);
+		return;
+	}
+
+	/* an interrupt may already be waiting in the buffer, among other
+	 * bytes that are kept for later */
+	for (i = gdb->rpos, kept = gdb->rpos; i < gdb->rlen; i++) {
+		if (gdb->rbuf[i] == GDB_INTERRUPT)
+			device_request_stop(gdb->device, DEVICE_EXIT_INTERRUPT,
+					    gdb->device->cpu->PC);
+		else
+			gdb->rbuf[kept++] = gdb->rbuf[i];
+	}
+
+	gdb->rlen = kept;
+
+	atomic_store(&gdb->running, true);
+
+	interrupt = !pthread_create(&thread, NULL, gdb_interrupt_thread, gdb);
+	if (!interrupt)
+		logg_err("Could not start interrupt thread, "
+			 "continuing without interrupts.");
+
+	gtracei("Continuing from %.4x", gdb->device->cpu->PC);
+
+	exec_device(gdb->device, gdb->end_on_last_instr, true);
+
+	atomic_store(&gdb->running, false);
+
+	if (interrupt)
+		pthread_join(thread, NULL);
+
+	gtracei("Stopped (%s) at %.4x",
+		get_exit_reason_name(gdb->device->exit_reason),
+		gdb->device->cpu->PC);
+
+	gdb_stop_reply(gdb);
+
+	return;
+}
+
+/* stepping back replays from the nearest checkpoint, so it is only
+ * available when running from a journal */
+static void gdb_reverse_step(gdb_t* gdb) {
+
+	if (!replay_playing(gdb->device))
+		return;
+
+	if (!gdb->device->instr_count) {
+		strcpy(gdb->out, "E01");
+		return;
+	}
+
+	gtracei("Stepping back from instruction %llu",
+		(unsigned long long)gdb->device->instr_count);
+
+	replay_seek(gdb->device, gdb->device->instr_count - 1,
+		    gdb->end_on_last_instr);
+
+	gdb_stop_reply(gdb);
+
+	return;
+}
+
+static void gdb_query(gdb_t* gdb, const char* query) {
+
+	if (!strncmp(query, "Supported", 9))
+		sprintf(gdb->out, "PacketSize=%x;QStartNoAckMode+%s",
+			GDB_PACKET_SIZE, replay_playing(gdb->device)
+					 ? ";ReverseStep+" : "");
+	else if (!strcmp(query, "Attached"))
+		strcpy(gdb->out, "1");
+	else if (!strcmp(query, "C"))
+		strcpy(gdb->out, "QC1");
+	else if (!strcmp(query, "fThreadInfo"))
+		strcpy(gdb->out, "m1");
+	else if (!strcmp(query, "sThreadInfo"))
+		strcpy(gdb->out, "l");
+	else
+		gdb->out[0] = '\0';
+
+	return;
+}
+
+/* returns false when the session should end */
+static bool gdb_handle_packet(gdb_t* gdb) {
+	bool start_no_ack;
+
+	gtracei("Received: %s", gdb->in);
+
+	start_no_ack = false;
+	gdb->out[0] = '\0';
+
+	switch (gdb->in[0]) {
+	case '?':
+		gdb_stop_reply(gdb);
+		break;
+	case 'g':
+		gdb_read_regs(gdb);
+		break;
+	case 'G':
+		gdb_write_regs(gdb, gdb->in + 1);
+		break;
+	case 'p':
+		gdb_read_reg(gdb, gdb->in + 1);
+		break;
+	case 'P':
+		gdb_write_reg(gdb, gdb->in + 1);
+		break;
+	case 'm':
+		gdb_read_mem(gdb, gdb->in + 1);
+		break;
+	case 'M':
+		gdb_write_mem(gdb, gdb->in + 1);
+		break;
+	case 'c':
+		gdb_resume(gdb, gdb->in + 1, false);
+		break;
+	case 's':
+		gdb_resume(gdb, gdb->in + 1, true);
+		break;
+	case 'b':
+		if (gdb->in[1] == 's')
+			gdb_reverse_step(gdb);
+		break;
+	case 'Z':
+		gdb_set_watch(gdb, gdb->in + 1, true);
+		break;
+	case 'z':
+		gdb_set_watch(gdb, gdb->in + 1, false);
+		break;
+	case 'H':
+	case 'T':
+		strcpy(gdb->out, "OK");
+		break;
+	case 'q':
+		gdb_query(gdb, gdb->in + 1);
+		break;
+	case 'Q':
+		if (!strcmp(gdb->in + 1, "StartNoAckMode")) {
+			strcpy(gdb->out, "OK");
+			start_no_ack = true;
+		}
+		break;
+	case 'D':
+		strcpy(gdb->out, "OK");
+		gdb->done = true;
+		break;
+	case 'k':
+		return false;
+	default:
+		break;
+	}
+
+	if (gdb_send_packet(gdb, gdb->out))
+		return false;
+
+	if (start_no_ack)
+		gdb->no_ack = true;
+
+	return !gdb->done;
+}
+
+/* ========= server ========= */
+
+static int gdb_listen(int port, const char* socket_path) {
+	struct sockaddr_in addr_in;
+	struct sockaddr_un addr_un;
+	int fd;
+	int opt;
+
+	fd = socket(socket_path ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+	if (fd < 0) {
+		logg_err("Could not create socket (%s).", strerror(errno));
+		return -1;
+	}
+
+	if (socket_path) {
+		if (strlen(socket_path) >= sizeof(addr_un.sun_path)) {
+			logg_err("Socket path %s is too long.", socket_path);
+			close(fd);
+			return -1;
+		}
+
+		memset(&addr_un, 0, sizeof(addr_un));
+		addr_un.sun_family = AF_UNIX;
+		strcpy(addr_un.sun_path, socket_path);
+		unlink(socket_path);
+
+		if (bind(fd, (struct sockaddr*)&addr_un, sizeof(addr_un)))
+			goto listen_error;
+	}
+	else {
+		opt = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+		memset(&addr_in, 0, sizeof(addr_in));
+		addr_in.sin_family = AF_INET;
+		addr_in.sin_port = htons(port);
+		addr_in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		if (bind(fd, (struct sockaddr*)&addr_in, sizeof(addr_in)))
+			goto listen_error;
+	}
+
+	if (listen(fd, 1))
+		goto listen_error;
+
+	return fd;
+
+listen_error:
+
+	logg_err("Could not listen for connections (%s).", strerror(errno));
+	close(fd);
+
+	return -1;
+}
+
+int gdb_serve(struct device_t* device, int port, const char* socket_path,
+	      bool end_on_last_instr) {
+	gdb_t* gdb;
+	int listen_fd;
+	int opt;
+
+	if (!device->cpu) {
+		logg_err("Please plug CPU into device.");
+
+		return DEVICE_NO_CPU_ERROR;
+	}
+
+	listen_fd = gdb_listen(port, socket_path);
+	if (listen_fd < 0)
+		return -1;
+
+	gdb = malloc(sizeof(*gdb));
+	if (!gdb) {
+		logg_err("Could not allocate memory.");
+		close(listen_fd);
+		return -1;
+	}
+
+	gdb->no_ack = false;
+	gdb->done = false;
+	gdb->end_on_last_instr = end_on_last_instr;
+	gdb->device = device;
+	gdb->rlen = 0;
+	gdb->rpos = 0;
+	atomic_init(&gdb->running, false);
+
+	gtracei("Waiting for connection...");
+
+	do {
+		gdb->fd = accept(listen_fd, NULL, NULL);
+	} while (gdb->fd < 0 && errno == EINTR);
+
+	close(listen_fd);
+
+	if (socket_path)
+		unlink(socket_path);
+
+	if (gdb->fd < 0) {
+		logg_err("Could not accept connection (%s).", strerror(errno));
+		free(gdb);
+		return -1;
+	}
+
+	if (!socket_path) {
+		opt = 1;
+		setsockopt(gdb->fd, IPPROTO_TCP, TCP_NODELAY,
+			   &opt, sizeof(opt));
+	}
+
+	gtracei("Client connected.");
+
+	start_device(device);
+
+	while (gdb_recv_packet(gdb) >= 0 && gdb_handle_packet(gdb))
+		;
+
+	gtracei("Session ended.");
+
+	close(gdb->fd);
+	free(gdb);
+
+	return 0;
+}
@@ -3,26 +3,70 @@
 #include <stdio.h>
 #include <string.h>
 
-status_t populate_imap(instr_map_t* instr_map) {
-	instr_t* i;
-	subinstr_t* s;
-	instr_map_t* curr;
+/* the model everything decodes for: the translator, the disassembler
+ * and the CPUs; chosen once, before any of them starts */
+static cpu_model_t cpu_model = CPU_6502_NMOS;
 
-	for_each_subinstr(s, i) {
+void set_cpu_model(cpu_model_t model) {
 
-		curr = &(instr_map[s->opcode]);
+	cpu_model = model;
 
-		if (!IS_NULL_ENTRY(curr))
-			return STATUS_HASH_INCONSISTENCY;
+	return;
+}
+
+cpu_model_t get_cpu_model(void) {
+
+	return cpu_model;
+}
+
+const opdesc_t* get_opdesc_table(void) {
+
+	return get_model_opdesc_table(cpu_model);
+}
+
+/* sequences without a handler or with an opcode the model lacks are
+ * left out, as is a sequence whose first opcode is already fused */
+void populate_fmap(fuse_map_t* fuse_map, const opdesc_t* opdesc) {
+	fused_t* f;
+	fuse_map_t* fuse;
+	const opdesc_t* op;
+	unsigned int i;
 
-		*curr = (instr_map_t) {
-			.instr = i,
-			.subinstr = s
+	for (f = get_fused_list();
+	     f < get_fused_list() + get_fused_list_size(); f++) {
+		fuse = &(fuse_map[f->opcodes[0]]);
+
+		if (!f->action || IS_FUSED(fuse))
+			continue;
+
+		for (i = 0; i < f->count; i++)
+			if (!opdesc_valid(&(opdesc[f->opcodes[i]])))
+				break;
+
+		if (i < f->count)
+			continue;
+
+		*fuse = (fuse_map_t) {
+			.count = f->count
 		};
 
+		for (i = 0; i < f->count; i++) {
+			op = &(opdesc[f->opcodes[i]]);
+
+			fuse->ops[i] = op;
+			fuse->opcodes[i] = f->opcodes[i];
+			fuse->offsets[i] = fuse->length;
+			fuse->length += opdesc_length(op);
+			fuse->cycles += opdesc_cycles(op);
+
+			if (i < f->count - 1u)
+				fuse->lead_cycles += opdesc_cycles(op);
+		}
+
+		fuse->action = f->action;
 	}
 
-	return STATUS_SUCCESS;
+	return;
 }
 
 #define MAX_MODE_NAME 16
@@ -60,47 +104,71 @@ static void print_mode(instr_mode_t mode) {
 	return;
 }
 
-void print_imap(instr_map_t* instr_map) {
+void print_opdesc_table(const opdesc_t* opdesc) {
 	int i;
-	instr_map_t* curr;
+	const opdesc_t* curr;
 
 	for(i = 0; i < INSTR_MAP_SIZE; i++) {
-		curr = &(instr_map[i]);
+		curr = &(opdesc[i]);
 
-		if (IS_NULL_ENTRY(curr))
+		if (!opdesc_valid(curr))
 			continue;
 
-		printf("[%.2x]: %s (", i, curr->instr->name);
-		print_mode(curr->subinstr->mode);
+		printf("[%.2x]: %.3s (", i, opdesc_name(curr));
+		print_mode(curr->mode);
 		printf(")\n");
 	}
 
 	return;
 }
 
-bool get_subinstr(const char name[], instr_mode_t mode, subinstr_t** res) {
-	instr_t* i;
-	subinstr_t* s;
-
-	for_each_instr(i) {
-
-		if (!strncmp(name, i->name, 3)) {
+/* written without an operand, an instruction is any of its one-byte
+ * forms (e.g. PHA or ASL on the accumulator) */
+#define mode_matches(d, mode) \
+	(((mode) & 0xF) == MODE_IMPLIED ? opdesc_length(d) == 1 \
+					: opdesc_mode(d) == ((mode) & 0xF))
+
+/* the opcode of name in mode; an instruction with a single opcode has
+ * it whatever the mode, and where undocumented opcodes do the same as
+ * a documented one (e.g. NOP), the documented one is taken */
+bool find_opcode(const char name[], instr_mode_t mode, opcode_t* res) {
+	const opdesc_t* opdesc;
+	unsigned int count;
+	unsigned int i;
+	opcode_t last;
+	bool found;
+
+	opdesc = get_opdesc_table();
+	count = 0;
+	last = 0;
+	found = false;
+
+	for (i = 0; i < INSTR_MAP_SIZE; i++) {
+
+		if (!opdesc_valid(&(opdesc[i]))
+		 || strncmp(name, opdesc_name(&(opdesc[i])), 3))
+			continue;
 
-			if (i->size == 1) {
-				*res = i->list;
+		if (mode_matches(&(opdesc[i]), mode)
+		 && (!found || opdesc[i].supported & CPU_6502_NMOS)) {
+			*res = i;
+			found = true;
 
+			if (opdesc[i].supported & CPU_6502_NMOS)
 				return true;
-			}
+		}
 
-			for (s = i->list; s < i->list + i->size; s++) {
+		last = i;
+		count++;
+	}
 
-				if (s->mode == mode) {
-					*res = s;
+	if (found)
+		return true;
 
-					return true;
-				}
-			}
-		}
+	if (count == 1) {
+		*res = last;
+
+		return true;
 	}
 
 	return false;
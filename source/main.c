@@ -8,6 +8,14 @@
 #include "translator.h"
 #include "device.h"
 #include "common.h"
+#include "gdb.h"
+#include "replay.h"
+#include "profile.h"
+#include "aot.h"
+#include "mapper.h"
+#include "console.h"
+#include "timer.h"
+#include "dma.h"
 
 #define MSIG "MAI"
 
@@ -21,7 +29,9 @@
 #define mtracei(FMT, ...) ;
 #endif
 
-extern void init_cpu_6502_actions(void);
+#ifdef AOT_IMAGE
+extern const struct aot_image_t aot_image;
+#endif
 
 /* ======= run device ======= */
 
@@ -33,12 +43,88 @@ static int mem_byte_op(struct mem_byte_t* curr, void* data) {
 			   &curr->byte, 1, false);
 }
 
+static int set_watch_regions(struct device_t* device,
+			     struct mem_region_t* head, uint8_t kind) {
+	struct mem_region_t* curr;
+	unsigned int addr;
+	int ret;
+
+	for (curr = head; curr; curr = curr->next) {
+		for (addr = curr->start_addr; addr <= curr->end_addr; addr++) {
+			ret = device_set_watch(device, addr, kind);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+static int set_page_attr_regions(struct device_t* device,
+				 struct mem_region_t* head, page_attr_t attr) {
+	struct mem_region_t* curr;
+	int ret;
+
+	for (curr = head; curr; curr = curr->next) {
+		ret = device_set_page_attr(device, curr->start_addr,
+					   curr->end_addr, attr);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* the device is the first CPU, and the others share its memory */
+static int run_cpus(struct device_t* device, settings_t* settings,
+		    const result_opts_t* ropts) {
+	struct system_t system;
+	uint64_t slice;
+	uint64_t slice_instrs;
+	int ret;
+	int i;
+
+	slice = settings->slice < 0 ? 0 : settings->slice;
+	slice_instrs = settings->slice_instrs < 0 ? 0 : settings->slice_instrs;
+
+	init_system(&system, device, slice, slice_instrs);
+
+	ret = 0;
+
+	for (i = 0; i < settings->num_cpu_addrs && !ret; i++)
+		ret = system_add_cpu(&system, settings->cpu_addrs[i], slice,
+				     slice_instrs);
+
+	if (!ret)
+		ret = run_system(&system, settings->end_on_final_instr,
+				 settings->cpu_threads, ropts);
+
+	free_system(&system);
+
+	return ret;
+}
+
 static int main_run_device(unsigned int len, const uint8_t* out, void* data) {
 	struct device_t device;
 	struct cpu_6502_t cpu;
+	struct console_t* console;
+	struct interval_timer_t* timer;
+	struct dma_t* dma;
+	result_opts_t ropts;
 	int ret;
 
 	ret = 0;
+	console = NULL;
+	timer = NULL;
+	dma = NULL;
+
+	ropts = (result_opts_t) {
+		.cpu_dump_mode = ((settings_t*)data)->cpu_dump_mode,
+		.mrhead = ((settings_t*)data)->mrhead,
+		.mem_raw_file = ((settings_t*)data)->mem_raw_file,
+		.format = ((settings_t*)data)->result_format,
+		.outfile = ((settings_t*)data)->result_file
+	};
 
 	mtracei("Initializing CPU 6502 actions.");
 
@@ -52,6 +138,81 @@ static int main_run_device(unsigned int len, const uint8_t* out, void* data) {
 		    get_stack_addr(((settings_t*)data)),
 		    get_ram_size(((settings_t*)data)));
 
+	/* map banks, if any, before anything is loaded into them */
+	if (((settings_t*)data)->mapper) {
+		ret = device_attach_mapper(&device,
+					   ((settings_t*)data)->mapper);
+		if (ret)
+			goto exit_run_device;
+	}
+
+	/* shared ROM image, if any */
+	if (((settings_t*)data)->rom) {
+		ret = device_map_rom(&device, ((settings_t*)data)->rom_addr,
+				     ((settings_t*)data)->rom);
+		if (ret)
+			goto exit_run_device;
+	}
+
+	/* memory map, before loading, so images can go into ROM */
+	ret = set_page_attr_regions(&device, ((settings_t*)data)->rom_head,
+				    PAGE_ROM);
+	if (!ret)
+		ret = set_page_attr_regions(&device,
+					    ((settings_t*)data)->mmio_head,
+					    PAGE_MMIO);
+	if (!ret)
+		ret = set_page_attr_regions(&device,
+					    ((settings_t*)data)->unmapped_head,
+					    PAGE_UNMAPPED);
+	if (ret)
+		goto exit_run_device;
+
+	if (((settings_t*)data)->trap_rom_writes)
+		device.rom_policy = ROM_WRITES_TRAP;
+
+	if (((settings_t*)data)->safeguard > 0)
+		device.safeguard = ((settings_t*)data)->safeguard;
+
+	/* console, if any */
+	if (((settings_t*)data)->console_addr >= 0) {
+		console = new_console(((settings_t*)data)->console_addr,
+				      ((settings_t*)data)->console_in);
+		if (!console) {
+			ret = -1;
+			goto exit_run_device;
+		}
+
+		ret = device_attach_peripheral(&device, &console->peripheral);
+		if (ret)
+			goto exit_run_device;
+	}
+
+	/* timer and DMA, if any */
+	if (((settings_t*)data)->timer_addr >= 0) {
+		timer = new_timer(((settings_t*)data)->timer_addr);
+		if (!timer) {
+			ret = -1;
+			goto exit_run_device;
+		}
+
+		ret = device_attach_peripheral(&device, &timer->peripheral);
+		if (ret)
+			goto exit_run_device;
+	}
+
+	if (((settings_t*)data)->dma_addr >= 0) {
+		dma = new_dma(((settings_t*)data)->dma_addr);
+		if (!dma) {
+			ret = -1;
+			goto exit_run_device;
+		}
+
+		ret = device_attach_peripheral(&device, &dma->peripheral);
+		if (ret)
+			goto exit_run_device;
+	}
+
 	/* load ram image, if any */
 	if (((settings_t*)data)->mimage) {
 		mtracei("Loading RAM image to %.4x.",
@@ -60,14 +221,14 @@ static int main_run_device(unsigned int len, const uint8_t* out, void* data) {
 				((settings_t*)data)->mimage->contents,
 				((settings_t*)data)->mimage->length, false);
 		if (ret)
-			return ret;
+			goto exit_run_device;
 	}
 
 	/* load binary */
 	ret = load_to_ram(&device, get_load_addr(((settings_t*)data)),
 			  out, len, true);
 	if (ret)
-		return ret;
+		goto exit_run_device;
 
 	/* load other bytes to RAM, if any */
 	if (((settings_t*)data)->mbhead) {
@@ -76,10 +237,100 @@ static int main_run_device(unsigned int len, const uint8_t* out, void* data) {
 					   mem_byte_op, (void*)(&device));
 	}
 
-	run_device(&device,
-		   ((settings_t*)data)->end_on_final_instr,
-		   ((settings_t*)data)->cpu_dump_mode,
-		   ((settings_t*)data)->mrhead);
+	/* set breakpoints and watchpoints, if any */
+	if (!ret)
+		ret = set_watch_regions(&device,
+					((settings_t*)data)->break_head,
+					WATCH_EXEC);
+	if (!ret)
+		ret = set_watch_regions(&device,
+					((settings_t*)data)->watch_head,
+					WATCH_WRITE);
+	if (!ret)
+		ret = set_watch_regions(&device,
+					((settings_t*)data)->rwatch_head,
+					WATCH_READ);
+
+	if (ret)
+		goto exit_run_device;
+
+#ifdef AOT_IMAGE
+	/* built in with make AOT=<file>; only used if RAM holds the image */
+	if (device_attach_aot(&device, &aot_image))
+		mtracei("Running without compiled code.");
+#endif
+
+	/* record or replay the journal, if any */
+	if (((settings_t*)data)->record_file
+	 && ((settings_t*)data)->replay_file) {
+		logm_err("Cannot record and replay at the same time.");
+		ret = -1;
+	}
+	else if (((settings_t*)data)->seek_cycle >= 0
+	      && !((settings_t*)data)->replay_file) {
+		logm_err("Seeking needs a journal to replay.");
+		ret = -1;
+	}
+	else if (((settings_t*)data)->record_file)
+		ret = replay_record(&device, ((settings_t*)data)->record_file,
+				    get_checkpoint_interval(
+					    ((settings_t*)data)));
+	else if (((settings_t*)data)->replay_file)
+		ret = replay_play(&device, ((settings_t*)data)->replay_file,
+				  ((settings_t*)data)->seek_cycle);
+
+	if (ret)
+		goto exit_run_device;
+
+	if (((settings_t*)data)->num_cpu_addrs
+	 && (((settings_t*)data)->record_file
+	  || ((settings_t*)data)->replay_file
+	  || ((settings_t*)data)->gdb_port >= 0
+	  || ((settings_t*)data)->gdb_socket)) {
+		logm_err("More CPUs cannot be recorded, replayed or debugged.");
+		ret = -1;
+		goto exit_run_device;
+	}
+
+	if (((settings_t*)data)->profile_file) {
+		ret = device_enable_profile(&device);
+		if (ret)
+			goto exit_run_device;
+	}
+
+	if (((settings_t*)data)->gdb_port >= 0
+	 || ((settings_t*)data)->gdb_socket) {
+		mtracei("Waiting for GDB connection.");
+		ret = gdb_serve(&device, ((settings_t*)data)->gdb_port,
+				((settings_t*)data)->gdb_socket,
+				((settings_t*)data)->end_on_final_instr);
+	}
+	else if (((settings_t*)data)->num_cpu_addrs)
+		run_cpus(&device, (settings_t*)data, &ropts);
+	else
+		run_device(&device,
+			   ((settings_t*)data)->end_on_final_instr,
+			   &ropts);
+
+	if (((settings_t*)data)->profile_file) {
+		mtracei("Writing profile to %s.",
+			((settings_t*)data)->profile_file);
+		ret = dump_profile(device.profile, cpu.opdesc,
+				   ((settings_t*)data)->profile_file);
+	}
+
+exit_run_device:
+
+	free_device(&device);
+
+	if (console)
+		free_console(console);
+
+	if (timer)
+		free_timer(timer);
+
+	if (dma)
+		free_dma(dma);
 
 	return ret;
 }
@@ -176,15 +427,24 @@ static int translate_file(const char* infile, const char* outfile,
 			 export_binary, &td);
 }
 
+static int aot_file(const char* infile, const char* outfile,
+		    settings_t* settings) {
+	const char default_outfile[] = "a.out";
+
+	init_cpu_6502_actions();
+
+	return aot_translate(infile, outfile ?: default_outfile,
+			     get_load_addr(settings), get_cpu_model());
+}
+
 static int disassemble_file(const char* infile, settings_t* settings) {
-	DEFINE_INSTR_MAP(instr_map);
-	populate_imap(instr_map);
 
 #ifdef TRANSLATOR_TRACE
-	print_imap(instr_map);
+	print_opdesc_table(get_opdesc_table());
 #endif
 
-	return disassemble(infile, instr_map, settings->dmode);
+	return disassemble(infile, get_opdesc_table(), settings->dmode,
+			   get_load_addr(settings));
 }
 
 typedef enum {
@@ -192,6 +452,7 @@ typedef enum {
 	MAIN_ACTION_RUN,
 	MAIN_ACTION_RUN_BINARY,
 	MAIN_ACTION_DISASSEMBLE,
+	MAIN_ACTION_AOT,
 	MAIN_ACTION_HELP,
 	MAIN_ACTION_NONE
 } main_action_t;
@@ -203,12 +464,42 @@ static struct option long_options[] = {
 	{ "stack-addr",		required_argument,	0, 's' },
 	{ "ram-size",		required_argument,	0, 'M' },
 	{ "stop",		no_argument,		0, 'S' },
+	{ "safeguard",		required_argument,	0, 'n' },
 	{ "dump-cpu",		no_argument,		0, 'd' },
 	{ "dump-mem",		required_argument,	0, 'm' },
+	{ "dump-mem-raw",	required_argument,	0, 'x' },
+	{ "result-format",	required_argument,	0, 'F' },
+	{ "result-file",	required_argument,	0, 'O' },
+	{ "break",		required_argument,	0, 'B' },
+	{ "watch",		required_argument,	0, 'w' },
+	{ "watch-read",		required_argument,	0, 'W' },
+	{ "gdb-port",		required_argument,	0, 'g' },
+	{ "gdb-socket",		required_argument,	0, 'G' },
+	{ "record",		required_argument,	0, 'j' },
+	{ "checkpoint",		required_argument,	0, 'k' },
+	{ "replay",		required_argument,	0, 'J' },
+	{ "seek",		required_argument,	0, 'c' },
+	{ "profile",		required_argument,	0, 'P' },
 	{ "ram-bytes",		required_argument,	0, 'b' },
 	{ "ram-file",		required_argument,	0, 'f' },
+	{ "mapper",		required_argument,	0, 'X' },
+	{ "rom",		required_argument,	0, 'T' },
+	{ "rom-image",		required_argument,	0, 'Y' },
+	{ "mmio",		required_argument,	0, 'I' },
+	{ "unmapped",		required_argument,	0, 'U' },
+	{ "rom-writes",		required_argument,	0, 'E' },
+	{ "console",		required_argument,	0, 'K' },
+	{ "console-in",		required_argument,	0, 'i' },
+	{ "timer",		required_argument,	0, 'Q' },
+	{ "dma",		required_argument,	0, 'Z' },
+	{ "cpus",		required_argument,	0, 'C' },
+	{ "slice",		required_argument,	0, 'L' },
+	{ "slice-instrs",	required_argument,	0, 'N' },
+	{ "cpu-threads",	no_argument,		0, 'H' },
+	{ "cpu-model",		required_argument,	0, 'V' },
 	{ "translate",		required_argument,	0, 't' },
 	{ "disassemble",	required_argument,	0, 'D' },
+	{ "aot",		required_argument,	0, 'A' },
 	{ "pretty",		no_argument,		0, 'p' },
 	{ "output",		required_argument,	0, 'o' },
 	{ "help",		required_argument,	0, 'h' },
@@ -242,7 +533,8 @@ static void print_option_help(struct option* opt, char* help_string) {
 #define TEX(A) #A
 
 #define S_HELP_STR(STACK_ADDR) \
-	"stack address (default: " TEX(STACK_ADDR) ")"
+	"address just above the stack, 0x0101-0x0200 " \
+	"(default: " TEX(STACK_ADDR) ")"
 
 #define A_HELP_STR(LOAD_ADDR) \
 	"load addr (default: " TEX(LOAD_ADDR) ")"
@@ -250,6 +542,12 @@ static void print_option_help(struct option* opt, char* help_string) {
 #define M_HELP_STR(RAM_SIZE) \
 	"ram size in bytes (default: " TEX(RAM_SIZE) ")"
 
+#define K_HELP_STR(INTERVAL) \
+	"cycles between journal checkpoints (default: " TEX(INTERVAL) ")"
+
+#define L_HELP_STR(SLICE) \
+	"cycles each CPU runs per turn (default: " TEX(SLICE) ")"
+
 static void print_help(void) {
 	unsigned int i;
 	char* cpu_dump_help;
@@ -283,6 +581,9 @@ static void print_help(void) {
 		case 'S':
 			help_text("stop after last instruction");
 			break;
+		case 'n':
+			help_text("stop after this many instructions");
+			break;
 		case 'd':
 			cpu_dump_help = get_cpu_dump_help(
 					"dump CPU registers: %s");
@@ -292,6 +593,46 @@ static void print_help(void) {
 		case 'm':
 			help_text("dump memory (e.g. 0x0600-0x060a,0x0700)");
 			break;
+		case 'x':
+			help_text("dump memory as raw binary to file");
+			break;
+		case 'F':
+			help_text("result format: [text|json|binary]");
+			break;
+		case 'O':
+			help_text("result output file (default: stdout)");
+			break;
+		case 'B':
+			help_text("stop when PC reaches address "
+				  "(e.g. 0x0604,0x0610-0x0620)");
+			break;
+		case 'w':
+			help_text("stop after a write to address");
+			break;
+		case 'W':
+			help_text("stop after a read from address");
+			break;
+		case 'g':
+			help_text("serve GDB remote protocol on local port");
+			break;
+		case 'G':
+			help_text("serve GDB remote protocol on unix socket");
+			break;
+		case 'j':
+			help_text("record input journal to file");
+			break;
+		case 'k':
+			help_text(K_HELP_STR(REPLAY_DEFAULT_INTERVAL));
+			break;
+		case 'J':
+			help_text("replay input journal from file");
+			break;
+		case 'c':
+			help_text("stop replay at cycle");
+			break;
+		case 'P':
+			help_text("write opcode pair profile to file");
+			break;
 		case 'b':
 			help_text("load bytes to RAM "
 				  "(e.g. 0x0700:0e,0x0702:ff)");
@@ -299,12 +640,64 @@ static void print_help(void) {
 		case 'f':
 			help_text("load file to RAM (e.g. 0x0700:file_name)");
 			break;
+		case 'X':
+			help_text("bank-switching mapper "
+				  "(e.g. latch:0x8000:0x4000:0xfff0:banks)");
+			break;
+		case 'T':
+			help_text("read-only pages (e.g. 0xe000-0xffff)");
+			break;
+		case 'Y':
+			help_text("map file read-only as ROM, shared "
+				  "(e.g. 0xe000:rom_file)");
+			break;
+		case 'I':
+			help_text("pages handled by peripherals");
+			break;
+		case 'U':
+			help_text("pages where any access is an error");
+			break;
+		case 'E':
+			help_text("writes to ROM: [drop|trap] (default: drop)");
+			break;
+		case 'K':
+			help_text("console at address (e.g. 0xd000)");
+			break;
+		case 'i':
+			help_text("console input file (- for stdin)");
+			break;
+		case 'Q':
+			help_text("interval timer at address (e.g. 0xd100)");
+			break;
+		case 'Z':
+			help_text("DMA engine at address (e.g. 0xd200)");
+			break;
+		case 'C':
+			help_text("more CPUs on the bus, by start address "
+				  "(e.g. 0x0700,0x0800)");
+			break;
+		case 'L':
+			help_text(L_HELP_STR(SYSTEM_DEFAULT_SLICE));
+			break;
+		case 'N':
+			help_text("instructions each CPU runs per turn");
+			break;
+		case 'H':
+			help_text("run each CPU on a thread of its own");
+			break;
+		case 'V':
+			help_text("CPU model: [nmos|undoc|65c02] "
+				  "(default: nmos)");
+			break;
 		case 't':
 			help_text("translate file to binary");
 			break;
 		case 'D':
 			help_text("disassemble binary file");
 			break;
+		case 'A':
+			help_text("translate binary file to C");
+			break;
 		case 'p':
 			help_text("print binary when disassembling");
 			break;
@@ -377,7 +770,7 @@ int main(int argc, char* const argv[]) {
 
 	init_settings(&settings);
 
-	while ((opt = getopt_long(argc, argv, "r:R:a:SM:s:d:m:b:f:t:D:po:h",
+	while ((opt = getopt_long(argc, argv, "r:R:a:Sn:M:s:d:m:x:F:O:B:w:W:g:G:j:k:J:c:P:b:f:X:T:Y:I:U:E:K:i:Q:Z:C:L:N:HV:t:D:A:po:h",
 				  long_options, &option_index)) != -1) {
 		switch (opt) {
 
@@ -401,7 +794,11 @@ int main(int argc, char* const argv[]) {
 			settings.load_addr = (uint16_t)parse_arg(optarg);
 			break;
 		case 's':
-			settings.stack_addr = (uint16_t)parse_arg(optarg);
+			settings.stack_addr = parse_arg(optarg);
+			if (settings.stack_addr <= STACK_PAGE_ADDR
+			 || settings.stack_addr > STACK_PAGE_ADDR + PAGE_SIZE) {
+				IMPROPER_USAGE;
+			}
 			set_setting(sc, SETTING_RUN);
 			break;
 		case 'M':
@@ -414,6 +811,11 @@ int main(int argc, char* const argv[]) {
 			set_setting(sc, SETTING_RUN);
 			break;
 
+		case 'n':
+			settings.safeguard = parse_arg(optarg);
+			set_setting(sc, SETTING_RUN);
+			break;
+
 		case 'd':
 			settings.cpu_dump_mode = parse_cpu_dump_mode(optarg);
 			set_setting(sc, SETTING_RUN);
@@ -428,6 +830,95 @@ int main(int argc, char* const argv[]) {
 			set_setting(sc, SETTING_RUN);
 			break;
 
+		case 'x':
+			settings.mem_raw_file = optarg;
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'F':
+			settings.result_format = parse_result_format(optarg);
+			if (settings.result_format == RESULT_FORMAT_INVALID) {
+				IMPROPER_USAGE;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'O':
+			settings.result_file = optarg;
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'B':
+			settings.break_head = parse_mem_region(optarg);
+			if (!settings.break_head) {
+				ret = -1;
+				goto exit_main;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'w':
+			settings.watch_head = parse_mem_region(optarg);
+			if (!settings.watch_head) {
+				ret = -1;
+				goto exit_main;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'W':
+			settings.rwatch_head = parse_mem_region(optarg);
+			if (!settings.rwatch_head) {
+				ret = -1;
+				goto exit_main;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'g':
+			settings.gdb_port = parse_arg(optarg);
+			if (settings.gdb_port <= 0 || settings.gdb_port > 0xFFFF) {
+				IMPROPER_USAGE;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'G':
+			settings.gdb_socket = optarg;
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'j':
+			settings.record_file = optarg;
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'k':
+			settings.checkpoint_interval = parse_arg(optarg);
+			if (settings.checkpoint_interval <= 0) {
+				IMPROPER_USAGE;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'J':
+			settings.replay_file = optarg;
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'c':
+			settings.seek_cycle = parse_arg(optarg);
+			if (settings.seek_cycle < 0) {
+				IMPROPER_USAGE;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'P':
+			settings.profile_file = optarg;
+			set_setting(sc, SETTING_RUN);
+			break;
+
 		case 'b':
 			settings.mbhead = parse_mem_bytes(optarg);
 			if (!settings.mbhead) {
@@ -446,6 +937,125 @@ int main(int argc, char* const argv[]) {
 			set_setting(sc, SETTING_RUN);
 			break;
 
+		case 'X':
+			settings.mapper = parse_mapper(optarg);
+			if (!settings.mapper) {
+				ret = -1;
+				goto exit_main;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'T':
+			settings.rom_head = parse_mem_region(optarg);
+			if (!settings.rom_head) {
+				ret = -1;
+				goto exit_main;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'Y':
+			settings.rom = parse_rom(optarg, &settings.rom_addr);
+			if (!settings.rom) {
+				ret = -1;
+				goto exit_main;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'I':
+			settings.mmio_head = parse_mem_region(optarg);
+			if (!settings.mmio_head) {
+				ret = -1;
+				goto exit_main;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'U':
+			settings.unmapped_head = parse_mem_region(optarg);
+			if (!settings.unmapped_head) {
+				ret = -1;
+				goto exit_main;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'E':
+			if (!strcmp(optarg, "trap"))
+				settings.trap_rom_writes = true;
+			else if (strcmp(optarg, "drop")) {
+				IMPROPER_USAGE;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'K':
+			settings.console_addr = parse_arg(optarg);
+			if (settings.console_addr < 0
+			 || settings.console_addr > MEM_MAX_ADDR) {
+				IMPROPER_USAGE;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'i':
+			settings.console_in = optarg;
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'Q':
+			settings.timer_addr = parse_arg(optarg);
+			if (settings.timer_addr < 0
+			 || settings.timer_addr > MEM_MAX_ADDR) {
+				IMPROPER_USAGE;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'Z':
+			settings.dma_addr = parse_arg(optarg);
+			if (settings.dma_addr < 0
+			 || settings.dma_addr > MEM_MAX_ADDR) {
+				IMPROPER_USAGE;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'C':
+			settings.num_cpu_addrs = parse_cpu_addrs(optarg,
+					settings.cpu_addrs, SYSTEM_MAX_CPUS - 1);
+			if (settings.num_cpu_addrs <= 0) {
+				ret = -1;
+				goto exit_main;
+			}
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'L':
+			settings.slice = parse_arg(optarg);
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'N':
+			settings.slice_instrs = parse_arg(optarg);
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'H':
+			settings.cpu_threads = true;
+			set_setting(sc, SETTING_RUN);
+			break;
+
+		case 'V':
+			settings.cpu_model = parse_cpu_model(optarg);
+			if (!settings.cpu_model) {
+				logm_err("Unknown CPU model %s.", optarg);
+				IMPROPER_USAGE;
+			}
+			break;
+
 		case 't':
 			infile = optarg;
 			if (action != MAIN_ACTION_NONE) {
@@ -462,6 +1072,14 @@ int main(int argc, char* const argv[]) {
 			action = MAIN_ACTION_DISASSEMBLE;
 			break;
 
+		case 'A':
+			infile = optarg;
+			if (action != MAIN_ACTION_NONE) {
+				IMPROPER_USAGE;
+			}
+			action = MAIN_ACTION_AOT;
+			break;
+
 		case 'p':
 			settings.dmode = DISASM_PRETTY;
 			set_setting(sc, SETTING_DISASSEMBLE);
@@ -488,6 +1106,9 @@ int main(int argc, char* const argv[]) {
 		IMPROPER_USAGE;
 	}
 
+	/* the translator, the disassembler and the CPUs all decode for it */
+	set_cpu_model(settings.cpu_model);
+
 	switch (action) {
 
 	case MAIN_ACTION_HELP:
@@ -536,6 +1157,15 @@ int main(int argc, char* const argv[]) {
 		ret = disassemble_file(infile, &settings);
 		break;
 
+	case MAIN_ACTION_AOT:
+
+		if (sc != SETTING_NONE && sc != SETTING_TRANSLATE) {
+			IMPROPER_USAGE;
+		}
+
+		ret = aot_file(infile, outfile, &settings);
+		break;
+
 	case MAIN_ACTION_NONE:
 		IMPROPER_USAGE;
 	}
@@ -0,0 +1,338 @@
+#include "mapper.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "device.h"
+
+#define XSIG "MAP"
+
+#define logx_err(FMT, ...) log_err(XSIG, FMT, ## __VA_ARGS__)
+
+#ifdef MAPPER_TRACE
+#define xtracei(FMT, ...) tracei(XSIG, FMT, ## __VA_ARGS__)
+#else
+#define xtracei(FMT, ...) ;
+#endif
+
+/* ======= built-in types ======= */
+
+/* one register; the value written selects the bank of the first
+ * window */
+static unsigned int latch_regs(const struct mapper_t* mapper) {
+
+	return 1;
+}
+
+static void latch_write(struct mapper_t* mapper, uint16_t reg, uint8_t val) {
+
+	mapper_select(mapper, 0, val);
+
+	return;
+}
+
+/* a register per window, each selecting the bank of its own */
+static unsigned int multi_regs(const struct mapper_t* mapper) {
+
+	return mapper->num_windows;
+}
+
+static void multi_write(struct mapper_t* mapper, uint16_t reg, uint8_t val) {
+
+	mapper_select(mapper, reg, val);
+
+	return;
+}
+
+/* a register per bank; any write to one selects its bank for the first
+ * window */
+static unsigned int hotspot_regs(const struct mapper_t* mapper) {
+
+	return mapper->bank_count;
+}
+
+static void hotspot_write(struct mapper_t* mapper, uint16_t reg,
+			  uint8_t val) {
+
+	mapper_select(mapper, 0, reg);
+
+	return;
+}
+
+static const struct mapper_ops_t latch_ops = {
+	.name = "latch",
+	.regs = latch_regs,
+	.write = latch_write
+};
+
+static const struct mapper_ops_t multi_ops = {
+	.name = "multi",
+	.regs = multi_regs,
+	.write = multi_write
+};
+
+static const struct mapper_ops_t hotspot_ops = {
+	.name = "hotspot",
+	.regs = hotspot_regs,
+	.write = hotspot_write
+};
+
+static const struct mapper_ops_t* mapper_types[MAPPER_MAX_TYPES] = {
+	&latch_ops,
+	&multi_ops,
+	&hotspot_ops
+};
+
+static const struct mapper_ops_t* find_type(const char* name) {
+	unsigned int i;
+
+	for (i = 0; i < MAPPER_MAX_TYPES && mapper_types[i]; i++)
+		if (!strcmp(mapper_types[i]->name, name))
+			return mapper_types[i];
+
+	return NULL;
+}
+
+int mapper_register_type(const struct mapper_ops_t* ops) {
+	unsigned int i;
+
+	if (find_type(ops->name)) {
+		logx_err("Mapper type %s already exists.", ops->name);
+		return -1;
+	}
+
+	for (i = 0; i < MAPPER_MAX_TYPES; i++) {
+		if (!mapper_types[i]) {
+			mapper_types[i] = ops;
+			return 0;
+		}
+	}
+
+	logx_err("No room for mapper type %s.", ops->name);
+
+	return -1;
+}
+
+/* ======= mapper ======= */
+
+/* banks are filled from data in order, the last one padded with
+ * zeros; window n starts out showing bank n */
+struct mapper_t* new_mapper(const struct mapper_ops_t* ops,
+			    const uint8_t* data, unsigned int len,
+			    unsigned int bank_size, const uint16_t* windows,
+			    unsigned int num_windows, uint16_t reg_addr) {
+	struct mapper_t* mapper;
+	unsigned int i;
+	unsigned int j;
+
+	if (!bank_size || bank_size % PAGE_SIZE || !len
+	 || !num_windows || num_windows > MAPPER_MAX_WINDOWS) {
+		logx_err("Invalid mapper layout.");
+		return NULL;
+	}
+
+	for (i = 0; i < num_windows; i++) {
+		if (windows[i] % PAGE_SIZE
+		 || windows[i] + bank_size > MEM_MAX_ADDR + 1
+		 || get_page_num(windows[i]) < 2) {
+			logx_err("Invalid mapper window at %.4x.", windows[i]);
+			return NULL;
+		}
+
+		for (j = 0; j < i; j++) {
+			if (windows[i] < windows[j] + bank_size
+			 && windows[j] < windows[i] + bank_size) {
+				logx_err("Mapper windows at %.4x and %.4x "
+					 "overlap.", windows[j], windows[i]);
+				return NULL;
+			}
+		}
+	}
+
+	mapper = calloc(1, sizeof(*mapper));
+	if (!mapper) {
+		logx_err("Could not allocate mapper.");
+		return NULL;
+	}
+
+	mapper->ops = ops;
+	mapper->bank_size = bank_size;
+	mapper->bank_count = (len + bank_size - 1) / bank_size;
+	mapper->reg_addr = reg_addr;
+	mapper->num_windows = num_windows;
+
+	mapper->banks = calloc(mapper->bank_count, bank_size);
+	if (!mapper->banks) {
+		logx_err("Could not allocate %u banks.", mapper->bank_count);
+		free(mapper);
+		return NULL;
+	}
+
+	memcpy(mapper->banks, data, len);
+
+	for (i = 0; i < num_windows; i++)
+		mapper->windows[i] = (struct mapper_window_t) {
+			.page = get_page_num(windows[i]),
+			.bank = i % mapper->bank_count
+		};
+
+	mapper->reg_count = ops->regs(mapper);
+
+	xtracei("%s mapper: %u banks of %.4x bytes, registers at %.4x.",
+		ops->name, mapper->bank_count, bank_size, reg_addr);
+
+	return mapper;
+}
+
+#define MAPPER_MAX_FIELD 32
+
+/* TYPE:WINDOW[,WINDOW...]:BANK_SIZE:REG_ADDR:FILE, numbers in hex */
+struct mapper_t* parse_mapper(const char* arg) {
+	const struct mapper_ops_t* ops;
+	struct mapper_t* mapper;
+	uint16_t windows[MAPPER_MAX_WINDOWS];
+	unsigned int num_windows;
+	char fields[4][MAPPER_MAX_FIELD];
+	const char* ptr;
+	const char* sep;
+	char* window;
+	uint8_t* data;
+	unsigned int len;
+	unsigned int i;
+	int bank_size;
+	int reg_addr;
+	int val;
+
+	ptr = arg;
+
+	for (i = 0; i < 4; i++) {
+		sep = strchr(ptr, ':');
+		if (!sep || sep - ptr >= MAPPER_MAX_FIELD)
+			goto parse_mapper_error;
+
+		memcpy(fields[i], ptr, sep - ptr);
+		fields[i][sep - ptr] = '\0';
+		ptr = sep + 1;
+	}
+
+	ops = find_type(fields[0]);
+	if (!ops) {
+		logx_err("Unknown mapper type %s.", fields[0]);
+		return NULL;
+	}
+
+	num_windows = 0;
+
+	for (window = strtok(fields[1], ","); window;
+	     window = strtok(NULL, ",")) {
+		val = parse_str(window, 16, NULL);
+		if (val < 0 || val > MEM_MAX_ADDR
+		 || num_windows == MAPPER_MAX_WINDOWS)
+			goto parse_mapper_error;
+
+		windows[num_windows++] = val;
+	}
+
+	bank_size = parse_str(fields[2], 16, NULL);
+	reg_addr = parse_str(fields[3], 16, NULL);
+
+	if (bank_size <= 0 || reg_addr < 0 || reg_addr > MEM_MAX_ADDR
+	 || !*ptr)
+		goto parse_mapper_error;
+
+	data = load_file(ptr, &len);
+	if (!data) {
+		logx_err("Could not load banks from %s.", ptr);
+		return NULL;
+	}
+
+	mapper = new_mapper(ops, data, len, bank_size, windows, num_windows,
+			    reg_addr);
+
+	free(data);
+
+	return mapper;
+
+parse_mapper_error:
+
+	logx_err("Invalid argument: %s.", arg);
+
+	return NULL;
+}
+
+void mapper_select(struct mapper_t* mapper, unsigned int window,
+		   unsigned int bank) {
+	struct mapper_window_t* w;
+	unsigned int i;
+
+	if (window >= mapper->num_windows)
+		return;
+
+	w = &(mapper->windows[window]);
+	bank %= mapper->bank_count;
+
+	if (w->bank == bank)
+		return;
+
+	w->bank = bank;
+
+	for (i = 0; i < mapper->num_devices; i++)
+		device_map_pages(mapper->devices[i], w->page,
+				 mapper_bank(mapper, bank),
+				 mapper_window_pages(mapper));
+
+	return;
+}
+
+void mapper_write(struct mapper_t* mapper, uint16_t addr, uint8_t val) {
+
+	xtracei("Write %.2x to register %.4x.", val, addr);
+
+	mapper->ops->write(mapper, addr - mapper->reg_addr, val);
+
+	return;
+}
+
+void mapper_save(const struct mapper_t* mapper, uint8_t* state) {
+	unsigned int i;
+	unsigned int j;
+
+	for (i = 0; i < mapper->num_windows; i++)
+		for (j = 0; j < 4; j++)
+			*(state++) = (uint8_t)(mapper->windows[i].bank
+					       >> (j * 8));
+
+	memcpy(state, mapper->banks, mapper->bank_count * mapper->bank_size);
+
+	return;
+}
+
+/* banks are filled in before the windows are pointed at them again */
+void mapper_restore(struct mapper_t* mapper, const uint8_t* state) {
+	unsigned int bank;
+	unsigned int i;
+	unsigned int j;
+
+	memcpy(mapper->banks, state + mapper->num_windows * 4,
+	       mapper->bank_count * mapper->bank_size);
+
+	for (i = 0; i < mapper->num_windows; i++) {
+		bank = 0;
+		for (j = 0; j < 4; j++)
+			bank |= (unsigned int)*(state++) << (j * 8);
+
+		mapper_select(mapper, i, bank);
+	}
+
+	return;
+}
+
+void free_mapper(struct mapper_t* mapper) {
+
+	free(mapper->banks);
+	free(mapper);
+
+	return;
+}
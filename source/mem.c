@@ -13,16 +13,40 @@
 
 void print_mem_region(struct device_t* device, struct mem_region_t* mr) {
 	struct mem_region_t* curr;
+	unsigned int size;
+	unsigned int len;
+	uint8_t* buff;
+	char* out;
+	char* ptr;
 
-	curr = mr;
+	size = 0;
 
-	while (curr) {
-		print_hex(&(device->ram.ram[curr->start_addr]),
-			  curr->end_addr - curr->start_addr + 1,
-			  curr->start_addr);
-		curr = curr->next;
+	for (curr = mr; curr; curr = curr->next)
+		size += hex_dump_size(curr->end_addr - curr->start_addr + 1,
+				      curr->start_addr);
+
+	out = malloc(size);
+	buff = malloc(MEM_MAX_ADDR + 1);
+	if (!out || !buff) {
+		logm_err("Could not allocate memory for memory dump.");
+		free(out);
+		free(buff);
+		return;
 	}
 
+	ptr = out;
+
+	for (curr = mr; curr; curr = curr->next) {
+		len = curr->end_addr - curr->start_addr + 1;
+		device_copy_ram(device, buff, curr->start_addr, len);
+		ptr += format_hex(ptr, buff, len, curr->start_addr);
+	}
+
+	fwrite(out, 1, ptr - out, stdout);
+
+	free(buff);
+	free(out);
+
 	return;
 }
 
@@ -33,6 +57,59 @@ void dump_mem(struct device_t* device, struct mem_region_t* mr) {
 	return;
 }
 
+/* regions are written back to back, without any addresses; if no
+ * regions are given, the whole address space is written */
+int dump_mem_raw(struct device_t* device, struct mem_region_t* mr,
+		 const char* outfile) {
+	struct mem_region_t full;
+	struct mem_region_t* curr;
+	unsigned int len;
+	uint8_t* buff;
+	FILE* f;
+	int ret;
+
+	if (!mr) {
+		full.start_addr = 0x0000;
+		full.end_addr = MEM_MAX_ADDR;
+		full.next = NULL;
+		mr = &full;
+	}
+
+	buff = malloc(MEM_MAX_ADDR + 1);
+	if (!buff) {
+		logm_err("Could not allocate memory for memory dump.");
+		return -1;
+	}
+
+	f = fopen(outfile, "w");
+	if (!f) {
+		logm_err("Could not open %s for output.", outfile);
+		free(buff);
+		return -1;
+	}
+
+	ret = 0;
+
+	for (curr = mr; curr; curr = curr->next) {
+		len = curr->end_addr - curr->start_addr + 1;
+
+		device_copy_ram(device, buff, curr->start_addr, len);
+
+		if (fwrite(buff, 1, len, f) != len) {
+			logm_err("Error writing memory to %s.", outfile);
+			ret = -1;
+			goto exit_dump_mem_raw;
+		}
+	}
+
+exit_dump_mem_raw:
+
+	fclose(f);
+	free(buff);
+
+	return ret;
+}
+
 static void init_mem_region(struct mem_region_t* mem) {
 
 	mem->is_valid = false;
@@ -107,7 +184,7 @@ static bool separate(const char* str, int sep_loc, struct mem_region_t* mem) {
 		goto exit_separate;
 
 	mem->end_addr = ret;
-	mem->is_valid = true;
+	mem->is_valid = mem->end_addr <= MEM_MAX_ADDR;
 
 exit_separate:
 
@@ -117,7 +194,7 @@ exit_separate:
 	if (second)
 		free(second);
 
-	if (mem->end_addr < mem->start_addr)
+	if (!mem->is_valid || mem->end_addr < mem->start_addr)
 		return false;
 
 	return ret >= 0;
@@ -126,7 +203,7 @@ exit_separate:
 struct mem_region_t* parse_mem_region(const char* str) {
 	char* temp;
 	char* ptr;
-	char sep = ',';
+	const char* sep = ",";
 	int sep_loc;
 	int tmp_addr;
 	ssize_t strsize;
@@ -140,7 +217,7 @@ struct mem_region_t* parse_mem_region(const char* str) {
 	strcpy(temp, str);
 	temp[strsize - 1] = '\0';
 
-	ptr = strtok(temp, &sep);
+	ptr = strtok(temp, sep);
 
 	while (ptr) {
 		mem_new = malloc(sizeof(*mem_new));
@@ -149,7 +226,7 @@ struct mem_region_t* parse_mem_region(const char* str) {
 		if ((sep_loc = find_sep(ptr, '-')) < 0) {
  			tmp_addr = parse_str(ptr, 16, NULL);
 
-			if (tmp_addr < 0)
+			if (tmp_addr < 0 || tmp_addr > MEM_MAX_ADDR)
 				goto mem_region_error;
 
 			mem_new->start_addr = (unsigned int)tmp_addr;
@@ -166,7 +243,7 @@ struct mem_region_t* parse_mem_region(const char* str) {
 		else
 			append_mem_region(mem_head, mem_new);
 
-		ptr = strtok(NULL, &sep);
+		ptr = strtok(NULL, sep);
 	}
 
 	free(temp);
@@ -314,7 +391,7 @@ static bool separate_mb(const char* ptr, int sep_loc, struct mem_byte_t* mem_new
 struct mem_byte_t* parse_mem_bytes(const char* str) {
 	char* temp;
 	char* ptr;
-	char sep = ',';
+	const char* sep = ",";
 	int sep_loc;
 	ssize_t strsize;
 	struct mem_byte_t* mem_head;
@@ -327,7 +404,7 @@ struct mem_byte_t* parse_mem_bytes(const char* str) {
 	strcpy(temp, str);
 	temp[strsize - 1] = '\0';
 
-	ptr = strtok(temp, &sep);
+	ptr = strtok(temp, sep);
 
 	while (ptr) {
 		mem_new = malloc(sizeof(*mem_new));
@@ -345,7 +422,7 @@ struct mem_byte_t* parse_mem_bytes(const char* str) {
 		else
 			append_mem_byte(mem_head, mem_new);
 
-		ptr = strtok(NULL, &sep);
+		ptr = strtok(NULL, sep);
 	}
 
 	free(temp);
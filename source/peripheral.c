@@ -0,0 +1,266 @@
+#include "peripheral.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+
+#include "common.h"
+#include "device.h"
+
+#define PSIG "PER"
+
+#define logp_err(FMT, ...) log_err(PSIG, FMT, ## __VA_ARGS__)
+
+#ifdef PERIPHERAL_TRACE
+#define ptracei(FMT, ...) tracei(PSIG, FMT, ## __VA_ARGS__)
+#else
+#define ptracei(FMT, ...) ;
+#endif
+
+#define queue_index(i) ((i) & (PERIPH_QUEUE_SIZE - 1))
+
+/* ======= rings ======= */
+
+bool periph_queue_push(struct periph_queue_t* queue,
+		       const struct periph_msg_t* msg) {
+	unsigned int tail;
+
+	tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+	if (tail - atomic_load_explicit(&queue->head, memory_order_acquire)
+	    == PERIPH_QUEUE_SIZE)
+		return false;
+
+	queue->msgs[queue_index(tail)] = *msg;
+	atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+	return true;
+}
+
+bool periph_queue_front(struct periph_queue_t* queue,
+			struct periph_msg_t* msg) {
+	unsigned int head;
+
+	head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+	if (head == atomic_load_explicit(&queue->tail, memory_order_acquire))
+		return false;
+
+	*msg = queue->msgs[queue_index(head)];
+
+	return true;
+}
+
+bool periph_queue_pop(struct periph_queue_t* queue,
+		      struct periph_msg_t* msg) {
+
+	if (!periph_queue_front(queue, msg))
+		return false;
+
+	atomic_store_explicit(&queue->head,
+		atomic_load_explicit(&queue->head, memory_order_relaxed) + 1,
+		memory_order_release);
+
+	return true;
+}
+
+/* as seen by the producer, never less than what is queued */
+unsigned int periph_queue_count(struct periph_queue_t* queue) {
+
+	return atomic_load_explicit(&queue->tail, memory_order_acquire)
+	     - atomic_load_explicit(&queue->head, memory_order_acquire);
+}
+
+/* spins a little, then yields, then sleeps, so an idle side costs
+ * next to nothing while a busy one is answered quickly */
+#define PERIPH_SPINS 64
+#define PERIPH_YIELDS 1024
+#define PERIPH_SLEEP_NS 50000
+
+void periph_wait(unsigned int* waits) {
+	struct timespec ts;
+
+	if (*waits >= PERIPH_YIELDS) {
+		ts.tv_sec = 0;
+		ts.tv_nsec = PERIPH_SLEEP_NS;
+		nanosleep(&ts, NULL);
+		return;
+	}
+
+	if (*waits >= PERIPH_SPINS)
+		sched_yield();
+
+	(*waits)++;
+
+	return;
+}
+
+/* ======= thread ======= */
+
+/* a stop only takes effect once everything the CPU sent is handled */
+static void* periph_thread(void* data) {
+	struct peripheral_t* peripheral;
+	struct periph_thread_t* thread;
+	struct periph_msg_t msg;
+	unsigned int waits;
+
+	peripheral = data;
+	thread = peripheral->thread;
+	waits = 0;
+
+	while (true) {
+		if (periph_queue_pop(&thread->to_thread, &msg)) {
+			thread->ops->handle(peripheral, &msg);
+			waits = 0;
+			continue;
+		}
+
+		if (atomic_load_explicit(&thread->stopping,
+					 memory_order_acquire)) {
+			while (periph_queue_pop(&thread->to_thread, &msg))
+				thread->ops->handle(peripheral, &msg);
+
+			if (thread->ops->stop)
+				thread->ops->stop(peripheral);
+			break;
+		}
+
+		if (thread->ops->poll && thread->ops->poll(peripheral)) {
+			waits = 0;
+			continue;
+		}
+
+		periph_wait(&waits);
+	}
+
+	return NULL;
+}
+
+int periph_start(struct peripheral_t* peripheral,
+		 const struct periph_thread_ops_t* ops) {
+	struct periph_thread_t* thread;
+
+	if (posix_memalign((void**)&thread, 64, sizeof(*thread))) {
+		logp_err("Could not allocate peripheral thread.");
+		return -1;
+	}
+
+	memset(thread, 0, sizeof(*thread));
+
+	atomic_init(&thread->to_thread.head, 0);
+	atomic_init(&thread->to_thread.tail, 0);
+	atomic_init(&thread->from_thread.head, 0);
+	atomic_init(&thread->from_thread.tail, 0);
+	atomic_init(&thread->stopping, false);
+	thread->ops = ops;
+
+	peripheral->thread = thread;
+
+	if (pthread_create(&thread->thread, NULL, periph_thread, peripheral)) {
+		logp_err("Could not start peripheral thread.");
+		peripheral->thread = NULL;
+		free(thread);
+		return -1;
+	}
+
+	ptracei("Started thread for %.4x-%.4x.", peripheral->addr_start,
+		peripheral->addr_end);
+
+	return 0;
+}
+
+void periph_stop(struct peripheral_t* peripheral) {
+
+	if (!peripheral->thread)
+		return;
+
+	atomic_store_explicit(&peripheral->thread->stopping, true,
+			      memory_order_release);
+
+	pthread_join(peripheral->thread->thread, NULL);
+
+	free(peripheral->thread);
+	peripheral->thread = NULL;
+
+	return;
+}
+
+/* ======= CPU side ======= */
+
+#define periph_now(peripheral) \
+	((peripheral)->device ? (peripheral)->device->cycles : 0)
+
+/* waits only while the ring is full */
+void periph_send(struct peripheral_t* peripheral, uint16_t addr,
+		 uint8_t val, bool reply) {
+	struct periph_msg_t msg;
+	unsigned int waits;
+
+	msg = (struct periph_msg_t) {
+		.cycle = periph_now(peripheral),
+		.addr = addr,
+		.val = val
+	};
+
+	waits = 0;
+
+	while (!periph_queue_push(&peripheral->thread->to_thread, &msg))
+		periph_wait(&waits);
+
+	if (reply)
+		peripheral->thread->replies++;
+
+	return;
+}
+
+/* takes the next message from the thread if it is due; with replies
+ * outstanding, an empty ring cannot tell whether one is due, so this
+ * waits for the next message */
+bool periph_receive(struct peripheral_t* peripheral,
+		    struct periph_msg_t* msg) {
+	struct periph_thread_t* thread;
+	unsigned int waits;
+
+	thread = peripheral->thread;
+	waits = 0;
+
+	while (!periph_queue_front(&thread->from_thread, msg)) {
+		if (!thread->replies)
+			return false;
+
+		periph_wait(&waits);
+	}
+
+	if (msg->cycle > periph_now(peripheral))
+		return false;
+
+	periph_queue_pop(&thread->from_thread, msg);
+
+	if (thread->replies)
+		thread->replies--;
+
+	return true;
+}
+
+/* ======= thread side ======= */
+
+/* waits while the ring is full, unless the peripheral is stopping, as
+ * nobody takes messages then */
+void periph_post(struct peripheral_t* peripheral,
+		 const struct periph_msg_t* msg) {
+	unsigned int waits;
+
+	waits = 0;
+
+	while (!periph_queue_push(&peripheral->thread->from_thread, msg)) {
+		if (atomic_load_explicit(&peripheral->thread->stopping,
+					 memory_order_acquire))
+			return;
+
+		periph_wait(&waits);
+	}
+
+	return;
+}
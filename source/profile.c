@@ -0,0 +1,114 @@
+#include "profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define FSIG "PRF"
+
+#define logf_err(FMT, ...) log_err(FSIG, FMT, ## __VA_ARGS__)
+
+struct profile_t* new_profile(void) {
+	struct profile_t* profile;
+
+	profile = calloc(1, sizeof(*profile));
+	if (!profile) {
+		logf_err("Could not allocate profile.");
+		return NULL;
+	}
+
+	profile->last = -1;
+
+	return profile;
+}
+
+void profile_count(struct profile_t* profile, uint16_t pc,
+		   opcode_t opcode, uint8_t length) {
+
+	if (profile->last >= 0 && pc == profile->next_pc)
+		profile->pairs[(profile->last << 8) | opcode]++;
+
+	profile->last = opcode;
+	profile->next_pc = pc + length;
+
+	return;
+}
+
+struct pair_count_t {
+	uint64_t count;
+	unsigned int pair;
+};
+
+static int compare_pairs(const void* a, const void* b) {
+	uint64_t count_a;
+	uint64_t count_b;
+
+	count_a = ((const struct pair_count_t*)a)->count;
+	count_b = ((const struct pair_count_t*)b)->count;
+
+	return count_a < count_b ? 1 : count_a > count_b ? -1 : 0;
+}
+
+#define pair_name(opdesc, opc) opdesc_name(&((opdesc)[opc]))
+
+/* one pair per line, most frequent first: count, first and second
+ * opcode (hex) and both mnemonics */
+int dump_profile(struct profile_t* profile, const opdesc_t* opdesc,
+		 const char* outfile) {
+	struct pair_count_t* order;
+	unsigned int count;
+	unsigned int i;
+	FILE* f;
+
+	count = 0;
+
+	for (i = 0; i < INSTR_MAP_SIZE * INSTR_MAP_SIZE; i++)
+		if (profile->pairs[i])
+			count++;
+
+	order = malloc(sizeof(*order) * (count + 1));
+	if (!order) {
+		logf_err("Could not allocate profile order.");
+		return -1;
+	}
+
+	count = 0;
+
+	for (i = 0; i < INSTR_MAP_SIZE * INSTR_MAP_SIZE; i++)
+		if (profile->pairs[i])
+			order[count++] = (struct pair_count_t) {
+				.count = profile->pairs[i],
+				.pair = i
+			};
+
+	qsort(order, count, sizeof(*order), compare_pairs);
+
+	f = fopen(outfile, "w");
+	if (!f) {
+		logf_err("Could not open %s for output.", outfile);
+		free(order);
+		return -1;
+	}
+
+	fprintf(f, "# count first second\n");
+
+	for (i = 0; i < count; i++)
+		fprintf(f, "%llu %.2x %.2x %.3s %.3s\n",
+			(unsigned long long)order[i].count,
+			order[i].pair >> 8, order[i].pair & 0xFF,
+			pair_name(opdesc, order[i].pair >> 8),
+			pair_name(opdesc, order[i].pair & 0xFF));
+
+	fclose(f);
+	free(order);
+
+	return 0;
+}
+
+void free_profile(struct profile_t* profile) {
+
+	free(profile);
+
+	return;
+}
@@ -0,0 +1,633 @@
+#include "replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "device.h"
+#include "mapper.h"
+
+#define PSIG "RPL"
+
+#define logp_err(FMT, ...) log_err(PSIG, FMT, ## __VA_ARGS__)
+
+#ifdef REPLAY_TRACE
+#define ptracei(FMT, ...) tracei(PSIG, FMT, ## __VA_ARGS__)
+#else
+#define ptracei(FMT, ...) ;
+#endif
+
+#define CHECKPOINT_HEADER_SIZE 24
+
+struct replay_input_t {
+	uint64_t cycle;
+	uint16_t addr;
+	uint8_t val;
+};
+
+struct replay_checkpoint_t {
+	uint64_t cycles;
+	uint64_t instrs;
+	const uint8_t* regs;
+	const uint8_t* state;
+	const uint8_t* mapper;
+	const uint8_t* ram;
+};
+
+struct replay_t {
+	bool playing;
+	uint32_t ram_size;
+	uint32_t state_size;	/* of all peripherals */
+	uint32_t mapper_size;
+	uint8_t* state;		/* peripherals', then the mapper's */
+
+	/* recording */
+	FILE* f;
+	uint64_t interval;
+	uint64_t last_cycle;
+
+	/* playback */
+	uint8_t* buf;
+	struct replay_input_t* inputs;
+	unsigned int num_inputs;
+	unsigned int next_input;
+	struct replay_checkpoint_t* checkpoints;
+	unsigned int num_checkpoints;
+	int64_t seek;
+	uint64_t target;
+};
+
+static void put_le(FILE* f, uint64_t val, unsigned int bytes) {
+	unsigned int i;
+
+	for (i = 0; i < bytes; i++)
+		fputc((uint8_t)(val >> (i * 8)), f);
+
+	return;
+}
+
+static uint64_t get_le(const uint8_t* ptr, unsigned int bytes) {
+	uint64_t val;
+	unsigned int i;
+
+	val = 0;
+
+	for (i = 0; i < bytes; i++)
+		val |= (uint64_t)ptr[i] << (i * 8);
+
+	return val;
+}
+
+#define for_each_saved_peripheral(device, peripheral, i) \
+	for (i = 0; i < (device)->num_of_peripherals; i++) \
+		if ((peripheral = (device)->peripherals[i])->state_size \
+		 && peripheral->save && peripheral->restore)
+
+static void write_checkpoint(struct device_t* device) {
+	struct replay_t* replay;
+	struct peripheral_t* peripheral;
+	uint8_t* state;
+	unsigned int i;
+
+	replay = device->replay;
+
+	ptracei("Checkpoint at cycle %llu.",
+		(unsigned long long)device->cycles);
+
+	fputc(REPLAY_CHECKPOINT, replay->f);
+	put_le(replay->f, device->cycles, 8);
+	put_le(replay->f, device->instr_count, 8);
+	fputc(device->cpu->A, replay->f);
+	fputc(device->cpu->X, replay->f);
+	fputc(device->cpu->Y, replay->f);
+	fputc(device->cpu->S, replay->f);
+	fputc(device->cpu->P, replay->f);
+	put_le(replay->f, device->cpu->PC, 2);
+	fputc(device->irq, replay->f);
+
+	state = replay->state;
+	for_each_saved_peripheral(device, peripheral, i) {
+		peripheral->save(peripheral, state);
+		state += peripheral->state_size;
+	}
+	if (device->mapper)
+		mapper_save(device->mapper, state);
+	fwrite(replay->state, 1, replay->state_size + replay->mapper_size,
+	       replay->f);
+
+	for (i = 0; i < replay->ram_size; i += PAGE_SIZE)
+		fwrite(&ram_byte(device, i), 1,
+		       replay->ram_size - i < PAGE_SIZE
+		       ? replay->ram_size - i : PAGE_SIZE, replay->f);
+
+	return;
+}
+
+static void checkpoint_event(struct device_t* device, void* data) {
+	struct replay_t* replay;
+
+	replay = data;
+
+	write_checkpoint(device);
+
+	device_schedule_passive(device, (device->cycles / replay->interval + 1)
+					* replay->interval, checkpoint_event,
+				replay);
+
+	return;
+}
+
+static struct replay_t* new_replay(struct device_t* device) {
+	struct replay_t* replay;
+	struct peripheral_t* peripheral;
+	unsigned int i;
+
+	if (device->replay) {
+		logp_err("Device is already recording or replaying.");
+		return NULL;
+	}
+
+	replay = calloc(1, sizeof(*replay));
+	if (!replay) {
+		logp_err("Could not allocate replay.");
+		return NULL;
+	}
+
+	replay->ram_size = device->ram.ram_size;
+	replay->seek = -1;
+
+	for_each_saved_peripheral(device, peripheral, i)
+		replay->state_size += peripheral->state_size;
+
+	if (device->mapper)
+		replay->mapper_size = mapper_state_size(device->mapper);
+
+	if (replay->state_size + replay->mapper_size) {
+		replay->state = malloc(replay->state_size + replay->mapper_size);
+		if (!replay->state) {
+			logp_err("Could not allocate peripheral state.");
+			free(replay);
+			return NULL;
+		}
+	}
+
+	return replay;
+}
+
+int replay_record(struct device_t* device, const char* path,
+		  uint64_t interval) {
+	struct replay_t* replay;
+
+	if (!interval) {
+		logp_err("Checkpoint interval must be positive.");
+		return -1;
+	}
+
+	replay = new_replay(device);
+	if (!replay)
+		return -1;
+
+	replay->f = fopen(path, "w");
+	if (!replay->f) {
+		logp_err("Could not open %s for recording.", path);
+		free(replay->state);
+		free(replay);
+		return -1;
+	}
+
+	replay->interval = interval;
+
+	fwrite(REPLAY_MAGIC, 1, 4, replay->f);
+	fputc(REPLAY_VERSION, replay->f);
+	put_le(replay->f, interval, 8);
+	put_le(replay->f, replay->ram_size, 4);
+	put_le(replay->f, replay->state_size, 4);
+	put_le(replay->f, replay->mapper_size, 4);
+
+	device->replay = replay;
+
+	return 0;
+}
+
+/* a journal cut short by a crash is still usable up to its last
+ * complete record, so parsing stops there instead of failing */
+static int parse_journal(struct replay_t* replay, unsigned int len) {
+	const uint8_t* ptr;
+	const uint8_t* end;
+	uint64_t cycle;
+	uint64_t delta;
+	unsigned int shift;
+	unsigned int max_inputs;
+	unsigned int max_checkpoints;
+
+	ptr = replay->buf + REPLAY_HEADER_SIZE;
+	end = replay->buf + len;
+	cycle = 0;
+
+	/* every input takes at least 4 bytes, every checkpoint more */
+	max_inputs = len / 4 + 1;
+	max_checkpoints = len / (CHECKPOINT_HEADER_SIZE + replay->state_size
+				 + replay->mapper_size + replay->ram_size) + 1;
+
+	replay->inputs = malloc(max_inputs * sizeof(*replay->inputs));
+	replay->checkpoints = malloc(max_checkpoints
+				     * sizeof(*replay->checkpoints));
+	if (!replay->inputs || !replay->checkpoints) {
+		logp_err("Could not allocate journal index.");
+		return -1;
+	}
+
+	while (ptr < end) {
+		switch (*ptr) {
+		case REPLAY_READ:
+			delta = 0;
+			shift = 0;
+
+			for (ptr++; ptr < end && (*ptr & 0x80); ptr++) {
+				delta |= (uint64_t)(*ptr & 0x7F) << shift;
+				shift += 7;
+			}
+
+			if (end - ptr < 4)
+				goto exit_parse_journal;
+
+			delta |= (uint64_t)(*(ptr++)) << shift;
+			cycle += delta;
+
+			replay->inputs[replay->num_inputs++] =
+				(struct replay_input_t) {
+					.cycle = cycle,
+					.addr = get_le(ptr, 2),
+					.val = ptr[2]
+				};
+			ptr += 3;
+			break;
+		case REPLAY_CHECKPOINT:
+			if (end - ptr < 1 + CHECKPOINT_HEADER_SIZE
+				      + replay->state_size + replay->mapper_size
+				      + replay->ram_size)
+				goto exit_parse_journal;
+
+			replay->checkpoints[replay->num_checkpoints++] =
+				(struct replay_checkpoint_t) {
+					.cycles = get_le(ptr + 1, 8),
+					.instrs = get_le(ptr + 9, 8),
+					.regs = ptr + 17,
+					.state = ptr + 1 + CHECKPOINT_HEADER_SIZE,
+					.mapper = ptr + 1 + CHECKPOINT_HEADER_SIZE
+						+ replay->state_size,
+					.ram = ptr + 1 + CHECKPOINT_HEADER_SIZE
+					     + replay->state_size
+					     + replay->mapper_size
+				};
+			ptr += 1 + CHECKPOINT_HEADER_SIZE + replay->state_size
+			     + replay->mapper_size + replay->ram_size;
+			break;
+		case REPLAY_END:
+			goto exit_parse_journal;
+		default:
+			logp_err("Invalid record type %.2x at offset %ld.",
+				 *ptr, (long)(ptr - replay->buf));
+			return -1;
+		}
+	}
+
+exit_parse_journal:
+
+	if (!replay->num_checkpoints) {
+		logp_err("Journal has no checkpoints.");
+		return -1;
+	}
+
+	ptracei("Journal has %u inputs and %u checkpoints.",
+		replay->num_inputs, replay->num_checkpoints);
+
+	return 0;
+}
+
+static void free_replay(struct replay_t* replay) {
+
+	if (replay->f)
+		fclose(replay->f);
+
+	free(replay->state);
+	free(replay->buf);
+	free(replay->inputs);
+	free(replay->checkpoints);
+	free(replay);
+
+	return;
+}
+
+int replay_play(struct device_t* device, const char* path, int64_t seek) {
+	struct replay_t* replay;
+	unsigned int len;
+
+	replay = new_replay(device);
+	if (!replay)
+		return -1;
+
+	replay->buf = load_file(path, &len);
+	if (!replay->buf) {
+		logp_err("Could not load journal %s.", path);
+		goto exit_replay_play;
+	}
+
+	if (len < REPLAY_HEADER_SIZE
+	 || memcmp(replay->buf, REPLAY_MAGIC, 4)
+	 || replay->buf[4] != REPLAY_VERSION) {
+		logp_err("%s is not a valid journal.", path);
+		goto exit_replay_play;
+	}
+
+	if (get_le(replay->buf + 13, 4) != replay->ram_size) {
+		logp_err("Journal RAM size (%u) does not match device (%u).",
+			 (unsigned int)get_le(replay->buf + 13, 4),
+			 replay->ram_size);
+		goto exit_replay_play;
+	}
+
+	if (get_le(replay->buf + 17, 4) != replay->state_size) {
+		logp_err("Journal peripheral state (%u bytes) does not match "
+			 "device (%u bytes).",
+			 (unsigned int)get_le(replay->buf + 17, 4),
+			 replay->state_size);
+		goto exit_replay_play;
+	}
+
+	if (get_le(replay->buf + 21, 4) != replay->mapper_size) {
+		logp_err("Journal mapper state (%u bytes) does not match "
+			 "device (%u bytes).",
+			 (unsigned int)get_le(replay->buf + 21, 4),
+			 replay->mapper_size);
+		goto exit_replay_play;
+	}
+
+	if (parse_journal(replay, len))
+		goto exit_replay_play;
+
+	replay->playing = true;
+	replay->seek = seek;
+	device->replay = replay;
+
+	return 0;
+
+exit_replay_play:
+
+	free_replay(replay);
+
+	return -1;
+}
+
+bool replay_playing(struct device_t* device) {
+
+	return device->replay && device->replay->playing;
+}
+
+static const struct replay_checkpoint_t* find_checkpoint(
+		struct replay_t* replay, uint64_t target, bool instr) {
+	unsigned int i;
+
+	for (i = 1; i < replay->num_checkpoints; i++)
+		if ((instr ? replay->checkpoints[i].instrs
+			   : replay->checkpoints[i].cycles) > target)
+			break;
+
+	return &(replay->checkpoints[i - 1]);
+}
+
+static void restore_checkpoint(struct device_t* device,
+			       const struct replay_checkpoint_t* cp) {
+	struct replay_t* replay;
+	struct peripheral_t* peripheral;
+	const uint8_t* state;
+	unsigned int lo;
+	unsigned int hi;
+	unsigned int i;
+
+	replay = device->replay;
+
+	ptracei("Restoring checkpoint at cycle %llu.",
+		(unsigned long long)cp->cycles);
+
+	device->cycles = cp->cycles;
+	device->instr_count = cp->instrs;
+	device->cpu->A = cp->regs[0];
+	device->cpu->X = cp->regs[1];
+	device->cpu->Y = cp->regs[2];
+	device->cpu->S = cp->regs[3];
+	device->cpu->P = cp->regs[4];
+	device->cpu->PC = get_le(cp->regs + 5, 2);
+
+	/* the windows show the banks they did before RAM is loaded
+	 * through them */
+	if (device->mapper)
+		mapper_restore(device->mapper, cp->mapper);
+
+	if (device_load_ram(device, 0, cp->ram, replay->ram_size)) {
+		logp_err("Could not restore RAM from checkpoint.");
+		device->error = DEVICE_OUT_OF_MEMORY;
+		device_request_stop(device, DEVICE_EXIT_ERROR, 0);
+		return;
+	}
+
+	/* peripherals schedule their events again; the lines saved are
+	 * the ones raised, also by peripherals without state */
+	state = cp->state;
+	for_each_saved_peripheral(device, peripheral, i) {
+		peripheral->restore(peripheral, state);
+		state += peripheral->state_size;
+	}
+
+	for (i = 0; i < device->num_of_peripherals; i++)
+		device_set_irq(device, device->peripherals[i],
+			       cp->regs[7] & ((uint8_t)1 << i));
+
+	/* first input made at or after the checkpoint */
+	lo = 0;
+	hi = replay->num_inputs;
+
+	while (lo < hi) {
+		if (replay->inputs[(lo + hi) / 2].cycle < cp->cycles)
+			lo = (lo + hi) / 2 + 1;
+		else
+			hi = (lo + hi) / 2;
+	}
+
+	replay->next_input = lo;
+
+	return;
+}
+
+static void seek_cycle_event(struct device_t* device, void* data) {
+
+	device_request_stop(device, DEVICE_EXIT_SEEK, device->cpu->PC);
+
+	return;
+}
+
+/* no instruction takes fewer than two cycles, so an event that many
+ * cycles away can never fire past the target instruction */
+static void seek_instr_event(struct device_t* device, void* data) {
+	struct replay_t* replay;
+
+	replay = data;
+
+	if (device->instr_count >= replay->target)
+		device_request_stop(device, DEVICE_EXIT_SEEK, device->cpu->PC);
+	else
+		device_schedule(device, device->cycles + 2
+				* (replay->target - device->instr_count),
+				seek_instr_event, replay);
+
+	return;
+}
+
+void replay_start(struct device_t* device) {
+	struct replay_t* replay;
+	uint64_t target;
+
+	replay = device->replay;
+
+	device_unschedule(device, checkpoint_event, replay);
+	device_unschedule(device, seek_cycle_event, replay);
+	device_unschedule(device, seek_instr_event, replay);
+
+	if (!replay->playing) {
+		replay->last_cycle = 0;
+		write_checkpoint(device);
+		device_schedule_passive(device, replay->interval,
+					checkpoint_event, replay);
+		return;
+	}
+
+	target = replay->seek >= 0 ? replay->seek : 0;
+
+	restore_checkpoint(device, find_checkpoint(replay, target, false));
+
+	if (replay->seek < 0)
+		return;
+
+	if (device->cycles < target)
+		device_schedule(device, target, seek_cycle_event, replay);
+	else
+		device_request_stop(device, DEVICE_EXIT_SEEK, device->cpu->PC);
+
+	return;
+}
+
+uint8_t replay_read(struct device_t* device, uint16_t addr) {
+	struct replay_t* replay;
+	struct replay_input_t* input;
+
+	replay = device->replay;
+
+	if (replay->next_input >= replay->num_inputs) {
+		ptracei("Journal exhausted at cycle %llu.",
+			(unsigned long long)device->cycles);
+		device_request_stop(device, DEVICE_EXIT_REPLAY_END, addr);
+		return 0;
+	}
+
+	input = &(replay->inputs[replay->next_input++]);
+
+	if (input->cycle != device->cycles || input->addr != addr) {
+		logp_err("Replay diverged at cycle %llu: read %.4x, "
+			 "journal has %.4x at cycle %llu.",
+			 (unsigned long long)device->cycles, addr,
+			 input->addr, (unsigned long long)input->cycle);
+		device->error = DEVICE_REPLAY_DIVERGED;
+		device_request_stop(device, DEVICE_EXIT_ERROR, addr);
+	}
+
+	return input->val;
+}
+
+void replay_log_read(struct device_t* device, uint16_t addr, uint8_t val) {
+	struct replay_t* replay;
+	uint64_t delta;
+
+	replay = device->replay;
+
+	delta = device->cycles - replay->last_cycle;
+	replay->last_cycle = device->cycles;
+
+	fputc(REPLAY_READ, replay->f);
+
+	while (delta >= 0x80) {
+		fputc((uint8_t)(delta | 0x80), replay->f);
+		delta >>= 7;
+	}
+
+	fputc((uint8_t)delta, replay->f);
+	put_le(replay->f, addr, 2);
+	fputc(val, replay->f);
+
+	return;
+}
+
+/* re-executes from the nearest checkpoint up to the given instruction;
+ * breakpoints and watchpoints on the way are passed over */
+int replay_seek(struct device_t* device, uint64_t instr,
+		bool end_on_last_instr) {
+	struct replay_t* replay;
+	int ret;
+
+	replay = device->replay;
+
+	if (!replay || !replay->playing) {
+		logp_err("Seeking needs a journal to replay.");
+		return -1;
+	}
+
+	ptracei("Seeking to instruction %llu.", (unsigned long long)instr);
+
+	restore_checkpoint(device, find_checkpoint(replay, instr, true));
+
+	if (device->instr_count >= instr) {
+		device->exit_reason = DEVICE_EXIT_SEEK;
+		return 0;
+	}
+
+	replay->target = instr;
+	device_unschedule(device, seek_instr_event, replay);
+	device_schedule(device, device->cycles
+			+ 2 * (instr - device->instr_count),
+			seek_instr_event, replay);
+
+	do {
+		ret = exec_device(device, end_on_last_instr, true);
+	} while (device->exit_reason == DEVICE_EXIT_BREAKPOINT
+	      || device->exit_reason == DEVICE_EXIT_WATCHPOINT);
+
+	device_unschedule(device, seek_instr_event, replay);
+
+	if (device->exit_reason != DEVICE_EXIT_SEEK)
+		return ret < 0 ? ret : -1;
+
+	return 0;
+}
+
+void replay_close(struct device_t* device) {
+	struct replay_t* replay;
+
+	replay = device->replay;
+	if (!replay)
+		return;
+
+	if (!replay->playing) {
+		fputc(REPLAY_END, replay->f);
+		put_le(replay->f, device->cycles, 8);
+		put_le(replay->f, device->instr_count, 8);
+	}
+
+	device_unschedule(device, checkpoint_event, replay);
+	device_unschedule(device, seek_cycle_event, replay);
+	device_unschedule(device, seek_instr_event, replay);
+
+	free_replay(replay);
+	device->replay = NULL;
+
+	return;
+}
@@ -0,0 +1,187 @@
+#include "result.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common.h"
+#include "device.h"
+
+#define RSIG "RES"
+
+#define logr_err(FMT, ...) log_err(RSIG, FMT, ## __VA_ARGS__)
+
+#define JSON_HEADER_SIZE 256
+#define JSON_REGION_SIZE 48
+
+result_format_t parse_result_format(const char* arg) {
+
+	if (!strcmp(arg, "text"))
+		return RESULT_FORMAT_TEXT;
+
+	if (!strcmp(arg, "json"))
+		return RESULT_FORMAT_JSON;
+
+	if (!strcmp(arg, "binary"))
+		return RESULT_FORMAT_BINARY;
+
+	return RESULT_FORMAT_INVALID;
+}
+
+#define region_len(mr) ((mr)->end_addr - (mr)->start_addr + 1)
+
+static uint8_t* put_le(uint8_t* ptr, uint64_t val, unsigned int bytes) {
+	unsigned int i;
+
+	for (i = 0; i < bytes; i++)
+		*(ptr++) = (uint8_t)(val >> (i * 8));
+
+	return ptr;
+}
+
+static unsigned int format_binary(struct device_t* device, int ret,
+				  struct mem_region_t* mrhead, char** out) {
+	struct mem_region_t* curr;
+	unsigned int size;
+	unsigned int regions;
+	uint8_t* ptr;
+
+	size = RESULT_HEADER_SIZE;
+	regions = 0;
+
+	for (curr = mrhead; curr; curr = curr->next) {
+		size += RESULT_REGION_HEADER_SIZE + region_len(curr);
+		regions++;
+	}
+
+	*out = malloc(size);
+	if (!(*out))
+		return 0;
+
+	ptr = (uint8_t*)(*out);
+
+	memcpy(ptr, RESULT_MAGIC, 4);
+	ptr += 4;
+	*(ptr++) = RESULT_VERSION;
+	*(ptr++) = device->cpu->A;
+	*(ptr++) = device->cpu->X;
+	*(ptr++) = device->cpu->Y;
+	*(ptr++) = device->cpu->S;
+	*(ptr++) = device->cpu->P;
+	ptr = put_le(ptr, device->cpu->PC, 2);
+	*(ptr++) = (uint8_t)device->exit_reason;
+	ptr = put_le(ptr, (uint32_t)ret, 4);
+	ptr = put_le(ptr, device->cycles, 8);
+	ptr = put_le(ptr, device->instr_count, 8);
+	ptr = put_le(ptr, regions, 2);
+
+	for (curr = mrhead; curr; curr = curr->next) {
+		ptr = put_le(ptr, curr->start_addr, 2);
+		ptr = put_le(ptr, region_len(curr), 4);
+		device_copy_ram(device, ptr, curr->start_addr,
+				region_len(curr));
+		ptr += region_len(curr);
+	}
+
+	return size;
+}
+
+static unsigned int format_json(struct device_t* device, int ret,
+				struct mem_region_t* mrhead, char** out) {
+	struct mem_region_t* curr;
+	unsigned int size;
+	uint8_t* buff;
+	char* ptr;
+
+	size = JSON_HEADER_SIZE;
+
+	for (curr = mrhead; curr; curr = curr->next)
+		size += JSON_REGION_SIZE + 2 * region_len(curr);
+
+	buff = malloc(MEM_MAX_ADDR + 1);
+	if (!buff)
+		return 0;
+
+	*out = malloc(size);
+	if (!(*out)) {
+		free(buff);
+		return 0;
+	}
+
+	ptr = *out;
+
+	ptr += sprintf(ptr, "{\"A\":%u,\"X\":%u,\"Y\":%u,\"S\":%u,\"P\":%u,"
+			    "\"PC\":%u,\"cycles\":%llu,\"instructions\":%llu,"
+			    "\"exit\":\"%s\",\"ret\":%d,\"mem\":[",
+		       device->cpu->A, device->cpu->X, device->cpu->Y,
+		       device->cpu->S, device->cpu->P, device->cpu->PC,
+		       (unsigned long long)device->cycles,
+		       (unsigned long long)device->instr_count,
+		       get_exit_reason_name(device->exit_reason), ret);
+
+	for (curr = mrhead; curr; curr = curr->next) {
+		ptr += sprintf(ptr, "%s{\"addr\":%u,\"data\":\"",
+			       curr == mrhead ? "" : ",", curr->start_addr);
+		device_copy_ram(device, buff, curr->start_addr,
+				region_len(curr));
+		ptr += format_hex_str(ptr, buff, region_len(curr));
+		*(ptr++) = '"';
+		*(ptr++) = '}';
+	}
+
+	*(ptr++) = ']';
+	*(ptr++) = '}';
+	*(ptr++) = '\n';
+
+	free(buff);
+
+	return ptr - *out;
+}
+
+int dump_result(struct device_t* device, int ret,
+		const result_opts_t* ropts) {
+	unsigned int size;
+	char* out;
+	FILE* f;
+
+	out = NULL;
+
+	switch (ropts->format) {
+	case RESULT_FORMAT_JSON:
+		size = format_json(device, ret, ropts->mrhead, &out);
+		break;
+	case RESULT_FORMAT_BINARY:
+		size = format_binary(device, ret, ropts->mrhead, &out);
+		break;
+	default:
+		logr_err("Invalid result format (%d).", ropts->format);
+		return -1;
+	}
+
+	if (!out) {
+		logr_err("Could not allocate memory for result.");
+		return -1;
+	}
+
+	f = ropts->outfile ? fopen(ropts->outfile, "w") : stdout;
+	if (!f) {
+		logr_err("Could not open %s for output.", ropts->outfile);
+		free(out);
+		return -1;
+	}
+
+	if (fwrite(out, 1, size, f) != size) {
+		logr_err("Error writing result.");
+		ret = -1;
+	}
+	else
+		ret = 0;
+
+	if (f != stdout)
+		fclose(f);
+	else
+		fflush(stdout);
+
+	free(out);
+
+	return ret;
+}
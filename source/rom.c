@@ -0,0 +1,163 @@
+#include "rom.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "aot.h"
+
+#define OSIG "ROM"
+
+#define logo_err(FMT, ...) log_err(OSIG, FMT, ## __VA_ARGS__)
+
+#ifdef ROM_TRACE
+#define otracei(FMT, ...) tracei(OSIG, FMT, ## __VA_ARGS__)
+#else
+#define otracei(FMT, ...) ;
+#endif
+
+/* open images; devices may be created from more than one thread */
+static struct rom_t* rom_cache = NULL;
+static pthread_mutex_t rom_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct rom_t* find_rom(uint32_t hash, const uint8_t* mem,
+			      unsigned int size) {
+	struct rom_t* rom;
+
+	for (rom = rom_cache; rom; rom = rom->next)
+		if (rom->hash == hash && rom->size == size
+		 && !memcmp(rom->mem, mem, size))
+			return rom;
+
+	return NULL;
+}
+
+/* the mapping is rounded up to host pages, which the kernel fills with
+ * zeros past the end of the file, so a last partial 256-byte page can
+ * be shown as it is */
+struct rom_t* rom_open(const char* infile) {
+	struct rom_t* rom;
+	struct stat st;
+	uint8_t* mem;
+	uint32_t hash;
+	int fd;
+
+	fd = open(infile, O_RDONLY);
+	if (fd < 0) {
+		logo_err("Could not open %s.", infile);
+		return NULL;
+	}
+
+	if (fstat(fd, &st) || st.st_size <= 0
+	 || st.st_size > MEM_MAX_ADDR + 1) {
+		logo_err("%s is empty or does not fit in memory.", infile);
+		close(fd);
+		return NULL;
+	}
+
+	mem = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (mem == MAP_FAILED) {
+		logo_err("Could not map %s.", infile);
+		return NULL;
+	}
+
+	hash = aot_hash(mem, st.st_size);
+
+	pthread_mutex_lock(&rom_cache_lock);
+
+	rom = find_rom(hash, mem, st.st_size);
+	if (rom) {
+		rom->refs++;
+		pthread_mutex_unlock(&rom_cache_lock);
+		munmap(mem, st.st_size);
+
+		otracei("Sharing %s (%.8x, %u users).", infile, hash,
+			rom->refs);
+
+		return rom;
+	}
+
+	rom = malloc(sizeof(*rom));
+	if (!rom) {
+		pthread_mutex_unlock(&rom_cache_lock);
+		logo_err("Could not allocate ROM image.");
+		munmap(mem, st.st_size);
+		return NULL;
+	}
+
+	*rom = (struct rom_t) {
+		.hash = hash,
+		.mem = mem,
+		.size = st.st_size,
+		.refs = 1,
+		.next = rom_cache
+	};
+
+	rom_cache = rom;
+
+	pthread_mutex_unlock(&rom_cache_lock);
+
+	otracei("Mapped %s (%.8x, %u bytes).", infile, hash, rom->size);
+
+	return rom;
+}
+
+/* ADDR:FILE, like a RAM image */
+struct rom_t* parse_rom(const char* arg, uint16_t* addr) {
+	const char* sep;
+	char field[8];
+	int val;
+
+	sep = strchr(arg, ':');
+	if (!sep || sep - arg >= (int)sizeof(field) || !sep[1]) {
+		logo_err("Invalid argument: %s.", arg);
+		return NULL;
+	}
+
+	memcpy(field, arg, sep - arg);
+	field[sep - arg] = '\0';
+
+	val = parse_str(field, 16, NULL);
+	if (val < 0 || val > MEM_MAX_ADDR) {
+		logo_err("Invalid argument: %s.", arg);
+		return NULL;
+	}
+
+	*addr = val;
+
+	return rom_open(sep + 1);
+}
+
+void rom_close(struct rom_t* rom) {
+	struct rom_t** curr;
+
+	pthread_mutex_lock(&rom_cache_lock);
+
+	if (--rom->refs) {
+		pthread_mutex_unlock(&rom_cache_lock);
+		return;
+	}
+
+	for (curr = &rom_cache; *curr; curr = &((*curr)->next)) {
+		if (*curr == rom) {
+			*curr = rom->next;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&rom_cache_lock);
+
+	munmap((void*)rom->mem, rom->size);
+	free(rom);
+
+	return;
+}
@@ -0,0 +1,331 @@
+#include "system.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "device.h"
+
+#define YSIG "SYS"
+
+#define logy_err(FMT, ...) log_err(YSIG, FMT, ## __VA_ARGS__)
+
+#ifdef SYSTEM_TRACE
+#define ytracei(FMT, ...) tracei(YSIG, FMT, ## __VA_ARGS__)
+#else
+#define ytracei(FMT, ...) ;
+#endif
+
+/* the first CPU is the device the system is built around; with no
+ * budget at all, slices are SYSTEM_DEFAULT_SLICE cycles */
+void init_system(struct system_t* system, struct device_t* device,
+		 uint64_t budget, uint64_t instr_budget) {
+
+	memset(system, 0, sizeof(*system));
+
+	system->cpus[0] = (struct system_cpu_t) {
+		.device = device,
+		.budget = budget || instr_budget ? budget
+						 : SYSTEM_DEFAULT_SLICE,
+		.instr_budget = instr_budget,
+		.system = system
+	};
+
+	system->num_cpus = 1;
+
+	pthread_mutex_init(&system->lock, NULL);
+	pthread_cond_init(&system->cond, NULL);
+
+	return;
+}
+
+/* a CPU like the first one, starting at start_addr; compiled code is
+ * detached from the first one, as it would not see the others write */
+int system_add_cpu(struct system_t* system, uint16_t start_addr,
+		   uint64_t budget, uint64_t instr_budget) {
+	struct device_t* bus;
+	struct device_t* device;
+	cpu_6502_t* cpu;
+	int ret;
+
+	if (system->num_cpus == SYSTEM_MAX_CPUS) {
+		logy_err("No more than %d CPUs.", SYSTEM_MAX_CPUS);
+		return -1;
+	}
+
+	bus = system->cpus[0].device;
+
+	device = malloc(sizeof(*device));
+	cpu = malloc(sizeof(*cpu));
+	if (!device || !cpu) {
+		logy_err("Could not allocate CPU %u.", system->num_cpus);
+		free(device);
+		free(cpu);
+		return -1;
+	}
+
+	*cpu = *(bus->cpu);
+
+	init_device(device, cpu, start_addr, bus->stack_addr,
+		    bus->ram.ram_size);
+
+	device_detach_aot(bus);
+
+	ret = device_share_bus(device, bus);
+	if (ret) {
+		logy_err("Could not share memory with CPU %u.",
+			 system->num_cpus);
+		free_device(device);
+		free(device);
+		free(cpu);
+		return ret;
+	}
+
+	system->cpus[system->num_cpus] = (struct system_cpu_t) {
+		.device = device,
+		.budget = budget || instr_budget ? budget
+						 : SYSTEM_DEFAULT_SLICE,
+		.instr_budget = instr_budget,
+		.system = system
+	};
+
+	ytracei("CPU %u starts at %.4x.", system->num_cpus, start_addr);
+
+	system->num_cpus++;
+
+	return 0;
+}
+
+/* ADDR[,ADDR...]; returns the number of addresses */
+int parse_cpu_addrs(const char* arg, uint16_t* addrs, unsigned int max) {
+	char* str;
+	char* tok;
+	int count;
+	int val;
+
+	str = strdup(arg);
+	if (!str) {
+		logy_err("Could not allocate memory for %s.", arg);
+		return -1;
+	}
+
+	count = 0;
+
+	for (tok = strtok(str, ","); tok; tok = strtok(NULL, ",")) {
+		val = parse_str(tok, 16, NULL);
+		if (val < 0 || val > MEM_MAX_ADDR || count == max) {
+			logy_err("Invalid argument: %s.", arg);
+			count = -1;
+			break;
+		}
+
+		addrs[count++] = val;
+	}
+
+	free(str);
+
+	return count;
+}
+
+static bool runs_alone(struct system_t* system, struct system_cpu_t* sc) {
+	unsigned int i;
+
+	for (i = 0; i < system->num_cpus; i++)
+		if (&system->cpus[i] != sc && !system->cpus[i].stopped)
+			return false;
+
+	return true;
+}
+
+/* only the first CPU ends on the last instruction of the binary; the
+ * last CPU running needs no slices, so an idle loop in it can end */
+static void run_slice(struct system_cpu_t* sc, bool alone) {
+	struct system_t* system;
+	struct device_t* device;
+
+	if (sc->stopped)
+		return;
+
+	system = sc->system;
+	device = sc->device;
+
+	switch (device_run_slice(device, alone ? 0 : sc->budget,
+				 alone ? 0 : sc->instr_budget,
+				 sc == &system->cpus[0]
+				 && system->end_on_last_instr,
+				 &sc->ret)) {
+	case DEVICE_EXIT_SLICE:
+	case DEVICE_EXIT_INSTR_LIMIT:
+		break;
+	default:
+		sc->stopped = true;
+		break;
+	}
+
+	return;
+}
+
+static void* cpu_thread(void* data) {
+	struct system_cpu_t* sc;
+	struct system_t* system;
+	unsigned int generation;
+
+	sc = data;
+	system = sc->system;
+	generation = 0;
+
+	while (true) {
+		pthread_mutex_lock(&system->lock);
+
+		while (system->generation == generation)
+			pthread_cond_wait(&system->cond, &system->lock);
+
+		generation = system->generation;
+
+		if (system->stopping) {
+			pthread_mutex_unlock(&system->lock);
+			break;
+		}
+
+		pthread_mutex_unlock(&system->lock);
+
+		/* the first CPU runs as long as the threads do */
+		run_slice(sc, false);
+
+		pthread_mutex_lock(&system->lock);
+
+		if (!(--system->pending))
+			pthread_cond_broadcast(&system->cond);
+
+		pthread_mutex_unlock(&system->lock);
+	}
+
+	return NULL;
+}
+
+static void stop_threads(struct system_t* system) {
+	unsigned int i;
+
+	pthread_mutex_lock(&system->lock);
+	system->stopping = true;
+	system->generation++;
+	pthread_cond_broadcast(&system->cond);
+	pthread_mutex_unlock(&system->lock);
+
+	for (i = 1; i < system->num_cpus; i++) {
+		if (system->cpus[i].has_thread) {
+			pthread_join(system->cpus[i].thread, NULL);
+			system->cpus[i].has_thread = false;
+		}
+	}
+
+	return;
+}
+
+/* the calling thread runs the first CPU; falls back to taking turns if
+ * the threads cannot be started */
+static void run_threaded(struct system_t* system) {
+	unsigned int i;
+	bool alone;
+
+	system->stopping = false;
+
+	for (i = 1; i < system->num_cpus; i++) {
+		if (pthread_create(&system->cpus[i].thread, NULL, cpu_thread,
+				   &system->cpus[i])) {
+			logy_err("Could not start thread for CPU %u, "
+				 "taking turns instead.", i);
+			stop_threads(system);
+			return;
+		}
+
+		system->cpus[i].has_thread = true;
+	}
+
+	while (!system->cpus[0].stopped) {
+		alone = runs_alone(system, &system->cpus[0]);
+
+		pthread_mutex_lock(&system->lock);
+		system->pending = system->num_cpus - 1;
+		system->generation++;
+		pthread_cond_broadcast(&system->cond);
+		pthread_mutex_unlock(&system->lock);
+
+		run_slice(&system->cpus[0], alone);
+
+		pthread_mutex_lock(&system->lock);
+
+		while (system->pending)
+			pthread_cond_wait(&system->cond, &system->lock);
+
+		pthread_mutex_unlock(&system->lock);
+	}
+
+	stop_threads(system);
+
+	return;
+}
+
+/* runs until the first CPU stops, and reports on it like run_device */
+int run_system(struct system_t* system, bool end_on_last_instr,
+	       bool threaded, const result_opts_t* ropts) {
+	unsigned int i;
+
+	system->end_on_last_instr = end_on_last_instr;
+
+	/* peripherals keep state of their own, e.g. a timer's events on
+	 * the first CPU's device, and a bank switch repoints every CPU's
+	 * pages, which CPU threads would race on */
+	if (threaded && system->num_cpus > 1
+	 && (system->cpus[0].device->num_of_peripherals
+	  || system->cpus[0].device->mapper
+	  || system->cpus[0].device->read || system->cpus[0].device->write)) {
+		logy_err("CPU threads cannot share peripherals.");
+		return -1;
+	}
+
+	for (i = 0; i < system->num_cpus; i++) {
+		start_device(system->cpus[i].device);
+		system->cpus[i].ret = 0;
+		system->cpus[i].stopped = false;
+	}
+
+	if (threaded && system->num_cpus > 1)
+		run_threaded(system);
+
+	while (!system->cpus[0].stopped)
+		for (i = 0; i < system->num_cpus
+			    && !system->cpus[0].stopped; i++)
+			run_slice(&system->cpus[i],
+				  runs_alone(system, &system->cpus[i]));
+
+	for (i = 1; i < system->num_cpus; i++)
+		ytracei("CPU %u: %s (PC=%.4x, %llu cycles).", i,
+			get_exit_reason_name(
+				system->cpus[i].device->exit_reason),
+			system->cpus[i].device->cpu->PC,
+			(unsigned long long)system->cpus[i].device->cycles);
+
+	report_device(system->cpus[0].device, system->cpus[0].ret, ropts);
+
+	return system->cpus[0].ret;
+}
+
+/* the first CPU belongs to the caller */
+void free_system(struct system_t* system) {
+	unsigned int i;
+
+	for (i = 1; i < system->num_cpus; i++) {
+		free_device(system->cpus[i].device);
+		free(system->cpus[i].device->cpu);
+		free(system->cpus[i].device);
+	}
+
+	system->num_cpus = 1;
+
+	pthread_mutex_destroy(&system->lock);
+	pthread_cond_destroy(&system->cond);
+
+	return;
+}
@@ -0,0 +1,216 @@
+#include "timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define ISIG "TMR"
+
+#define logi_err(FMT, ...) log_err(ISIG, FMT, ## __VA_ARGS__)
+
+#ifdef TIMER_TRACE
+#define itracei(FMT, ...) tracei(ISIG, FMT, ## __VA_ARGS__)
+#else
+#define itracei(FMT, ...) ;
+#endif
+
+#define timer_period(timer) \
+	((timer)->period ? (uint64_t)(timer)->period : (uint64_t)0x10000)
+
+/* control, status, latch, period (2) and due (8) */
+#define TIMER_STATE_SIZE 13
+
+static void timer_update_irq(struct interval_timer_t* timer) {
+
+	device_set_irq(timer->peripheral.device, &timer->peripheral,
+		       (timer->status & TIMER_EXPIRED)
+		       && (timer->control & TIMER_IRQ));
+
+	return;
+}
+
+static void timer_expire(struct device_t* device, void* data);
+
+static void timer_schedule(struct interval_timer_t* timer) {
+
+	if (device_schedule(timer->peripheral.device, timer->due,
+			    timer_expire, timer) < 0) {
+		logi_err("Timer at %.4x stopped.",
+			 timer->peripheral.addr_start);
+		timer->control &= ~TIMER_ENABLE;
+	}
+
+	return;
+}
+
+/* an expiry the CPU did not get to see, e.g. while an idle loop was
+ * skipped, only sets the status again, as it would on the hardware */
+static void timer_expire(struct device_t* device, void* data) {
+	struct interval_timer_t* timer;
+
+	timer = data;
+
+	itracei("Timer at %.4x expired on cycle %llu.",
+		timer->peripheral.addr_start, (unsigned long long)timer->due);
+
+	timer->status |= TIMER_EXPIRED;
+
+	if (timer->control & TIMER_ONE_SHOT)
+		timer->control &= ~TIMER_ENABLE;
+	else {
+		timer->due += ((device->cycles - timer->due)
+			     / timer_period(timer) + 1) * timer_period(timer);
+		timer_schedule(timer);
+	}
+
+	timer_update_irq(timer);
+
+	return;
+}
+
+static uint8_t timer_read(struct peripheral_t* peripheral, uint16_t addr) {
+	struct interval_timer_t* timer;
+	uint64_t left;
+
+	timer = peripheral->data;
+
+	switch (addr - peripheral->addr_start) {
+	case TIMER_CONTROL:
+		return timer->control;
+	case TIMER_STATUS:
+		return timer->status;
+	case TIMER_COUNT_LO:
+		if (!(timer->control & TIMER_ENABLE))
+			left = timer_period(timer);
+		else if (timer->due > peripheral->device->cycles)
+			left = timer->due - peripheral->device->cycles;
+		else
+			left = 0;
+
+		/* 65536 cycles left reads as 0, like a period of 0 */
+		timer->latch = (uint8_t)(left >> 8);
+		return (uint8_t)left;
+	default:
+		return timer->latch;
+	}
+}
+
+static void timer_write(struct peripheral_t* peripheral, uint16_t addr,
+			uint8_t val) {
+	struct interval_timer_t* timer;
+
+	timer = peripheral->data;
+
+	switch (addr - peripheral->addr_start) {
+	case TIMER_CONTROL:
+		device_unschedule(peripheral->device, timer_expire, timer);
+
+		timer->control = val;
+
+		if (timer->control & TIMER_ENABLE) {
+			timer->due = peripheral->device->cycles
+				   + timer_period(timer);
+			timer_schedule(timer);
+		}
+		break;
+	case TIMER_STATUS:
+		timer->status = 0;
+		break;
+	case TIMER_COUNT_LO:
+		timer->period = (timer->period & 0xff00) | val;
+		break;
+	default:
+		timer->period = (timer->period & 0x00ff) | (uint16_t)val << 8;
+		break;
+	}
+
+	timer_update_irq(timer);
+
+	return;
+}
+
+static void timer_save(struct peripheral_t* peripheral, uint8_t* state) {
+	struct interval_timer_t* timer;
+	unsigned int i;
+
+	timer = peripheral->data;
+
+	state[0] = timer->control;
+	state[1] = timer->status;
+	state[2] = timer->latch;
+	state[3] = (uint8_t)timer->period;
+	state[4] = (uint8_t)(timer->period >> 8);
+	for (i = 0; i < 8; i++)
+		state[5 + i] = (uint8_t)(timer->due >> (i * 8));
+
+	return;
+}
+
+/* the expiry is scheduled again from due, as it was when saved */
+static void timer_restore(struct peripheral_t* peripheral,
+			  const uint8_t* state) {
+	struct interval_timer_t* timer;
+	unsigned int i;
+
+	timer = peripheral->data;
+
+	device_unschedule(peripheral->device, timer_expire, timer);
+
+	timer->control = state[0];
+	timer->status = state[1];
+	timer->latch = state[2];
+	timer->period = state[3] | (uint16_t)state[4] << 8;
+	timer->due = 0;
+	for (i = 0; i < 8; i++)
+		timer->due |= (uint64_t)state[5 + i] << (i * 8);
+
+	if (timer->control & TIMER_ENABLE)
+		timer_schedule(timer);
+
+	timer_update_irq(timer);
+
+	return;
+}
+
+/* stopped, with a period of 65536 cycles */
+struct interval_timer_t* new_timer(uint16_t addr) {
+	struct interval_timer_t* timer;
+
+	if (addr > MEM_MAX_ADDR - (TIMER_REGS - 1)) {
+		logi_err("Timer at %.4x does not fit in memory.", addr);
+		return NULL;
+	}
+
+	timer = calloc(1, sizeof(*timer));
+	if (!timer) {
+		logi_err("Could not allocate timer.");
+		return NULL;
+	}
+
+	timer->peripheral = (struct peripheral_t) {
+		.addr_start = addr,
+		.addr_end = addr + TIMER_REGS - 1,
+		.read = timer_read,
+		.write = timer_write,
+		.state_size = TIMER_STATE_SIZE,
+		.save = timer_save,
+		.restore = timer_restore,
+		.data = timer
+	};
+
+	itracei("Timer at %.4x.", addr);
+
+	return timer;
+}
+
+void free_timer(struct interval_timer_t* timer) {
+
+	if (timer->peripheral.device)
+		device_unschedule(timer->peripheral.device, timer_expire,
+				  timer);
+
+	free(timer);
+
+	return;
+}
@@ -383,6 +383,8 @@ static void remove_pending_label(struct instr_el_t* iel) {
 
 static int translate_instr(translator_t* trans, struct instr_el_t* iel,
 			   uint8_t mcode[MAX_INSTR_LENGTH]) {
+	uint16_t arg;
+	int offset;
 	int ret;
 
 	if (iel->label_pending) {
@@ -402,15 +404,30 @@ static int translate_instr(translator_t* trans, struct instr_el_t* iel,
 		}
 	}
 
+	arg = iel->arg;
+
+	/* branches are written with the address they go to, and take the
+	 * offset from the next instruction */
+	if (opdesc_mode(&(get_opdesc_table()[iel->opcode])) == MODE_BRANCH) {
+		offset = (int)iel->arg - (int)(iel->addr + iel->length);
+		if (offset < INT8_MIN || offset > INT8_MAX) {
+			logt_err("Branch to %.4x is out of range.", iel->arg);
+
+			return TRANS_ERROR_FAIL;
+		}
+
+		arg = (uint8_t)offset;
+	}
+
 	mcode[0] = (uint8_t)iel->opcode;
 
 	switch (iel->length) {
 	case 2:
-		mcode[1] = (uint8_t)(iel->arg & 0xFF);
+		mcode[1] = (uint8_t)(arg & 0xFF);
 		break;
 	case 3:
-		mcode[1] = (uint8_t)(iel->arg & 0xFF);
-		mcode[2] = (uint8_t)((iel->arg & 0xFF00) >> 8);
+		mcode[1] = (uint8_t)(arg & 0xFF);
+		mcode[2] = (uint8_t)((arg & 0xFF00) >> 8);
 		break;
 	default:
 		break;
@@ -544,10 +561,10 @@ end_get_arg:
 
 static int get_length_set_opcode(struct instr_el_t* new_instr,
 				 instr_mode_t mode) {
-	subinstr_t* s;
+	opcode_t opcode;
 	int ret;
 
-	if (!get_subinstr(new_instr->name, mode, &s)) {
+	if (!find_opcode(new_instr->name, mode, &opcode)) {
 		logt_err("Opcode for %c%c%c not found",
 			 instr_name_to_chars(new_instr));
 		ret = -1;
@@ -555,18 +572,19 @@ static int get_length_set_opcode(struct instr_el_t* new_instr,
 	else {
 		ttrace("Setting opcode for %c%c%c",
 			instr_name_to_chars(new_instr));
-		new_instr->opcode = s->opcode;
-		ret = s->length;
+		new_instr->opcode = opcode;
+		ret = opdesc_length(&(get_opdesc_table()[opcode]));
 	}
 
 	return ret;
 }
 
-#define set_label_pending(new_instr, buff) \
+#define set_label_pending(new_instr, buff) do { \
 	ttrace("Setting label of size %lu", strlen(buff)); \
 	(new_instr)->label_pending = malloc(strlen(buff) + 1); \
 	memcpy((new_instr)->label_pending, buff, strlen(buff)); \
-	(new_instr)->label_pending[strlen(buff)] = 0;
+	(new_instr)->label_pending[strlen(buff)] = 0; \
+} while (0)
 
 static int handle_arg(translator_t* trans, struct instr_el_t* new_instr,
 		      const char* str) {
@@ -600,25 +618,35 @@ static int handle_arg(translator_t* trans, struct instr_el_t* new_instr,
 		goto end_handle_arg;
 	}
 
-	REGEXEC(gen_re) {
+	REGEXEC(inx_re) {
 		get_pmatch_to(match_buff, 1);
 		check_pmatch(end_handle_arg);
-		ttrace("Zero page / Absolute: %s", match_buff);
-		set_new_instr_arg(match_buff);
+		ttrace("Indirect X: %s", match_buff);
 
-		if (ret != TRANS_ERROR_MAYBE_LABEL) {
-			mode = (new_instr->arg & 0xFF00)
-			     ? MODE_ABSOLUTE : MODE_ZERO_PAGE; }
-		else {
-			mode = MODE_ABSOLUTE;
+		set_new_instr_arg(match_buff);
+		mode = MODE_INDIRECT_X;
+		if (ret == TRANS_ERROR_MAYBE_LABEL)
 			set_label_pending(new_instr, match_buff);
-		}
 
 		ret = get_length_set_opcode(new_instr, mode);
 
 		goto end_handle_arg;
 	}
 
+	REGEXEC(iny_re) {
+		get_pmatch_to(match_buff, 1);
+		check_pmatch(end_handle_arg);
+		ttrace("Indirect Y: %s", match_buff);
+
+		set_new_instr_arg(match_buff);
+		mode = MODE_INDIRECT_Y;
+		if (ret == TRANS_ERROR_MAYBE_LABEL)
+			set_label_pending(new_instr, match_buff);
+		ret = get_length_set_opcode(new_instr, mode);
+
+		goto end_handle_arg;
+	}
+
 	REGEXEC(gxy_re) {
 		get_pmatch_to(match_buff, 1);
 		check_pmatch(end_handle_arg);
@@ -648,30 +676,20 @@ static int handle_arg(translator_t* trans, struct instr_el_t* new_instr,
 		goto end_handle_arg;
 	}
 
-	REGEXEC(inx_re) {
+	REGEXEC(gen_re) {
 		get_pmatch_to(match_buff, 1);
 		check_pmatch(end_handle_arg);
-		ttrace("Indirect X: %s", match_buff);
-
+		ttrace("Zero page / Absolute: %s", match_buff);
 		set_new_instr_arg(match_buff);
-		mode = MODE_INDIRECT_X;
-		if (ret == TRANS_ERROR_MAYBE_LABEL)
-			set_label_pending(new_instr, match_buff);
-
-		ret = get_length_set_opcode(new_instr, mode);
 
-		goto end_handle_arg;
-	}
-
-	REGEXEC(iny_re) {
-		get_pmatch_to(match_buff, 1);
-		check_pmatch(end_handle_arg);
-		ttrace("Indirect Y: %s", match_buff);
-
-		set_new_instr_arg(match_buff);
-		mode = MODE_INDIRECT_Y;
-		if (ret == TRANS_ERROR_MAYBE_LABEL)
+		if (ret != TRANS_ERROR_MAYBE_LABEL) {
+			mode = (new_instr->arg & 0xFF00)
+			     ? MODE_ABSOLUTE : MODE_ZERO_PAGE; }
+		else {
+			mode = MODE_ABSOLUTE;
 			set_label_pending(new_instr, match_buff);
+		}
+
 		ret = get_length_set_opcode(new_instr, mode);
 
 		goto end_handle_arg;
@@ -779,7 +797,7 @@ static int handle_line(translator_t* trans, const char* str) {
 		ttrace("Simple instruction: %s", match_buff);
 		set_instr_name(new_instr, match_buff);
 
-		ret = get_length_set_opcode(new_instr, 0);
+		ret = get_length_set_opcode(new_instr, MODE_IMPLIED);
 		check_pmatch(end_handle_line);
 		update_addr_and_length(trans, new_instr, ret);
 
@@ -1064,6 +1082,9 @@ static int add_string(struct disasm_list_t** head,
 	case MODE_IMMEDIATE:
 		print_to_str(&instr_part, &size, "%s #$%s", name, arg_part);
 		break;
+	case MODE_BRANCH:
+		print_to_str(&instr_part, &size, "%s $%.4x", name, arg);
+		break;
 	default:
 		if (instr_len > 1)
 			print_to_str(&instr_part, &size, "%s $%s", name, arg_part);
@@ -1138,8 +1159,11 @@ static void free_disasm_list(struct disasm_list_t* head) {
 	return;
 }
 
-int disassemble(const char* infile, instr_map_t* map,
-		disasm_mode_t disasm_mode) {
+/* branches are shown with the address they go to, as the translator
+ * takes them, so the output assembles back to the same bytes when
+ * loaded at load_addr */
+int disassemble(const char* infile, const opdesc_t* opdesc,
+		disasm_mode_t disasm_mode, uint16_t load_addr) {
 	uint8_t* bytes;
 	unsigned int len;
 	unsigned int i, j;
@@ -1165,15 +1189,16 @@ int disassemble(const char* infile, instr_map_t* map,
 		j = i;
 		opc = bytes[i++];
 
-		if (!map[opc].instr) {
+		if (!opdesc_valid(&(opdesc[opc]))) {
 			logt_err("Invalid opcode: %.2x", opc);
 			free(bytes);
 			return -1;
 		}
 
-		memcpy(name, map[opc].instr->name, 3);
-		switch (map[opc].subinstr->length) {
+		memcpy(name, opdesc_name(&(opdesc[opc])), 3);
+		switch (opdesc_length(&(opdesc[opc]))) {
 		case 1:
+			arg = 0;
 			break;
 		case 2:
 			arg = (uint16_t)bytes[i++];
@@ -1184,15 +1209,18 @@ int disassemble(const char* infile, instr_map_t* map,
 			break;
 		default:
 			logt_err("Invalid length (%u) for %s (0x%.2x).",
-				 map[opc].subinstr->length, name, opc);
+				 opdesc_length(&(opdesc[opc])), name, opc);
 			free(bytes);
 			return -1;
 		}
 
+		if (opdesc_mode(&(opdesc[opc])) == MODE_BRANCH)
+			arg = (uint16_t)(load_addr + i + (int8_t)arg);
+
 		ret = add_string(&head, &last, disasm_mode,
 				 name, arg, &(bytes[j]),
-				 map[opc].subinstr->length,
-				 map[opc].subinstr->mode & 0xF);
+				 opdesc_length(&(opdesc[opc])),
+				 opdesc_mode(&(opdesc[opc])));
 		if (ret)
 			goto exit_disasm;
 	}
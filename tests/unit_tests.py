@@ -5,6 +5,7 @@ import subprocess
 import os
 import tempfile
 import re
+import json
 import textwrap
 
 class Logger():
@@ -26,35 +27,29 @@ class Logger():
         return '(!) {}'.format(message)
 
     @staticmethod
-    def exct(message):
+    def exct(test, message):
         return Logger.exc('[{}] {}'.format(test, message))
 
 class Sikso2CPU():
-    cpu_pre_re = re.compile('^.*Dumping CPU registers.*$')
-    cpu_onl_re = re.compile('^(A): ([0-9a-f].) (X): ([0-9a-f].) '
-                             '(Y): ([0-9a-f].) (S): ([0-9a-f].) '
-                             '(P): ([0-9a-f].) (PC): ([0-9a-f]...)$')
+    registers = ['A', 'X', 'Y', 'S', 'P', 'PC']
 
     def __init__(self):
-        self.match = None
+        self.result = {}
         self.cpu_data = {}
 
     @staticmethod
-    def cpu_data_next(line):
-        return True if Sikso2CPU.cpu_pre_re.match(line) else False
+    def is_result(line):
+        return line.startswith('{')
 
     def get_cpu_data(self, line):
-        self.match = Sikso2CPU.cpu_onl_re.match(line)
-
-        if not self.match:
-            return
 
         if self.cpu_data:
             raise Exception(Logger.exc('CPU data already filled in.'))
 
-        for each in range(1, 7):
-            self.cpu_data[self.match.group(2 * each - 1)] \
-                    = int(self.match.group(2 * each), 16)
+        self.result = json.loads(line)
+
+        for reg in Sikso2CPU.registers:
+            self.cpu_data[reg] = self.result[reg]
 
         return
 
@@ -87,10 +82,9 @@ class Sikso2Code():
 
         for line in self.res:
 
-            if self.got_cpu_data:
+            if Sikso2CPU.is_result(line):
                 self.sikso2cpu.get_cpu_data(line)
-            elif Sikso2CPU.cpu_data_next(line):
-                    self.got_cpu_data = True
+                self.got_cpu_data = True
 
         if not self.got_cpu_data:
             raise Exception(Logger.exct(self.name, 'Could not find CPU data.'))
@@ -132,9 +126,32 @@ class Sikso2Code():
         subprocess.run(['make', 'CONFIG_FILE=tests/config_unit_tests.txt'],
                 capture_output=True)
 
+    @staticmethod
+    def make_aot(contents):
+        fd, path = tempfile.mkstemp()
+        bin_path = path + '.bin'
+        c_path = path + '.c'
+
+        try:
+            with os.fdopen(fd, 'w') as tmp:
+                tmp.write(contents)
+
+            subprocess.run(['./sikso2', '-t', path, '-o', bin_path],
+                    capture_output=True)
+            subprocess.run(['./sikso2', '-A', bin_path, '-o', c_path],
+                    capture_output=True)
+            subprocess.run(['make', 'clean'], capture_output=True)
+            subprocess.run(['make', 'CONFIG_FILE=tests/config_unit_tests.txt',
+                'AOT=' + c_path], capture_output=True)
+
+        finally:
+            for p in [path, bin_path, c_path]:
+                if os.path.exists(p):
+                    os.remove(p)
+
     def run(self):
         fd, path = tempfile.mkstemp()
-        mandatory = ['./sikso2', '-r', path, '-S', '-d', 'oneline']
+        mandatory = ['./sikso2', '-r', path, '-S', '-F', 'json']
         full_run = (['valgrind'] if self.leak_check else []) \
                  + mandatory + self.args
 
@@ -175,6 +192,10 @@ class Sikso2Tests(unittest.TestCase):
             self.assertEqual(sikso2code.sikso2cpu.cpu_data['P']
                                 & (1 << bit), 0)
 
+    def assertResultEqual(self, sikso2code, key, val):
+        Logger.logt('Checking if {} equals {}...'.format(key, val))
+        self.assertEqual(sikso2code.sikso2cpu.result[key], val)
+
     def assertFoundError(self, sikso2code, err_msg):
         Logger.logt('Checking if "{}" error is found...'.format(err_msg))
         err = sikso2code.check_for_errors()
@@ -270,4 +291,508 @@ class Sikso2Tests(unittest.TestCase):
         self.assertCPURegisterEqual(s2c, 'A', int("11", 16))
         self.assertCPUStatusBitsSet(s2c, [0, 5, 6])
 
+        s2c = Sikso2Code('test_adc (D)', 'SED\nLDA #$19\nADC #$28')
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'A', int("47", 16))
+        self.assertCPUStatusBitsSet(s2c, [3, 5])
+        self.assertCPUStatusBitsClear(s2c, [0, 1, 6, 7])
+
+    def test4_result(self):
+        print('')
+        s2c = Sikso2Code('test_result', 'LDA #$05\nSTA $10\nADC $10',
+                ['-m', '0x0010,0x0600-0x0601'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'A', 10)
+        self.assertResultEqual(s2c, 'cycles', 8)
+        self.assertResultEqual(s2c, 'instructions', 3)
+        self.assertResultEqual(s2c, 'exit', 'last_instr')
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '05' },
+            { 'addr': int('600', 16), 'data': 'a905' }
+        ])
+
+    def test5_watch(self):
+        print('')
+        code = 'LDA #$05\nSTA $10\nLDA $10\nNOP'
+
+        s2c = Sikso2Code('test_break', code, ['-B', '0x0604'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'PC', int('604', 16))
+        self.assertResultEqual(s2c, 'exit', 'breakpoint')
+
+        s2c = Sikso2Code('test_watch', code, ['-w', '0x0010'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'PC', int('604', 16))
+        self.assertResultEqual(s2c, 'exit', 'watchpoint')
+
+        s2c = Sikso2Code('test_watch_read', code, ['-W', '0x0010'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'PC', int('606', 16))
+        self.assertResultEqual(s2c, 'exit', 'watchpoint')
+
+    def test6_replay(self):
+        print('')
+        code = 'LDA #$05\nSTA $10\nADC $10\nSTA $11\nNOP'
+        _, path = tempfile.mkstemp()
+
+        s2c = Sikso2Code('test_record', code, ['-j', path, '-k', '4'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'A', 10)
+
+        s2c = Sikso2Code('test_replay', code, ['-J', path, '-c', '5'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'A', 5)
+        self.assertResultEqual(s2c, 'cycles', 5)
+        self.assertResultEqual(s2c, 'exit', 'seek')
+
+        code = ('JMP _main\nDEC $10\nSTA $D101\nRTI\n_main:\n'
+                'LDA #$64\nSTA $D102\nLDA #$00\nSTA $D103\nLDA #$03\n'
+                'STA $D100\n_loop:\nLDA $10\nCMP #$f6\nBNE _loop\n'
+                'STA $11')
+        args = ['-Q', '0xd100', '-T', '0xff00-0xffff',
+                '-b', '0xfffe:03,0xffff:06', '-m', '0x0010-0x0011']
+
+        s2c = Sikso2Code('test_record_timer', code,
+                         args + ['-j', path, '-k', '150'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertResultEqual(s2c, 'cycles', 1051)
+
+        s2c = Sikso2Code('test_replay_timer', code,
+                         args + ['-J', path, '-c', '820'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertResultEqual(s2c, 'cycles', 830)
+        self.assertResultEqual(s2c, 'instructions', 271)
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': 'f900' }
+        ])
+
+        os.remove(path)
+
+    def test7_idle(self):
+        print('')
+        s2c = Sikso2Code('test_idle', 'LDA #$05\nSTA $10\n_loop:\n'
+                'LDA $10\nJMP _loop')
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'A', 5)
+        self.assertResultEqual(s2c, 'instructions', 6)
+        self.assertResultEqual(s2c, 'exit', 'idle')
+
+    def test8_mapper(self):
+        print('')
+        fd, path = tempfile.mkstemp()
+        os.write(fd, b''.join(bytes([i]) * 256 for i in range(4)))
+        os.close(fd)
+
+        s2c = Sikso2Code('test_mapper', 'LDA $8000\nSTA $10\n'
+                'LDA #$02\nSTA $7FF0\nLDA $8000\nSTA $11\n'
+                'LDA #$55\nSTA $8000\nLDA #$00\nSTA $7FF0\n'
+                'LDA #$02\nSTA $7FF0\nLDA $8000\nSTA $12',
+                ['-X', 'latch:0x8000:0x100:0x7ff0:' + path,
+                 '-m', '0x0010-0x0012'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '000255' }
+        ])
+
+        # two CPUs on the bus, taking turns of two instructions, each
+        # switching a bank the other one then reads
+        fd, cpu1 = tempfile.mkstemp()
+        os.write(fd, bytes([0xa9, 0x02, 0x8d, 0xf0, 0x7f, 0xea, 0xea,
+                            0xad, 0x00, 0x80, 0x8d, 0x00, 0x03,
+                            0x4c, 0x0d, 0x07]))
+        os.close(fd)
+
+        s2c = Sikso2Code('test_mapper_cpus', 'NOP\nNOP\n'
+                'LDA $8000\nSTA $10\nLDA #$03\nSTA $7FF0\n'
+                'NOP\nNOP\nLDA $0300\nSTA $11',
+                ['-X', 'latch:0x8000:0x100:0x7ff0:' + path,
+                 '-f', '0x0700:' + cpu1, '-C', '0x0700', '-N', '2',
+                 '-m', '0x0010-0x0011'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '0203' }
+        ])
+
+        s2c = Sikso2Code('test_mapper_threads', 'NOP',
+                ['-X', 'latch:0x8000:0x100:0x7ff0:' + path,
+                 '-f', '0x0700:' + cpu1, '-C', '0x0700', '-H'])
+        s2c.run()
+        self.assertFoundError(s2c, 'CPU threads cannot share peripherals')
+
+        # a checkpoint after a switch shows the bank it was taken with
+        _, journal = tempfile.mkstemp()
+        code = ('LDA #$11\nSTA $8000\nLDA #$02\nSTA $7FF0\n'
+                'LDA #$22\nSTA $8000\nLDA #$00\nSTA $7FF0\n'
+                'LDA $8000\nSTA $10')
+        args = ['-X', 'latch:0x8000:0x100:0x7ff0:' + path]
+
+        s2c = Sikso2Code('test_mapper_record', code,
+                         args + ['-j', journal, '-k', '4'])
+        s2c.run()
+
+        s2c = Sikso2Code('test_mapper_replay', code,
+                         args + ['-J', journal, '-c', '20',
+                                 '-m', '0x8000'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertResultEqual(s2c, 'exit', 'seek')
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('8000', 16), 'data': '22' }
+        ])
+
+        os.remove(journal)
+        os.remove(cpu1)
+        os.remove(path)
+
+    def test9_rom(self):
+        print('')
+        code = 'LDA #$05\nSTA $0700\nLDA $0700'
+
+        s2c = Sikso2Code('test_rom', code,
+                ['-T', '0x0700', '-b', '0x0700:2a', '-m', '0x0700'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'A', int('2a', 16))
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('700', 16), 'data': '2a' }
+        ])
+
+        s2c = Sikso2Code('test_rom_trap', code,
+                ['-T', '0x0700', '-E', 'trap'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'PC', int('605', 16))
+        self.assertResultEqual(s2c, 'exit', 'error')
+
+        fd, path = tempfile.mkstemp()
+        os.write(fd, bytes([0x2a, 0x00, 0x11]))
+        os.close(fd)
+
+        s2c = Sikso2Code('test_rom_image', code,
+                ['-Y', '0x0700:' + path, '-m', '0x0700-0x0703'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'A', int('2a', 16))
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('700', 16), 'data': '2a001100' }
+        ])
+
+        os.remove(path)
+
+    def test10_cpus(self):
+        print('')
+        fd, path = tempfile.mkstemp()
+        os.write(fd, bytes([0xa9, 0x2a, 0x8d, 0x00, 0x03, 0x4c, 0x05, 0x07]))
+        os.close(fd)
+
+        for threads in [[], ['-H']]:
+            s2c = Sikso2Code('test_cpus',
+                    'NOP\nNOP\nNOP\nNOP\nLDA $0300\nSTA $10',
+                    ['-f', '0x0700:' + path, '-C', '0x0700', '-L', '4',
+                     '-m', '0x0010'] + threads)
+            s2c.run()
+            s2c.find_cpu_data()
+            self.assertCPURegisterEqual(s2c, 'A', int('2a', 16))
+            self.assertResultEqual(s2c, 'mem', [
+                { 'addr': int('10', 16), 'data': '2a' }
+            ])
+
+        s2c = Sikso2Code('test_cpus_periph', 'NOP',
+                ['-f', '0x0700:' + path, '-C', '0x0700', '-K', '0xd000',
+                 '-H'])
+        s2c.run()
+        self.assertFoundError(s2c, 'CPU threads cannot share peripherals')
+
+        os.remove(path)
+
+    def test11_console(self):
+        print('')
+        fd, path = tempfile.mkstemp()
+        os.write(fd, b'xy')
+        os.close(fd)
+
+        s2c = Sikso2Code('test_console', 'LDA #$48\nSTA $D000\n'
+                'LDA #$49\nSTA $D000\nLDA #$0A\nSTA $D000\n'
+                'LDA $D000\nSTA $10\nLDA $D001\nSTA $11\n'
+                'LDA $D000\nLDA $D001\nSTA $12',
+                ['-K', '0xd000', '-i', path, '-m', '0x0010-0x0012'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertIn('HI', s2c.res)
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '780102' }
+        ])
+
+        os.remove(path)
+
+    def test12_timer_dma(self):
+        print('')
+        s2c = Sikso2Code('test_timer_dma', 'JMP _main\n'
+                'LDA $D101\nSTA $11\nSTA $D101\nLDA #$01\nSTA $10\n'
+                'JMP _loop\n'
+                '_main:\nLDA #$00\nSTA $13\n'
+                'LDA #$00\nSTA $D102\nLDA #$01\nSTA $D103\n'
+                'LDA #$07\nSTA $D100\n'
+                'LDA #$03\nSTA $D200\nLDA #$06\nSTA $D201\n'
+                'LDA #$13\nSTA $D202\nLDA #$00\nSTA $D203\n'
+                'LDA #$08\nSTA $D204\nLDA #$00\nSTA $D205\n'
+                'LDA #$01\nSTA $D206\nLDA $D207\nSTA $12\n'
+                '_loop:\nJMP _loop',
+                ['-Q', '0xd100', '-Z', '0xd200', '-T', '0xff00-0xffff',
+                 '-b', '0xfffe:03,0xffff:06', '-m', '0x0010-0x001a'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertResultEqual(s2c, 'exit', 'idle')
+        self.assertResultEqual(s2c, 'cycles', 312)
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '010101ad01d185118d01d1' }
+        ])
+
+    def test13_stack(self):
+        print('')
+        s2c = Sikso2Code('test_stack', 'LDA #$05\nJSR _double\nSTA $10\n'
+                'PHP\nSEC\nSED\nPLP\nPHA\nLDA #$00\nPLA\nSTA $11\n'
+                'JMP _end\n'
+                '_double:\nCLC\nADC $12\nPHA\nADC #$00\nPLA\n'
+                'ADC #$05\nRTS\n'
+                '_end:\nNOP',
+                ['-m', '0x0010-0x0011'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'A', 10)
+        self.assertCPURegisterEqual(s2c, 'S', int('ff', 16))
+        self.assertCPURegisterEqual(s2c, 'P', int('20', 16))
+        self.assertResultEqual(s2c, 'cycles', 61)
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '0a0a' }
+        ])
+
+    def test14_branch(self):
+        print('')
+        s2c = Sikso2Code('test_branch', 'LDA #$03\n_loop:\nSEC\n'
+                'SBC #$01\nBNE _loop\nSTA $10\nBEQ _end\nLDA #$07\n'
+                'STA $11\n'
+                '_end:\nNOP',
+                ['-m', '0x0010-0x0011'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'A', 0)
+        self.assertResultEqual(s2c, 'cycles', 30)
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '0000' }
+        ])
+
+    def test15_models(self):
+        print('')
+        s2c = Sikso2Code('test_65c02', 'LDA #$07\nPHA\nPLX\nLDA #$05\n'
+                'STA $10\nSTZ $10\nBRA _skip\nSTA $11\n_skip:\n'
+                'LDA #$03\nSTA $11\nLDA #$01\nTSB $11\nLDA #$02\n'
+                'TRB $11',
+                ['-V', '65c02', '-m', '0x0010-0x0011'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'X', 7)
+        self.assertResultEqual(s2c, 'cycles', 39)
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '0001' }
+        ])
+        s2c = Sikso2Code('test_undoc', 'LDA #$2a\nSTA $10\nLAX $10\n'
+                'LDA #$0f\nSAX $11\nDCP $10\nNOP $10\nNOP',
+                ['-V', 'undoc', '-m', '0x0010-0x0011'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'X', int('2a', 16))
+        self.assertCPURegisterEqual(s2c, 'P', int('a0', 16))
+        self.assertResultEqual(s2c, 'cycles', 23)
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '290a' }
+        ])
+
+    def test16_safeguard(self):
+        print('')
+        s2c = Sikso2Code('test_safeguard', '_loop:\nADC #$01\nJMP _loop',
+                ['-n', '100'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'A', 50)
+        self.assertResultEqual(s2c, 'cycles', 250)
+        self.assertResultEqual(s2c, 'instructions', 100)
+        self.assertResultEqual(s2c, 'exit', 'safeguard')
+
+    def test17_aot(self):
+        print('')
+        code = ('SEC\nLDA #$41\nASL A\nSTA $0700\nPHP\nPLA\nSTA $0701\n'
+                'LDA #$c0\nSTA $10\nLDA #$01\nBIT $10\nPHP\nPLA\n'
+                'STA $0702\nLDA #$80\nSTA $10\nLDA #$00\nBIT $10\nPHP\n'
+                'PLA\nSTA $0703\nSEC\nASL $10\nPHP\nPLA\nSTA $0704\n'
+                'LDA #$00\n_loop:\nCLC\nADC #$03\nCMP #$1e\nBNE _loop\n'
+                'STA $0705')
+        args = ['-m', '0x0700-0x0705,0x0010']
+
+        interp = Sikso2Code('test_aot_interp', code, args)
+        interp.run()
+        interp.find_cpu_data()
+
+        Sikso2Code.make_aot(code)
+
+        s2c = Sikso2Code('test_aot', code, args)
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertTrue(any('Attached compiled image' in line
+                            for line in s2c.res))
+        for reg in Sikso2CPU.registers:
+            self.assertCPURegisterEqual(s2c, reg,
+                    interp.sikso2cpu.cpu_data[reg])
+        for key in ['cycles', 'instructions', 'mem']:
+            self.assertResultEqual(s2c, key, interp.sikso2cpu.result[key])
+
+    def test18_fused(self):
+        print('')
+        s2c = Sikso2Code('test_fused', 'LDA #$00\nTAY\n_loop:\nINY\n'
+                'CPY #$05\nBNE _loop\nLDA #$03\nTAX\n_dec:\nDEX\n'
+                'BNE _dec')
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertTrue(any('fused: 3 instructions' in line
+                            for line in s2c.res))
+        self.assertCPURegisterEqual(s2c, 'X', 0)
+        self.assertCPURegisterEqual(s2c, 'Y', 5)
+        self.assertResultEqual(s2c, 'cycles', 56)
+        self.assertResultEqual(s2c, 'instructions', 25)
+
+    def test19_addressing(self):
+        print('')
+        s2c = Sikso2Code('test_zp_wrap', 'LDA #$ff\nTAX\nLDA #$11\n'
+                'STA $80,X\nLDA #$ff\nSTA $20\nLDA #$07\nSTA $21\n'
+                'LDA #$01\nTAY\nLDA ($20),Y\nSTA $10\nLDA #$02\nTAX\n'
+                'LDA ($fd,X)\nSTA $11',
+                ['-b', '0x00ff:01,0x0000:08,0x0800:5a,0x0801:a5',
+                 '-m', '0x0010-0x0011,0x007f'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertResultEqual(s2c, 'cycles', 46)
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '5aa5' },
+            { 'addr': int('7f', 16), 'data': '11' }
+        ])
+        s2c = Sikso2Code('test_zp_y_wrap', 'LDA #$ff\nTAY\nLAX $81,Y\n'
+                'SAX $91,Y',
+                ['-V', 'undoc', '-b', '0x0080:3c', '-m', '0x0090'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'X', int('3c', 16))
+        self.assertResultEqual(s2c, 'cycles', 12)
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('90', 16), 'data': '3c' }
+        ])
+
+    def test20_brk(self):
+        print('')
+        s2c = Sikso2Code('test_brk', 'BRK\nNOP\nPHP\nPLA\nSTA $13\n'
+                'PLA\nSTA $10\nPLA\nSTA $11\nPLA\nSTA $12',
+                ['-T', '0xff00-0xffff', '-b', '0xfffe:02,0xffff:06',
+                 '-m', '0x0010-0x0013'])
+        s2c.run()
+        s2c.find_cpu_data()
+        self.assertCPURegisterEqual(s2c, 'S', int('ff', 16))
+        self.assertCPUStatusBitsSet(s2c, [2])
+        self.assertResultEqual(s2c, 'cycles', 38)
+        self.assertResultEqual(s2c, 'mem', [
+            { 'addr': int('10', 16), 'data': '30020634' }
+        ])
+
+    def test21_disassemble(self):
+        print('')
+        code = ('LDA #$03\n_loop:\nSEC\nSBC #$01\nBNE _loop\nBEQ _end\n'
+                'NOP\n_end:\nSTA $0700')
+        paths = [tempfile.mkstemp()[1] for _ in range(4)]
+        asm, binary, disasm, rebuilt = paths
+
+        try:
+            with open(asm, 'w') as f:
+                f.write(code)
+
+            subprocess.run(['./sikso2', '-t', asm, '-o', binary],
+                    capture_output=True)
+            res = subprocess.run(['./sikso2', '-D', binary],
+                    capture_output=True, text=True).stdout.split('\n')
+            lines = [line for line in res if line
+                     and not line.startswith(('[', '  ->'))]
+            Logger.logit('test_disassemble', 'Disassembly:\n{}'.format(
+                textwrap.indent('\n'.join(lines), '\t')))
+            self.assertIn('BNE $0602', lines)
+            self.assertIn('BEQ $060a', lines)
+
+            with open(disasm, 'w') as f:
+                f.write('\n'.join(lines))
+
+            subprocess.run(['./sikso2', '-t', disasm, '-o', rebuilt],
+                    capture_output=True)
+
+            with open(binary, 'rb') as f1, open(rebuilt, 'rb') as f2:
+                self.assertEqual(f1.read(), f2.read())
+
+        finally:
+            for p in paths:
+                os.remove(p)
+
+    def test22_slice_instrs(self):
+        print('')
+        fd, path = tempfile.mkstemp()
+        os.write(fd, bytes([0xce, 0x00, 0x03] * 20 + [0x4c, 0x3c, 0x07]))
+        os.close(fd)
+
+        # the second CPU decrements $0300 once an instruction, so what
+        # the first one reads tells how far each turn went
+        for n, data in [(1, 'fdfa'), (2, 'fefa'), (3, 'fdfa')]:
+            s2c = Sikso2Code('test_slice_instrs',
+                    'NOP\nNOP\nNOP\nLDA $0300\nSTA $10\nNOP\n'
+                    'LDA $0300\nSTA $11',
+                    ['-f', '0x0700:' + path, '-C', '0x0700',
+                     '-N', str(n), '-m', '0x0010-0x0011'])
+            s2c.run()
+            s2c.find_cpu_data()
+            self.assertResultEqual(s2c, 'cycles', 22)
+            self.assertResultEqual(s2c, 'instructions', 8)
+            self.assertResultEqual(s2c, 'mem', [
+                { 'addr': int('10', 16), 'data': data }
+            ])
+
+        os.remove(path)
+
+    def test23_idle_irq(self):
+        print('')
+        # the loop is skipped between IRQs, and each pass it skips is
+        # the loop's own, not the handler's
+        for period, cycles, instrs in [('01', 1081, 344),
+                                       ('08', 8251, 2734)]:
+            s2c = Sikso2Code('test_idle_irq', 'JMP _main\n'
+                    'DEC $10\nSTA $D101\nRTI\n'
+                    '_main:\nLDA #$83\nSTA $10\n'
+                    'LDA #$00\nSTA $D102\nLDA #$' + period + '\n'
+                    'STA $D103\nLDA #$03\nSTA $D100\nCLI\n'
+                    '_loop:\nBIT $10\nBMI _loop\n'
+                    'LDA #$00\nSTA $D100',
+                    ['-Q', '0xd100', '-T', '0xff00-0xffff',
+                     '-b', '0xfffe:03,0xffff:06', '-m', '0x0010'])
+            s2c.run()
+            s2c.find_cpu_data()
+            self.assertResultEqual(s2c, 'cycles', cycles)
+            self.assertResultEqual(s2c, 'instructions', instrs)
+            self.assertResultEqual(s2c, 'mem', [
+                { 'addr': int('10', 16), 'data': '7f' }
+            ])
+
 unittest.main()